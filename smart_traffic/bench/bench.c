@@ -0,0 +1,338 @@
+/**************************************************
+ * 文件名:    bench.c
+ * 作者:
+ * 日期:      2025-10-11
+ * 描述:      机器周期基准测试（SDCC + ucsim s51）
+ *           用 Timer1（模式1，每机器周期加1）测量固件函数的执行周期数，
+ *           再让 Timer0 中断真实运行十余秒，读取 isrMaxCycles 得到中断最坏耗时。
+ *           结果经 ucsim 仿真器接口（xdata 0xFFFF）逐字符输出，
+ *           每行以 "BENCH " 开头、列宽固定，便于与基线 diff（见 Makefile）
+ *
+ *           仅支持标准12T内核（CPU_CLK_DIV=12），此时Timer1计数即机器周期
+ **************************************************/
+
+// 固件 main.c 直接包含进来，以便测量其中的 static 函数（Main_RefreshDisplay 等）
+#define main firmware_main
+#include "../main.c"
+#undef main
+#include "../keys.h"
+#include "../detector.h"
+#include "../sched.h"
+
+#if CPU_CLK_DIV != 12
+#error "基准测试按12T内核计数（Timer1每机器周期加1）"
+#endif
+
+#if !ISR_PROFILE_ENABLE
+#error "基准测试需要 ISR_PROFILE_ENABLE=1 以读取中断最坏耗时"
+#endif
+
+/*==============================================
+ *                ucsim 仿真器接口
+ *==============================================*/
+// s51 启动参数 -I if=xram[0xffff]：写 'p' 后再写一个字符即输出该字符，写 's' 停止仿真
+static volatile __xdata __at(0xFFFF) unsigned char simif;
+
+static void Bench_PutChar(char c)
+{
+    simif = 'p';
+    simif = c;
+}
+
+static void Bench_PutStr(const char *s)
+{
+    while (*s) {
+        Bench_PutChar(*s++);
+    }
+}
+
+/**
+ * @brief  右对齐输出无符号数（固定列宽，便于diff）
+ */
+static void Bench_PutUInt(unsigned long v, unsigned char width)
+{
+    char buf[11];
+    unsigned char n = 0;
+
+    do {
+        buf[n++] = (char)('0' + (unsigned char)(v % 10));
+        v /= 10;
+    } while (v && n < sizeof(buf));
+    while (width > n) {
+        Bench_PutChar(' ');
+        width--;
+    }
+    while (n) {
+        Bench_PutChar(buf[--n]);
+    }
+}
+
+/**
+ * @brief  左对齐输出名称列
+ */
+static void Bench_PutName(const char *name)
+{
+    unsigned char n = 0;
+
+    Bench_PutStr("BENCH ");
+    while (*name) {
+        Bench_PutChar(*name++);
+        n++;
+    }
+    while (n < 24) {
+        Bench_PutChar(' ');
+        n++;
+    }
+}
+
+/*==============================================
+ *                周期测量（Timer1）
+ *==============================================*/
+#define BENCH_START()   do { TH1 = 0; TL1 = 0; TR1 = 1; } while (0)
+#define BENCH_STOP()    do { TR1 = 0; } while (0)
+#define BENCH_CYCLES()  ((((unsigned int)TH1 << 8) | TL1) - benchOverhead)
+
+static unsigned int benchOverhead = 0;   // 空测量（START紧跟STOP）本身的周期数
+static unsigned char benchI;
+static unsigned int benchLock = 0;      // 灯输出临界区所在函数的最长周期数
+static unsigned char benchCrc;
+
+/**
+ * @brief  输出一行：名称 实测周期 [期望周期 误差ppm]
+ */
+static void Bench_Report(const char *name, unsigned int cycles, unsigned long expected)
+{
+    Bench_PutName(name);
+    Bench_PutUInt(cycles, 8);
+    if (expected) {
+        long err = ((long)cycles - (long)expected) * 1000000L / (long)expected;
+        Bench_PutUInt(expected, 8);
+        Bench_PutChar(' ');
+        Bench_PutChar(err < 0 ? '-' : '+');
+        Bench_PutUInt(err < 0 ? -err : err, 7);
+    }
+    Bench_PutChar('\n');
+}
+
+/**
+ * @brief  送入命令帧的同步、类型、长度字节
+ * @retval 已累加的CRC（类型、长度）
+ */
+static unsigned char Bench_CmdHead(unsigned char type, unsigned char len)
+{
+    Command_RxByte(TLM_SYNC);
+    Command_RxByte(type);
+    Command_RxByte(len);
+    return Uart_Crc8(Uart_Crc8(0, type), len);
+}
+
+void main(void)
+{
+    // 各函数单独测量时关闭中断，避免Timer0中断计入
+    EA = 0;
+    TMOD = (TMOD & 0x0F) | 0x10;   // Timer1 模式1（16位定时器）
+    P0 = 0xFF;                     // 按键全部松开
+
+    BENCH_START();
+    BENCH_STOP();
+    benchOverhead = ((unsigned int)TH1 << 8) | TL1;
+
+    Display_Init();
+    UpdateStateTimeTable();
+    Plan_Swap();
+    currentState = 0;
+    timeLeft = stateTimeTable[currentState];
+
+    Bench_PutStr("BENCH # FOSC=");
+    Bench_PutUInt(FOSC, 0);
+    Bench_PutStr(" PHASE_PLAN=");
+    Bench_PutUInt(PHASE_PLAN, 0);
+    Bench_PutStr("\nBENCH # name                     cycles  expect  err_ppm\n");
+
+    // 启动时间：复位后到相位灯色写出（Main_Boot，不含之后的 Buzzer_Init 等），12T下 周期数=微秒数×FOSC/12M。
+    // 复位后最先写全红的是启动代码（Keil：STARTUP.A51；SDCC：traffic_light.c 中的 crt0 启动钩子），不在测量内；
+    // SDCC 的 crt0 之后还要清零全部256字节 idata（Keil 只清零128字节），热复位记录经启动钩子暂存后由 main() 取回。
+    // bench 有自己的 main()，不经过 Boot_Reclaim()：下面直接装入记录测量接回相位的路径
+    // s51 没有 IAP：EEPROM 读出全0，扫描把每个位置都当作标记不符的记录（每位置读3字节）
+#if FAST_BOOT_ENABLE
+    PCON |= PCON_POF;
+    BENCH_START(); Main_Boot(); BENCH_STOP();
+    Bench_Report("Main_Boot(cold)", BENCH_CYCLES(), 0);
+
+    // 热复位接回：装入一条有效的保留记录（相位1剩余1秒）
+    bootKeep[BOOT_KEEP_PHASE] = 1;
+    bootKeep[BOOT_KEEP_LEFT] = 1;
+    bootKeep[BOOT_KEEP_NPHASE] = (unsigned char)~1;
+    bootKeep[BOOT_KEEP_NLEFT] = (unsigned char)~1;
+    BENCH_START(); Main_Boot(); BENCH_STOP();
+    Bench_Report("Main_Boot(resume)", BENCH_CYCLES(), 0);
+
+    // 记录已作废：全红清空
+    BENCH_START(); Boot_Start(); BENCH_STOP();
+    Bench_Report("Boot_Start(clear)", BENCH_CYCLES(), 0);
+
+    // 回到上电启动的状态，8888 自检显示结束
+    flashStage = FLASH_OFF;
+    PCON |= PCON_POF;
+    Main_Boot();
+    mainSelfTest = 0;
+#else
+    BENCH_START(); Main_Boot(); BENCH_STOP();
+    Bench_Report("Main_Boot(cold)", BENCH_CYCLES(), 0);
+#endif
+
+    BENCH_START(); Display_ShowTime(7, 3); BENCH_STOP();
+    Bench_Report("Display_ShowTime", BENCH_CYCLES(), 0);
+
+    BENCH_START(); Display_ShowBcd(0x47, 0x50); BENCH_STOP();
+    Bench_Report("Display_ShowBcd", BENCH_CYCLES(), 0);
+
+    BENCH_START(); Display_Refresh(); BENCH_STOP();
+    Bench_Report("Display_Refresh", BENCH_CYCLES(), 0);
+
+    BENCH_START(); Display_Scan(); BENCH_STOP();
+    Bench_Report("Display_Scan", BENCH_CYCLES(), 0);
+
+    // 节拍任务（由 Sched_Tick() 按任务表调用，每次调用都是一次真正的采样）
+    BENCH_START(); Keys_Tick(); BENCH_STOP();
+    Bench_Report("Keys_Tick(sample)", BENCH_CYCLES(), 0);
+
+    // 检测器：ACTUATED_ENABLE=1 时登记；第二次采样确认到达（P3.4有车）
+    P3 &= (unsigned char)~DET_BIT_NS;
+    Detector_Tick();
+    BENCH_START(); Detector_Tick(); BENCH_STOP();
+    Bench_Report("Detector_Tick(sample)", BENCH_CYCLES(), 0);
+    P3 |= DET_BIT_NS;
+
+    // 遥测：抓取快照（Timer0中断内），主循环组帧入队（含10字节CRC）
+    BENCH_START(); Telemetry_Tick(); BENCH_STOP();
+    Bench_Report("Telemetry_Tick(snap)", BENCH_CYCLES(), 0);
+
+    BENCH_START(); Telemetry_Poll(); BENCH_STOP();
+    Bench_Report("Telemetry_Poll", BENCH_CYCLES(), 0);
+
+    // 串口中断：置TI由硬件响应，从发送缓冲区送出上面入队的第一个字节（含中断响应和RETI）；
+    // 此后串口保持开启，下面Timer0运行期间遥测照常发送
+    Uart_Init();
+    EA = 1;
+    BENCH_START(); TI = 1; _nop_(); BENCH_STOP();
+    EA = 0;
+    Bench_Report("Uart_ISR", BENCH_CYCLES(), 0);
+
+    // 串口命令：负载字节（一次状态转移和CRC累加）、CRC字节（校验、检查参数、交给主循环），
+    // 主循环执行并组帧回复；配时写回当前值，不影响下面的测量
+    benchCrc = Bench_CmdHead(CMD_SET_PLAN, 2);
+    Command_RxByte(g_time_green);
+    benchCrc = Uart_Crc8(benchCrc, g_time_green);
+    BENCH_START(); Command_RxByte(g_time_yellow); BENCH_STOP();
+    Bench_Report("Command_RxByte(data)", BENCH_CYCLES(), 0);
+    benchCrc = Uart_Crc8(benchCrc, g_time_yellow);
+    BENCH_START(); Command_RxByte(benchCrc); BENCH_STOP();
+    Bench_Report("Command_RxByte(crc)", BENCH_CYCLES(), 0);
+
+    BENCH_START(); Command_Poll(); BENCH_STOP();
+    Bench_Report("Command_Poll(SET_PLAN)", BENCH_CYCLES(), 0);
+
+    benchCrc = Bench_CmdHead(CMD_GET_PLAN, 0);
+    Command_RxByte(benchCrc);
+    BENCH_START(); Command_Poll(); BENCH_STOP();
+    Bench_Report("Command_Poll(GET_PLAN)", BENCH_CYCLES(), 0);
+
+    // 蜂鸣器空闲节拍；开始发声的节拍会改写TH1/TL1，不能用Timer1测量，计入下面的中断最坏耗时
+    BENCH_START(); Buzzer_Tick(); BENCH_STOP();
+    Bench_Report("Buzzer_Tick(idle)", BENCH_CYCLES(), 0);
+
+    BENCH_START(); Buzzer_Play(BUZZER_PAT_WARN); BENCH_STOP();
+    Bench_Report("Buzzer_Play", BENCH_CYCLES(), 0);
+
+    BENCH_START(); Main_RefreshDisplay(); BENCH_STOP();
+    Bench_Report("Main_RefreshDisplay", BENCH_CYCLES(), 0);
+
+    BENCH_START(); Timebase_Tick(); BENCH_STOP();
+    Bench_Report("Timebase_Tick", BENCH_CYCLES(), 0);
+
+    BENCH_START(); SwitchToNextState(); BENCH_STOP();
+    Bench_Report("SwitchToNextState", BENCH_CYCLES(), 0);
+
+    // 灯输出临界区（LAMP_LOCK）最长的两个函数，紧急请求最多被它们推迟这么久
+    BENCH_START(); SetTrafficLights(currentState); BENCH_STOP();
+    benchLock = BENCH_CYCLES();
+    Bench_Report("SetTrafficLights", benchLock, 0);
+
+    BENCH_START(); HandleTrafficLightFlash(); BENCH_STOP();
+    if (BENCH_CYCLES() > benchLock) {
+        benchLock = BENCH_CYCLES();
+    }
+    Bench_Report("HandleTrafficLightFlash", BENCH_CYCLES(), 0);
+
+    // 紧急请求中断：置IE0由硬件响应，含中断响应、ISR和RETI；随后撤销请求，恢复相位表灯色
+    IT0 = 1;
+    EX0 = 1;
+    EA = 1;
+    BENCH_START(); IE0 = 1; _nop_(); BENCH_STOP();
+    EA = 0;
+    EX0 = 0;
+    Bench_Report("Emergency_NsISR", BENCH_CYCLES(), 0);
+    // 最坏响应上限 = 中断响应(≤9) + 整个函数（大于其中的临界区） + 同级的蜂鸣器中断
+    //              + 一次 IAP 字节编程（手册数值，s51 不模拟 IAP） + 整个中断（大于入口到写P2）
+    Bench_Report("Emergency(bound)", 9 + benchLock + BUZZER_ISR_CYCLES + EEPROM_STALL_CYCLES + BENCH_CYCLES(), 0);
+    emgRequest = 0;
+    SetTrafficLights(currentState);
+
+    BENCH_START(); Event_Post(EVT_SECOND); Event_Get(); BENCH_STOP();
+    Bench_Report("Event_Post+Event_Get", BENCH_CYCLES(), 0);
+
+    // 软件延时：期望周期 = 时长 × FOSC / CPU_CLK_DIV
+    BENCH_START(); Delay_us(100); BENCH_STOP();
+    Bench_Report("Delay_us(100)", BENCH_CYCLES(), FOSC / CPU_CLK_DIV / 10000UL);
+
+    BENCH_START(); Delay_ms(1); BENCH_STOP();
+    Bench_Report("Delay_ms(1)", BENCH_CYCLES(), FOSC / CPU_CLK_DIV / 1000UL);
+
+    BENCH_START(); Delay_ms(10); BENCH_STOP();
+    Bench_Report("Delay_ms(10)", BENCH_CYCLES(), FOSC / CPU_CLK_DIV / 100UL);
+
+    // Timer0中断真实运行：覆盖数码管扫描、秒节拍、相位切换和蜂鸣器音型，取最坏耗时
+    // （未调用 Buzzer_Init()，ET1=0：Timer1此时只作为普通定时器被启停，不产生中断）
+    // isrMaxCycles 从定时器溢出算起，含中断响应延迟，不含退出时的出栈和RETI
+    Reset_SystemTime();
+    Timer0_Init();
+    while (Get_SystemTime_s() < (unsigned int)phaseStart[PHASE_COUNT] + 1) {
+        Main_Poll();
+        Main_Idle();
+    }
+    EA = 0;
+    Bench_Report("Timer0_ISR(worst)", isrMaxCycles, 0);
+    Bench_Report("Timer0_ISR(budget)", (unsigned int)TIMER0_COUNTS, 0);
+#if SCHED_BUDGET_ENABLE
+    // 各节拍任务单次运行的最长耗时（含调用和计时），期望列为预算，误差为正即超出预算
+    Bench_Report("Sched:buzzer", schedMax[SCHED_BUZZER], SCHED_COUNTS(SCHED_BUDGET_BUZZER));
+    Bench_Report("Sched:keys", schedMax[SCHED_KEYS], SCHED_COUNTS(SCHED_BUDGET_KEYS));
+#if ACTUATED_ENABLE
+    Bench_Report("Sched:detector", schedMax[SCHED_DETECTOR], SCHED_COUNTS(SCHED_BUDGET_DETECTOR));
+#endif
+#if UART_ENABLE
+    Bench_Report("Sched:telemetry", schedMax[SCHED_TELEMETRY], SCHED_COUNTS(SCHED_BUDGET_TELEMETRY));
+#endif
+    // 各任务超出预算的次数（按任务号）
+    Bench_PutName("Sched:overruns");
+    for (benchI = 0; benchI < SCHED_TASKS; benchI++) {
+        Bench_PutUInt(schedOverruns[benchI], 4);
+    }
+    Bench_PutChar('\n');
+#endif
+#if IDLE_ENABLE && IDLE_STATS_ENABLE
+    // 最后一秒的空闲计数；误差列 = -(忙碌占比)，单位ppm
+    Bench_PutName("Idle(counts/s)");
+    Bench_PutUInt(idleCountsLastSecond, 8);
+    Bench_PutUInt(IDLE_COUNTS_PER_S, 8);
+    Bench_PutChar(' ');
+    Bench_PutChar('-');
+    Bench_PutUInt((IDLE_COUNTS_PER_S - idleCountsLastSecond) * 1000UL / (IDLE_COUNTS_PER_S / 1000UL), 7);
+    Bench_PutChar('\n');
+#endif
+
+    simif = 's';
+    while (1) {
+    }
+}
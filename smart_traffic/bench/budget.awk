@@ -0,0 +1,167 @@
+# RAM/ROM 预算报告：按模块汇总 DATA/IDATA/BIT/CODE，与 256 字节片内RAM、代码预算比较
+#
+# 输入（任选其一）：
+#   SDCC：各模块的 .rel（"M 模块名"、"A 段名 size 十六进制 ..." 行）和链接生成的 .mem
+#         （"Stack starts at" 与 ROM/EPROM/FLASH 行，含库函数的总代码量）
+#   Keil：BL51 的 .m51（LINK MAP 中的段表，段名 ?PR?函数?模块、?DT?模块、?ID?模块、?BI?模块、?CO?模块）
+# 变量（-v）：ramsize（默认256）、codesize（默认2048）、stackmin（栈至少保留的字节数，默认40）
+#
+# RAM 计算：直接寻址区 = 寄存器组 + DATA（含覆盖区）+ 位变量所占字节（0x20-0x2F），不超过128；
+#           RAM合计 = 直接寻址区 + IDATA（含 idata 顶部的热复位保留记录），栈用剩下的部分，不少于 stackmin
+# 任一项超出预算时返回1
+#
+# 只用 POSIX awk（不依赖 gawk 的 strtonum）
+
+function hex(s,    n, i, c) {
+    sub(/^0[xX]/, "", s)
+    sub(/[hH].*$/, "", s)
+    sub(/\..*$/, "", s)
+    n = 0
+    s = toupper(s)
+    for (i = 1; i <= length(s); i++) {
+        c = index("0123456789ABCDEF", substr(s, i, 1))
+        if (c == 0) {
+            break
+        }
+        n = n * 16 + c - 1
+    }
+    return n
+}
+
+# Keil 位段长度 "0000H.5"：字节.位
+function bits(s,    b) {
+    b = 0
+    if (index(s, ".")) {
+        b = substr(s, index(s, ".") + 1) + 0
+    }
+    return hex(s) * 8 + b
+}
+
+function add(mod, kind, n) {
+    if (!(mod in seen)) {
+        seen[mod] = 1
+        order[++mods] = mod
+    }
+    size[mod, kind] += n
+    total[kind] += n
+}
+
+# Keil 段名 → 模块
+function keilmod(seg,    n, f) {
+    if (seg == "") return "(绝对地址)"
+    if (seg == "_DATA_GROUP_" || seg == "_IDATA_GROUP_" || seg == "_BIT_GROUP_") return "(局部变量覆盖区)"
+    if (seg ~ /^\?C\?LIB/) return "(C51库)"
+    if (seg ~ /^\?C_/) return "(启动代码)"
+    n = split(seg, f, "?")
+    return tolower(f[n])
+}
+
+BEGIN {
+    if (ramsize == "") ramsize = 256
+    if (codesize == "") codesize = 2048
+    if (stackmin == "") stackmin = 40
+    regs = 8
+    rom = -1
+    keil = 0
+}
+
+# ---------------- SDCC .rel ----------------
+/^M / {
+    mod = $2
+    next
+}
+
+/^A [A-Z_0-9]+ size [0-9A-Fa-f]+ / {
+    area = $2
+    n = hex($4)
+    if (n == 0) next
+    if (area == "OSEG") {
+        # 各模块的覆盖区从同一地址开始，占用取最大值
+        if (n > osegMax) osegMax = n
+        add(mod, "DATA", 0)
+        next
+    }
+    if (area == "DSEG") add(mod, "DATA", n)
+    else if (area == "ISEG" || area == "IABS") add(mod, "IDATA", n)
+    else if (area == "BSEG" || area == "BIT_BANK") add(mod, "BIT", n)
+    else if (area == "CSEG" || area == "CONST" || area == "HOME" || area ~ /^GSINIT/ || area == "GSFINAL" || area == "CABS" || area == "XINIT") add(mod, "CODE", n)
+    else if (area == "XSEG" || area == "PSEG" || area == "XISEG" || area == "XABS") add(mod, "XDATA", n)
+    next
+}
+
+/^Stack starts at:/ {
+    stackStart = hex($4)
+    next
+}
+
+/ROM\/EPROM\/FLASH/ {
+    # 名称 起始 结束 字节数 上限
+    rom = $4 + 0
+    next
+}
+
+# ---------------- Keil .m51 ----------------
+/LINK MAP OF MODULE/ {
+    keil = 1
+    next
+}
+
+keil && /^SYMBOL TABLE/ {
+    keil = 0
+    next
+}
+
+keil && $1 ~ /^(REG|DATA|IDATA|BIT|CODE|XDATA)$/ && $2 ~ /^[0-9A-F]+H/ {
+    seg = ($5 == "") ? "" : $5
+    if ($1 == "REG") {
+        # 以 .m51 中实际使用的寄存器组为准
+        if (!regsSeen) {
+            regs = 0
+            regsSeen = 1
+        }
+        regs += hex($3)
+        next
+    }
+    if (seg == "?STACK") {
+        stackStart = hex($2)
+        next
+    }
+    if ($1 == "BIT") add(keilmod(seg), "BIT", bits($3))
+    else if (seg == "_DATA_GROUP_" && $1 == "DATA") osegMax += hex($3)
+    else add(keilmod(seg), $1, hex($3))
+    next
+}
+
+END {
+    if (osegMax) add("(局部变量覆盖区)", "DATA", osegMax)
+
+    printf "%-20s %6s %6s %6s %7s\n", "模块", "DATA", "IDATA", "BIT", "CODE"
+    for (i = 1; i <= mods; i++) {
+        m = order[i]
+        printf "%-20s %6d %6d %6d %7d\n", m, size[m, "DATA"], size[m, "IDATA"], size[m, "BIT"], size[m, "CODE"]
+    }
+    printf "%-20s %6d %6d %6d %7d\n", "合计", total["DATA"], total["IDATA"], total["BIT"], total["CODE"]
+
+    bitBytes = int((total["BIT"] + 7) / 8)
+    direct = regs + total["DATA"] + bitBytes
+    ram = direct + total["IDATA"]
+    stack = ramsize - ram
+    code = (rom >= 0) ? rom : total["CODE"]
+    fail = 0
+
+    printf "\n"
+    printf "直接寻址区  %4d / 128 字节（寄存器组 %d + DATA %d + 位变量 %d 位占 %d 字节）  %s\n",
+           direct, regs, total["DATA"], total["BIT"], bitBytes, (direct <= 128) ? "通过" : "超出"
+    if (direct > 128) fail = 1
+    printf "片内RAM     %4d / %d 字节，栈可用 %d 字节（至少 %d）", ram, ramsize, stack, stackmin
+    if (stackStart) printf "，栈起始 0x%02X", stackStart
+    printf "  %s\n", (stack >= stackmin) ? "通过" : "超出"
+    if (stack < stackmin) fail = 1
+    printf "代码        %4d / %d 字节%s  %s\n", code, codesize, (rom >= 0) ? "（链接结果，含库函数）" : "", (code <= codesize) ? "通过" : "超出"
+    if (code > codesize) fail = 1
+    if (total["XDATA"]) {
+        printf "XDATA       %4d 字节：本机没有外部RAM  超出\n", total["XDATA"]
+        fail = 1
+    }
+    exit fail
+}
@@ -0,0 +1,142 @@
+/**************************************************
+ * 文件名:    buzzer.c
+ * 作者:
+ * 日期:      2025-10-14
+ * 描述:      蜂鸣器模块实现
+ *           音调：Timer1 模式2 自动重装，溢出中断只做 CPL BUZZER_PIN，
+ *                 音调频率完全由硬件重装值决定，不受主循环影响；
+ *                 溢出间隔只有一两百个机器周期，短于Timer0节拍中断，因此Timer1为高优先级，
+ *                 只有同为高优先级的紧急请求中断会推迟它（每次请求可能丢一次翻转）
+ *           音型：code 区步骤表（音调 + 时长），Timer0 每节拍推进一次
+ *           队列：主循环写 buzzerHead、中断写 buzzerTail 的单生产者/单消费者环形队列，
+ *                 与事件队列（event.c）同样不需要关中断
+ **************************************************/
+
+#include "buzzer.h"
+
+/*-----------------------音型步骤表---------------------------*/
+// 音调编号
+#define TONE_OFF  0
+#define TONE_LOW  1
+#define TONE_HIGH 2
+#define TONE_END  0xFF      // 音型结束
+
+// 毫秒换算为Timer0节拍数（编译期常数）
+#define BUZZER_MS(ms) ((unsigned char)(((ms) * 1000UL + TICK_US / 2) / TICK_US))
+
+typedef struct {
+    unsigned char tone;     // TONE_*
+    unsigned char ticks;    // 持续节拍数（1-255）
+} BuzzerStep_t;
+
+static const BuzzerStep_t code buzzerSteps[] = {
+    /* 0: BUZZER_PAT_BEEP */
+    { TONE_LOW,  BUZZER_MS(150) },
+    { TONE_END,  0 },
+    /* 2: BUZZER_PAT_WARN */
+    { TONE_LOW,  BUZZER_MS(80) },
+    { TONE_OFF,  BUZZER_MS(60) },
+    { TONE_LOW,  BUZZER_MS(80) },
+    { TONE_END,  0 },
+    /* 6: BUZZER_PAT_CHIRP */
+    { TONE_HIGH, BUZZER_MS(30) },
+    { TONE_OFF,  BUZZER_MS(30) },
+    { TONE_HIGH, BUZZER_MS(30) },
+    { TONE_OFF,  BUZZER_MS(30) },
+    { TONE_HIGH, BUZZER_MS(30) },
+    { TONE_END,  0 },
+};
+
+// 各音型在步骤表中的起始下标（下标 = BUZZER_PAT_*）
+static const unsigned char code patternStart[BUZZER_PAT_COUNT] = { 0, 0, 2, 6 };
+
+// 各音调的Timer1重装值（下标 = TONE_*，TONE_OFF 不使用）
+static const unsigned char code toneReload[3] = {
+    0, BUZZER_RELOAD(BUZZER_TONE_LOW_HZ), BUZZER_RELOAD(BUZZER_TONE_HIGH_HZ)
+};
+
+/*-----------------------全局变量定义-------------------------*/
+static unsigned char idata buzzerQueue[BUZZER_QUEUE_SIZE];  // 待播放的音型
+static volatile unsigned char buzzerHead = 0;   // 写位置（主循环独占）
+static volatile unsigned char buzzerTail = 0;   // 读位置（中断独占）
+static unsigned char buzzerStep = 0;            // 正在播放的步骤下标
+static unsigned char buzzerDown = 0;            // 当前步剩余节拍，0=空闲
+#if BUZZER_PRESCALE > 1
+static unsigned char buzzerDiv = BUZZER_PRESCALE;   // 溢出分频计数
+#endif
+
+/**
+ * @brief  蜂鸣器初始化
+ */
+void Buzzer_Init(void)
+{
+    BUZZER_PIN = 0;
+    TR1 = 0;
+    TMOD = (TMOD & 0x0F) | 0x20;    // Timer1 模式2（8位自动重装）
+    PT1 = 1;                        // 高优先级：Timer0节拍中断（数百周期）不能推迟翻转或丢掉溢出
+    ET1 = 1;
+}
+
+/**
+ * @brief  投递音型（主循环上下文）
+ */
+unsigned char Buzzer_Play(unsigned char pattern)
+{
+    unsigned char next = (buzzerHead + 1) & (BUZZER_QUEUE_SIZE - 1);
+
+    if (pattern == BUZZER_PAT_NONE || pattern >= BUZZER_PAT_COUNT || next == buzzerTail) {
+        return 0;
+    }
+    buzzerQueue[buzzerHead] = pattern;
+    buzzerHead = next;              // 最后推进写位置，音型对中断可见
+    return 1;
+}
+
+/**
+ * @brief  音型节拍处理（Timer0中断上下文）
+ * @note   每步开始时：发声步写入TH1/TL1重装值并启动Timer1，静音步停止Timer1并拉低引脚
+ */
+void Buzzer_Tick(void)
+{
+    unsigned char tone;
+
+    if (buzzerDown) {
+        if (--buzzerDown) {
+            return;                 // 当前步未结束
+        }
+        buzzerStep++;
+    } else if (buzzerTail == buzzerHead) {
+        return;                     // 空闲：不触碰Timer1
+    } else {
+        buzzerStep = patternStart[buzzerQueue[buzzerTail]];
+        buzzerTail = (buzzerTail + 1) & (BUZZER_QUEUE_SIZE - 1);
+    }
+
+    // 音型结束时 buzzerDown 保持0，下一节拍再从队列取下一个音型
+    tone = buzzerSteps[buzzerStep].tone;
+    buzzerDown = buzzerSteps[buzzerStep].ticks;
+    if (tone == TONE_OFF || tone == TONE_END) {
+        TR1 = 0;
+        BUZZER_PIN = 0;
+    } else {
+        TH1 = toneReload[tone];
+        TL1 = toneReload[tone];
+        TR1 = 1;
+    }
+}
+
+/**
+ * @brief  Timer1中断：翻转蜂鸣器引脚
+ * @note   BUZZER_PRESCALE 为1时只有一条 CPL 指令，不使用任何寄存器，无需保护现场；
+ *         蜂鸣器引脚与P0上的扩展灯/按键共用端口，灯输出用单条 XRL 写高4位，互不覆盖
+ */
+void Buzzer_ISR(void) HAL_ISR(3)
+{
+#if BUZZER_PRESCALE > 1
+    if (--buzzerDiv) {
+        return;
+    }
+    buzzerDiv = BUZZER_PRESCALE;
+#endif
+    BUZZER_PIN = !BUZZER_PIN;
+}
@@ -0,0 +1,53 @@
+/**************************************************
+ * 文件名:    buzzer.h
+ * 作者:
+ * 日期:      2025-10-14
+ * 描述:      蜂鸣器模块头文件
+ *           Timer1 自动重装中断产生方波音调，Timer0 节拍按code区音型表切换音调/静音，
+ *           主循环只把音型编号放入队列，任何时候都不等待
+ **************************************************/
+
+#ifndef __BUZZER_H__
+#define __BUZZER_H__
+
+#include "config.h"
+
+/*-----------------------音型定义-----------------------------*/
+#define BUZZER_PAT_NONE   0   // 不发声（Buzzer_Play 忽略）
+#define BUZZER_PAT_BEEP   1   // 单声提示：低音150ms
+#define BUZZER_PAT_WARN   2   // 放行即将结束：低音两短声
+#define BUZZER_PAT_CHIRP  3   // 行人通行：高音三连啾
+#define BUZZER_PAT_COUNT  4
+
+/*-----------------------函数声明-----------------------------*/
+
+/**
+ * @brief  蜂鸣器初始化（Timer1 模式2，高优先级中断，先不启动）
+ * @param  无
+ * @retval 无
+ * @note   只改写 TMOD 高4位，不影响 Timer0
+ */
+void Buzzer_Init(void);
+
+/**
+ * @brief  投递一个音型（只能在主循环中调用，单生产者）
+ * @param  pattern: BUZZER_PAT_*
+ * @retval 1=已排队，0=队列满或 BUZZER_PAT_NONE（丢弃）
+ * @note   立即返回；音型在当前音型播放完后由 Buzzer_Tick() 依次播放
+ */
+unsigned char Buzzer_Play(unsigned char pattern);
+
+/**
+ * @brief  音型节拍处理（只能在Timer0中断中调用，单消费者）
+ * @param  无
+ * @retval 无
+ * @note   当前步未结束时只做一次减1；步结束时装载下一步的重装值并启停Timer1
+ */
+void Buzzer_Tick(void);
+
+#ifdef __SDCC
+// SDCC 需要在 main 所在编译单元看到中断函数原型才会安装向量
+void Buzzer_ISR(void) HAL_ISR(3);
+#endif
+
+#endif /* __BUZZER_H__ */
@@ -0,0 +1,248 @@
+/**************************************************
+ * 文件名:    command.c
+ * 作者:
+ * 日期:      2025-10-17
+ * 描述:      串口命令模块实现
+ *           接收：串口中断每收到一个字节推进一次状态机（同步→类型→长度→负载→CRC），
+ *                 负载直接写入命令记录的参数字段，CRC 边收边算，没有行缓冲区；
+ *                 帧完整且CRC正确后，中断顺带检查长度和参数范围，记录交给主循环
+ *           交接：cmdReady 为0时只由中断写 cmdMail 并置1，为1时只由主循环读取并清0，
+ *                 与遥测快照（telemetry.c）相同，单个位标志交接不需要关中断
+ *           执行：主循环判断与运行状态有关的条件（设置模式、故障、闪光运行），
+ *                 写影子配时（并存入 EEPROM）或置位 Timer0 的请求字节，回复应答帧
+ **************************************************/
+
+#include "command.h"
+#include "traffic_light.h"
+#include "uart.h"
+#include "eeprom.h"
+
+/*-----------------------接收状态-----------------------------*/
+#define CMD_S_SYNC     0    // 等待同步字节
+#define CMD_S_TYPE     1
+#define CMD_S_LEN      2
+#define CMD_S_PAYLOAD  3
+#define CMD_S_CRC      4
+
+/**
+ * 命令记录：接收中断校验后整理好的、主循环可以直接执行的命令
+ *   type   : 命令（CMD_*）
+ *   result : 中断已能判定的结果（CMD_R_OK / CMD_R_RANGE / CMD_R_TYPE），与运行状态有关的由主循环判定
+ *   arg    : 参数（SET_PLAN：绿灯、黄灯；FORCE_PHASE：相位号；FLASH：1/0）
+ */
+typedef struct {
+    unsigned char type;
+    unsigned char result;
+    unsigned char arg[CMD_MAX_LEN];
+} CmdRecord_t;
+
+/*-----------------------全局变量定义-------------------------*/
+static unsigned char cmdState = CMD_S_SYNC;     // 接收状态（中断独占）
+static unsigned char cmdLen = 0;                // 本帧负载长度
+static unsigned char cmdN = 0;                  // 已收到的负载字节数
+static unsigned char cmdCrc = 0;                // 边收边算的CRC
+static CmdRecord_t idata cmdRx;                 // 正在接收的命令（中断独占）
+static CmdRecord_t idata cmdMail;               // 交给主循环的命令
+static volatile bit cmdReady = 0;               // 1=cmdMail 待主循环取走
+volatile unsigned char cmdRxErrors = 0;         // CRC/长度错误的帧
+volatile unsigned char cmdRxDropped = 0;        // 主循环未取走上一条而丢弃的命令
+
+/**
+ * @brief  检查命令长度和参数范围（串口中断上下文，CRC正确后调用）
+ * @retval CMD_R_OK / CMD_R_RANGE / CMD_R_TYPE
+ */
+static unsigned char Command_Check(void)
+{
+    unsigned char a0 = cmdRx.arg[0];
+    unsigned char a1 = cmdRx.arg[1];
+
+    switch (cmdRx.type) {
+        case CMD_GET_PLAN:
+            return (cmdLen == 0) ? CMD_R_OK : CMD_R_RANGE;
+        case CMD_SET_PLAN:
+            if (cmdLen != 2 || a0 < MIN_LIGHT_TIME || a0 > MAX_LIGHT_TIME ||
+                a1 < MIN_LIGHT_TIME || a1 > MAX_LIGHT_TIME) {
+                return CMD_R_RANGE;
+            }
+            return CMD_R_OK;
+        case CMD_FORCE_PHASE:
+            // 只能强制到放行相位：跳到黄灯、清空相位会让红灯直接变黄灯或跳过过渡
+            return (cmdLen == 1 && a0 < PHASE_COUNT && Phase_Forcible(a0)) ? CMD_R_OK : CMD_R_RANGE;
+        case CMD_FLASH:
+            return (cmdLen == 1 && a0 <= 1) ? CMD_R_OK : CMD_R_RANGE;
+        default:
+            return CMD_R_TYPE;
+    }
+}
+
+/**
+ * @brief  接收一个字节（串口中断上下文）
+ * @note   CRC错误只回到等待同步，不回头在已收字节里重新找同步（没有缓存）；
+ *         上位机一问一答，错帧之后的下一帧从空闲线路开始，可以正常同步
+ */
+void Command_RxByte(unsigned char b)
+{
+    switch (cmdState) {
+        case CMD_S_SYNC:
+            if (b == TLM_SYNC) {
+                cmdState = CMD_S_TYPE;
+            }
+            return;
+
+        case CMD_S_TYPE:
+            cmdRx.type = b;
+            cmdCrc = 0;
+            UART_CRC8(cmdCrc, b);
+            cmdState = CMD_S_LEN;
+            return;
+
+        case CMD_S_LEN:
+            if (b > CMD_MAX_LEN) {
+                cmdRxErrors++;
+                cmdState = CMD_S_SYNC;
+                return;
+            }
+            cmdLen = b;
+            cmdN = 0;
+            cmdRx.arg[0] = 0;
+            cmdRx.arg[1] = 0;
+            UART_CRC8(cmdCrc, b);
+            cmdState = b ? CMD_S_PAYLOAD : CMD_S_CRC;
+            return;
+
+        case CMD_S_PAYLOAD:
+            cmdRx.arg[cmdN++] = b;
+            UART_CRC8(cmdCrc, b);
+            if (cmdN == cmdLen) {
+                cmdState = CMD_S_CRC;
+            }
+            return;
+
+        default:    // CMD_S_CRC
+            cmdState = CMD_S_SYNC;
+            if (b != cmdCrc) {
+                cmdRxErrors++;
+                return;
+            }
+            if (cmdReady) {
+                cmdRxDropped++;
+                return;
+            }
+            cmdRx.result = Command_Check();
+            cmdMail = cmdRx;
+            cmdReady = 1;       // 最后置位：记录对主循环可见
+            return;
+    }
+}
+
+/**
+ * @brief  执行与运行状态有关的命令（主循环上下文）
+ * @retval CMD_R_OK / CMD_R_BUSY
+ * @note   设置模式下配时归按键修改，冲突监视故障后灯输出锁定，都不接受远程命令；
+ *         配时与按键退出设置模式相同，写入影子方案、下一个周期边界生效，
+ *         倒计时由 Timer0 下一个节拍重算（主循环不与中断的秒递减竞争）
+ */
+static unsigned char Command_Apply(unsigned char type, unsigned char a0, unsigned char a1)
+{
+    if (g_isSettingMode || monFault) {
+        return CMD_R_BUSY;
+    }
+    switch (type) {
+        case CMD_SET_PLAN:
+#if EEPROM_ENABLE
+            // 备用扇区已用完、运行中又不能擦除：不修改配时，避免留下掉电即丢的配时
+            if (!Eeprom_CanSave(a0, a1)) {
+                return CMD_R_BUSY;
+            }
+#endif
+            g_time_green = a0;
+            g_time_yellow = a1;
+            g_time_red = a0 + a1;
+            UpdateStateTimeTable();
+            countdownStale = 1;
+#if EEPROM_ENABLE
+            Eeprom_SavePlan();
+#endif
+            return CMD_R_OK;
+
+        case CMD_FORCE_PHASE:
+            if (flashReq || flashStage != FLASH_OFF) {
+                return CMD_R_BUSY;
+            }
+            forcePhase = a0;    // 单字节写入；覆盖尚未执行的上一条强制相位
+            return CMD_R_OK;
+
+        default:    // CMD_FLASH
+            if (a0) {
+                forcePhase = PHASE_NONE;
+            }
+            flashReq = a0;
+            return CMD_R_OK;
+    }
+}
+
+/**
+ * @brief  补齐帧头和CRC后放入发送队列
+ * @param  frame: 负载已写在 frame[3] 起
+ * @param  type:  应答类型
+ * @param  len:   负载长度
+ */
+static void Command_Reply(unsigned char *frame, unsigned char type, unsigned char len)
+{
+    unsigned char crc = 0;
+    unsigned char i;
+
+    frame[0] = TLM_SYNC;
+    frame[1] = type;
+    frame[2] = len;
+    for (i = 1; i < len + 3; i++) {
+        UART_CRC8(crc, frame[i]);
+    }
+    frame[len + 3] = crc;
+
+    // 发送缓冲区满时丢弃（计入 uartTxDropped），上位机超时重发
+    Uart_Send(frame, len + TLM_OVERHEAD);
+}
+
+/**
+ * @brief  执行收到的命令并回复（主循环上下文）
+ */
+void Command_Poll(void)
+{
+    unsigned char frame[CMD_PLAN_FRAME];
+    unsigned char type;
+    unsigned char result;
+    unsigned char a0;
+    unsigned char a1;
+    unsigned char active;
+    unsigned char i;
+
+    if (!cmdReady) {
+        return;
+    }
+    type = cmdMail.type;
+    result = cmdMail.result;
+    a0 = cmdMail.arg[0];
+    a1 = cmdMail.arg[1];
+    cmdReady = 0;               // 记录已复制，中断可以交下一条
+
+    if (type == CMD_GET_PLAN && result == CMD_R_OK) {
+        frame[3] = g_time_green;
+        frame[4] = g_time_yellow;
+        frame[5] = planPending;
+        // planActive 只读一次：即使Timer0随后切换，换下的那一份也只有主循环会写，读到的是完整的一份
+        active = planActive;
+        for (i = 0; i < PHASE_COUNT; i++) {
+            frame[6 + i] = planTime[active][i];
+        }
+        Command_Reply(frame, CMD_REPLY_PLAN, CMD_PLAN_LEN);
+        return;
+    }
+
+    if (result == CMD_R_OK) {
+        result = Command_Apply(type, a0, a1);
+    }
+    frame[3] = type;
+    frame[4] = result;
+    Command_Reply(frame, CMD_REPLY_ACK, CMD_ACK_LEN);
+}
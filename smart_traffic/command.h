@@ -0,0 +1,79 @@
+/**************************************************
+ * 文件名:    command.h
+ * 作者:
+ * 日期:      2025-10-17
+ * 描述:      串口命令模块头文件
+ *           上位机经串口读取/修改配时、强制相位、进入/退出闪光运行。
+ *           串口接收中断逐字节推进状态机解析命令帧（不缓存整行），校验通过后
+ *           整理成可直接执行的命令记录交给主循环；主循环执行后回复应答帧
+ *
+ *           帧格式与遥测帧相同（见 telemetry.h）：
+ *             0xA5 | TYPE | LEN | 负载（LEN字节） | CRC-8（TYPE..负载）
+ *           命令（上位机 → 控制器）：
+ *             0x10 GET_PLAN     LEN=0                 → 回复配时帧
+ *             0x11 SET_PLAN     LEN=2 [绿灯秒, 黄灯秒] → 回复应答帧；下一个周期边界生效
+ *             0x12 FORCE_PHASE  LEN=1 [相位号]         → 回复应答帧；在允许跳转的相位边界进入该相位（只接受放行相位）
+ *             0x13 FLASH        LEN=1 [1=进入, 0=退出] → 回复应答帧
+ *           应答（控制器 → 上位机）：
+ *             0x02 配时帧  LEN=3+PHASE_COUNT [绿灯, 黄灯, 有待切换的配时, 生效方案各相位时长...]
+ *             0x03 应答帧  LEN=2 [命令TYPE, 结果 CMD_R_*]
+ *           CRC错误或长度不符的帧直接丢弃、不回复，上位机超时后重发
+ **************************************************/
+
+#ifndef __COMMAND_H__
+#define __COMMAND_H__
+
+#include "config.h"
+#include "telemetry.h"
+
+/*-----------------------帧格式-------------------------------*/
+#define CMD_GET_PLAN      0x10
+#define CMD_SET_PLAN      0x11
+#define CMD_FORCE_PHASE   0x12
+#define CMD_FLASH         0x13
+#define CMD_MAX_LEN       2         // 命令负载最长字节数（接收状态机据此丢弃过长的帧）
+
+#define CMD_REPLY_PLAN    0x02
+#define CMD_REPLY_ACK     0x03
+#define CMD_PLAN_LEN      (3 + PHASE_COUNT)
+#define CMD_PLAN_FRAME    (CMD_PLAN_LEN + TLM_OVERHEAD)
+#define CMD_ACK_LEN       2
+#define CMD_ACK_FRAME     (CMD_ACK_LEN + TLM_OVERHEAD)
+
+// 应答结果
+#define CMD_R_OK          0         // 已接受（强制相位/闪光在允许跳转的相位边界执行）
+#define CMD_R_RANGE       1         // 参数越界或长度不符
+#define CMD_R_BUSY        2         // 当前状态不能执行（设置模式、冲突监视故障、闪光运行中、配时存储的备用扇区已用完）
+#define CMD_R_TYPE        3         // 未知命令
+
+// 发送缓冲区要能同时放下一帧遥测和最长的应答
+#if TLM_STATUS_FRAME + CMD_PLAN_FRAME > UART_TX_SIZE
+#error "UART_TX_SIZE 放不下一帧遥测加一帧配时应答"
+#endif
+
+/*-----------------------函数声明-----------------------------*/
+
+/**
+ * @brief  接收一个字节（只能在串口中断中调用）
+ * @param  b: 收到的字节（SBUF）
+ * @retval 无
+ * @note   每字节一次状态转移和一次CRC累加（两次查表）；上一条命令主循环还没取走时，
+ *         新命令整条丢弃（cmdRxDropped 加1），上位机收不到应答会重发
+ */
+void Command_RxByte(unsigned char b);
+
+/**
+ * @brief  执行收到的命令并回复（只能在主循环中调用）
+ * @param  无
+ * @retval 无
+ * @note   没有新命令时只判断一次标志；应答放入串口发送队列，不等待
+ */
+void Command_Poll(void);
+
+/**
+ * @brief  接收统计（8位回绕）：CRC/长度错误的帧、主循环未取走而丢弃的命令
+ */
+extern volatile unsigned char cmdRxErrors;
+extern volatile unsigned char cmdRxDropped;
+
+#endif /* __COMMAND_H__ */
@@ -8,57 +8,223 @@
 
 #ifndef __CONFIG_H__
 #define __CONFIG_H__
-#include <reg52.h>
+#include "hal.h"
 /*=======================硬件配置宏定义=======================*/
 
-// 单片机型号说明：80C51兼容芯片
+// 单片机型号说明：80C51兼容芯片（12T/6T/1T均可，见“时钟与时间基准”）
 // 主要指标：工作电压5V，晶振频率12MHz
 
 /*==============================================
  *                引脚定义
  *==============================================*/
 // 调试LED引脚定义
-sbit DEBUG_1S_PIN = P3 ^ 6;    // 1秒指示灯（心跳）
-sbit DEBUG_STATE_PIN = P3 ^ 7; // 状态指示灯
+HAL_SBIT(DEBUG_1S_PIN, P3, 6);    // 1秒指示灯（心跳）
+HAL_SBIT(DEBUG_STATE_PIN, P3, 7); // 状态指示灯
 
 // 南北方向交通灯引脚定义
-sbit NS_RED_PIN = P2 ^ 0;    // 南北红灯
-sbit NS_YELLOW_PIN = P2 ^ 1; // 南北黄灯
-sbit NS_GREEN_PIN = P2 ^ 2;  // 南北绿灯
+HAL_SBIT(NS_RED_PIN, P2, 0);    // 南北红灯
+HAL_SBIT(NS_YELLOW_PIN, P2, 1); // 南北黄灯
+HAL_SBIT(NS_GREEN_PIN, P2, 2);  // 南北绿灯
 
 // 东西方向交通灯引脚定义
-sbit EW_RED_PIN = P2 ^ 3;    // 东西红灯
-sbit EW_YELLOW_PIN = P2 ^ 4; // 东西黄灯
-sbit EW_GREEN_PIN = P2 ^ 5;  // 东西绿灯
+HAL_SBIT(EW_RED_PIN, P2, 3);    // 东西红灯
+HAL_SBIT(EW_YELLOW_PIN, P2, 4); // 东西黄灯
+HAL_SBIT(EW_GREEN_PIN, P2, 5);  // 东西绿灯
+
+// 左转箭头与行人灯引脚定义（PHASE_PLAN_FULL）
+HAL_SBIT(NS_LEFT_PIN, P0, 4);   // 南北左转箭头
+HAL_SBIT(EW_LEFT_PIN, P0, 5);   // 东西左转箭头
+HAL_SBIT(PED_WALK_PIN, P0, 6);  // 行人绿灯
+HAL_SBIT(PED_STOP_PIN, P0, 7);  // 行人红灯
 
 /*==============================================
  *                系统参数定义
  *==============================================*/
-// 交通灯状态定义
-#define STATE_NS_GREEN_EW_RED 0  // 南北绿灯，东西红灯
-#define STATE_NS_YELLOW_EW_RED 1 // 南北黄灯，东西红灯
-#define STATE_NS_RED_EW_GREEN 2  // 南北红灯，东西绿灯
-#define STATE_NS_RED_EW_YELLOW 3 // 南北红灯，东西黄灯
+// 灯输出字节（对应P2.0-P2.5，相位表中每个相位给出一个完整字节）
+#define LAMP_NS_RED     0x01
+#define LAMP_NS_YELLOW  0x02
+#define LAMP_NS_GREEN   0x04
+#define LAMP_EW_RED     0x08
+#define LAMP_EW_YELLOW  0x10
+#define LAMP_EW_GREEN   0x20
+#define LAMP_MASK       0x3F
+#define LAMP_ALL_RED    (LAMP_NS_RED | LAMP_EW_RED)
+
+// 扩展灯字节（对应P0.4-P0.7，左转箭头与行人灯，仅 PHASE_PLAN_FULL 使用）
+#define AUX_NS_LEFT     0x10
+#define AUX_EW_LEFT     0x20
+#define AUX_PED_WALK    0x40
+#define AUX_PED_STOP    0x80
+#define AUX_MASK        0xF0
+
+// 相位方案（编译期选择，相位表位于 code 区，见 traffic_light.c）
+#define PHASE_PLAN_BASIC   0   // 4相位：南北绿→南北黄→东西绿→东西黄
+#define PHASE_PLAN_ALLRED  1   // 6相位：每个黄灯后加全红清空
+#define PHASE_PLAN_FULL    2   // 12相位：保护左转 + 全红清空 + 行人专用相位
+#ifndef PHASE_PLAN
+#define PHASE_PLAN PHASE_PLAN_BASIC
+#endif
+
+#if PHASE_PLAN == PHASE_PLAN_BASIC
+#define PHASE_COUNT 4
+#elif PHASE_PLAN == PHASE_PLAN_ALLRED
+#define PHASE_COUNT 6
+#elif PHASE_PLAN == PHASE_PLAN_FULL
+#define PHASE_COUNT 12
+#else
+#error "PHASE_PLAN 取值无效"
+#endif
+
+// 固定时长相位（单位：秒）
+#define ALL_RED_TIME    2   // 全红清空
+#define LEFT_TURN_TIME  8   // 保护左转
+#define PED_WALK_TIME   10  // 行人通行
+#define PED_CLEAR_TIME  3   // 行人清空
 
 // 时间配置（单位：秒）
 #define GREEN_LIGHT_TIME 3  // 绿灯时间
 #define YELLOW_LIGHT_TIME 3 // 黄灯时间
-#define FLASH_START_TIME 3  // 开始闪烁的剩余时间
-
-// Timer0配置（2ms中断 @ 11.0592MHz）
-#define TIMER0_RELOAD_H 0xA9 // 定时器0重装值高8位
-#define TIMER0_RELOAD_L 0x6A // 定时器0重装值低8位
+#define FLASH_START_TIME 3  // 开始闪烁的剩余时间（相位表 flash 位在最后这几秒每秒后半秒熄灭）
+
+/*-----------------------时钟与时间基准-----------------------*/
+// 以下参数均可在编译选项中覆盖，例如 -DFOSC=33177600UL -DCPU_CLK_DIV=1
+// 所有重装值和延时循环次数都在编译期由这些参数推导，换芯片/晶振无需手工调整
+
+// 晶振频率（Hz），必须是100的整数倍
+#ifndef FOSC
+#define FOSC 12000000UL
+#endif
+
+// 内核时钟分频：12=传统12T（AT89C51/STC89），6=STC89 6T双倍速，1=1T（STC15/STC8）
+#ifndef CPU_CLK_DIV
+#define CPU_CLK_DIV 12
+#endif
+
+// 定时器时钟分频：12T/6T内核与内核相同；1T内核的定时器上电默认仍为12T
+// （设为1时 Timer0_Init 会置位 AUXR.T0x12 使定时器工作在1T）
+#ifndef TIMER0_CLK_DIV
+#if CPU_CLK_DIV == 1
+#define TIMER0_CLK_DIV 12
+#else
+#define TIMER0_CLK_DIV CPU_CLK_DIV
+#endif
+#endif
+
+// DJNZ Rn 指令的振荡周期数（Delay_1ms内循环）：12T/6T为2个机器周期，
+// STC15系列1T为4个时钟，STC8系列为3个时钟（STC8请覆盖为3）
+#ifndef CPU_DJNZ_CLKS
+#if CPU_CLK_DIV == 1
+#define CPU_DJNZ_CLKS 4
+#else
+#define CPU_DJNZ_CLKS (2 * CPU_CLK_DIV)
+#endif
+#endif
+
+// 系统节拍周期（微秒）及允许的节拍周期量化误差（ppm）
+#define TICK_US          2000
+#define TICK_ERR_MAX_PPM 500
+
+#if (FOSC % 100) != 0
+#error "FOSC 必须是100Hz的整数倍"
+#endif
+#if (FOSC / 100) > (2147483647 / TICK_US)
+#error "FOSC × TICK_US 超出编译期计算范围，请减小节拍周期"
+#endif
+#if TIMER0_CLK_DIV != 12 && TIMER0_CLK_DIV != 6 && TIMER0_CLK_DIV != 1
+#error "TIMER0_CLK_DIV 只能是 12、6 或 1"
+#endif
+
+// 一个节拍的振荡周期数 × 10000（精确值，用于误差检查）
+#define TICK_CLKS_X10K   ((FOSC / 100) * TICK_US)
+
+// Timer0配置（模式1，16位）：一个节拍的计数值（四舍五入）和重装值
+#define TIMER0_COUNTS   ((TICK_CLKS_X10K + TIMER0_CLK_DIV * 5000) / (TIMER0_CLK_DIV * 10000))
+#define TIMER0_RELOAD   (65536UL - TIMER0_COUNTS)  // 定时器0重装值
+#define TIMER0_RELOAD_H (TIMER0_RELOAD >> 8)       // 定时器0重装值高8位
+#define TIMER0_RELOAD_L (TIMER0_RELOAD & 0xFF)     // 定时器0重装值低8位
+
+#if TIMER0_COUNTS > 65536 || TIMER0_COUNTS < 100
+#error "节拍周期超出Timer0模式1的计数范围，请调整 TICK_US 或 TIMER0_CLK_DIV"
+#endif
+#define TIMER0_ERR_X10K  (TIMER0_COUNTS * TIMER0_CLK_DIV * 10000 > TICK_CLKS_X10K ? \
+                          TIMER0_COUNTS * TIMER0_CLK_DIV * 10000 - TICK_CLKS_X10K : \
+                          TICK_CLKS_X10K - TIMER0_COUNTS * TIMER0_CLK_DIV * 10000)
+#if TIMER0_ERR_X10K > (TICK_CLKS_X10K / 1000 * TICK_ERR_MAX_PPM / 1000)
+#error "节拍周期量化误差超过 TICK_ERR_MAX_PPM，请更换晶振或节拍周期"
+#endif
+
+// 中断中重装时 TR0=0 停止计数的指令约7个机器周期（12T），折算为定时器计数
+#define TIMER0_STOP_CYCLES ((7 * CPU_CLK_DIV + TIMER0_CLK_DIV / 2) / TIMER0_CLK_DIV)
+
+// 时间基准：每个节拍的实际长度（振荡周期），累计满 FOSC 个即为1秒
+// FOSC = 每秒整节拍数 × 节拍长度 + 余数：中断里只对整节拍数做16位减计数，
+// 余数每秒累加一次（Bresenham），满一个节拍时该秒多计一拍，长期无漂移
+#define TIMEBASE_TICK_CLKS  ((unsigned long)TIMER0_COUNTS * TIMER0_CLK_DIV)
+#define TIMEBASE_SEC_TICKS  (FOSC / TIMEBASE_TICK_CLKS)
+#define TIMEBASE_FRAC_CLKS  (FOSC % TIMEBASE_TICK_CLKS)
+#if FOSC / (TIMER0_COUNTS * TIMER0_CLK_DIV) + 1 > 65535
+#error "每秒节拍数超出16位减计数器"
+#endif
+
+// 半秒对应的节拍数（闪烁节拍用，编译期常量）
+#define HALF_SECOND_TICKS   ((unsigned int)(500000UL / TICK_US))
+
+// Delay_1ms：内循环次数 = (1ms振荡周期 - 调用/外循环开销) / DJNZ周期
+// 开销约12个机器周期（LCALL/RET、两个NOP、赋值、外层DJNZ、Delay_ms循环）
+#define DELAY_1MS_LOOPS  ((FOSC / 1000 - 12 * CPU_CLK_DIV) / CPU_DJNZ_CLKS)
+#define DELAY_1MS_OUTER  ((DELAY_1MS_LOOPS + 255) / 256)
+#define DELAY_1MS_INNER  ((DELAY_1MS_LOOPS - (DELAY_1MS_OUTER - 1) * 256) & 0xFF)
+#if DELAY_1MS_OUTER > 255 || DELAY_1MS_LOOPS < 1
+#error "Delay_1ms 循环次数超出范围"
+#endif
+#if (CPU_DJNZ_CLKS * 1000000 / (FOSC / 1000)) > 5000
+#error "Delay_1ms 量化误差超过0.5%"
+#endif
+
+// Delay_us：每次循环（两个NOP + 16位递减判断）约8个机器周期（1T内核约10个时钟），
+// 每微秒循环次数放大256倍后取整，运行时一次乘法+移位换算
+#if CPU_CLK_DIV == 1
+#define DELAY_US_LOOP_CLKS 10
+#else
+#define DELAY_US_LOOP_CLKS (8 * CPU_CLK_DIV)
+#endif
+#define DELAY_US_SCALE   ((FOSC / 1000 * 256 / DELAY_US_LOOP_CLKS + 500) / 1000)
+
+#if TIMER0_CLK_DIV == 1
+HAL_SFR(AUXR, 0x8E);  // STC15/STC8 辅助寄存器：bit7 T0x12=1 时Timer0工作在1T
+#endif
+
+// Timer0中断耗时测量：1=中断末尾读取定时器计数，记录最坏耗时到 isrMaxCycles
+#define ISR_PROFILE_ENABLE 1
+
+// 空闲模式：1=主循环处理完事件后置 PCON.IDL 休眠，由Timer0节拍中断唤醒
+#define IDLE_ENABLE 1
+// 空闲统计：1=主循环按Timer0计数累计休眠时长，每秒更新 idleCountsLastSecond
+#define IDLE_STATS_ENABLE 1
+// 每秒Timer0计数总数（空闲占比 = idleCountsLastSecond / IDLE_COUNTS_PER_S）
+#define IDLE_COUNTS_PER_S (FOSC / TIMER0_CLK_DIV)
+// PCON 空闲位
+#define PCON_IDL 0x01
 
 /*-----------------------显示器硬件配置-----------------------*/
 // 数码管控制端口
 #define DISPLAY_DATA_PORT P1 // 数码管段码数据端口 (a-g, dp)
 
-// ⚠️ 当前配置：7SEG-MPX2-CA（2位共阳极数码管）
-// 段码已在代码中取反（共阳极特性）
-
-// 7SEG-MPX2-CA 位选控制（直接控制COM引脚）
-sbit DISPLAY_COM1 = P2 ^ 6; // 第1位公共端（高电平导通）
-sbit DISPLAY_COM2 = P2 ^ 7; // 第2位公共端（高电平导通）
+// 当前配置：4位共阳极数码管（南北十位/个位、东西十位/个位），段码已在代码中取反
+// 位选经 74HC139 译码：P2.6 接A、P2.7 接B，输出Y0-Y3（低有效）驱动四位公共端
+HAL_SBIT(DISPLAY_SEL_A, P2, 6); // 74HC139 A输入
+HAL_SBIT(DISPLAY_SEL_B, P2, 7); // 74HC139 B输入
+#define DISPLAY_DIGITS 4        // 数码管位数（每个Timer0节拍点亮一位）
+// 每位刷新率 = 1 / (TICK_US × DISPLAY_DIGITS)，低于100Hz人眼可见闪烁
+#define DISPLAY_REFRESH_HZ (1000000UL / ((unsigned long)TICK_US * DISPLAY_DIGITS))
+#if 1000000 / (TICK_US * DISPLAY_DIGITS) < 100
+#error "数码管每位刷新率低于100Hz，请减小 TICK_US"
+#endif
+// 亮度：扫描时隙表覆盖 DISPLAY_DIM_FRAMES 轮扫描，亮度n（0-7）点亮其中n+1轮
+#define DISPLAY_BRIGHTNESS_LEVELS  8
+#define DISPLAY_BRIGHTNESS_DEFAULT 7    // 上电亮度（常亮）
+#define DISPLAY_DIM_FRAMES         8
+#define DISPLAY_SLOTS              (DISPLAY_DIGITS * DISPLAY_DIM_FRAMES)  // 时隙表长度（必须是2的幂）
 
 // 译码器使能控制（如果需要软件控制，否则硬件接地）
 // sbit DECODER_ENABLE = P3 ^ 0; // 可选的译码器使能控制（低电平有效）
@@ -86,19 +252,293 @@ sbit DISPLAY_COM2 = P2 ^ 7; // 第2位公共端（高电平导通）
 // sbit KEY_SET_MODE = P3 ^ 2;  // 模式设置键（外部中断0）
 // sbit KEY_CONFIRM = P3 ^ 3;   // 确认键
 
-sbit KEY_UP = P0 ^ 0;        // 增加键
-sbit KEY_DOWN = P0 ^ 1;      // 减少键
-sbit KEY_SET_MODE = P0 ^ 2;  // 模式设置键
+HAL_SBIT(KEY_UP, P0, 0);        // 增加键
+HAL_SBIT(KEY_DOWN, P0, 1);      // 减少键
+HAL_SBIT(KEY_SET_MODE, P0, 2);  // 模式设置键
+
+// 按键在P0上的位（低电平=按下），由Timer0节拍整字节采样、并行消抖（见 keys.c）
+#define KEY_BIT_UP      0x01
+#define KEY_BIT_DOWN    0x02
+#define KEY_BIT_SET     0x04
+#define KEY_MASK        (KEY_BIT_UP | KEY_BIT_DOWN | KEY_BIT_SET)
+#define KEY_REPEAT_MASK (KEY_BIT_UP | KEY_BIT_DOWN)   // 长按自动重复的键
+
+// 采样周期：每 KEY_SAMPLE_TICKS 个节拍采样一次（约10ms），连续4次一致才确认
+#define KEY_SAMPLE_MS     10
+#define KEY_SAMPLE_TICKS  ((unsigned char)((KEY_SAMPLE_MS * 1000UL + TICK_US / 2) / TICK_US))
+// 长按：确认按下后 KEY_REPEAT_START 个采样周期开始自动重复，间隔按 keys.c 中的加速表缩短
+#define KEY_REPEAT_START  30
 
 // sbit KEY_EMERGENCY = P0 ^ 2; // 紧急延时键
 
+/*-----------------------紧急优先配置-------------------------*/
+// 紧急车辆检测器输出（有请求时拉低）：下降沿触发外部中断，中断服务第一条语句写出安全灯色，
+// 对向绿灯立即转黄灯，随后全红清空，请求方向放行（清空时序见 traffic_light.c）。
+// 最坏响应（机器周期，从引脚下降沿到P2改变）= 中断响应(≤9) + 最长灯输出临界区 + 蜂鸣器中断
+//   + 一次 IAP 字节编程 + 中断入口到写P2：
+//   高优先级中断只有 INT0/INT1 和 Timer1（蜂鸣器），同级不能互相抢占，紧急请求最多再等一次蜂鸣器中断
+//   （BUZZER_ISR_CYCLES，见下面的蜂鸣器配置）；INT0/INT1 只在灯输出临界区（LAMP_LOCK，无循环）内被屏蔽，
+//   主循环从不关中断；保存配时时CPU在每次 IAP 操作期间暂停，响应紧急请求时只做字节编程
+//   （EEPROM_STALL_CYCLES，擦除留到紧急请求被屏蔽时，见配时存储配置），因此上限与运行状态无关；
+//   实测周期数见 bench 的 Emergency_* 行
+HAL_SBIT(EMERGENCY_NS_PIN, P3, 2);  // INT0：南北方向请求
+HAL_SBIT(EMERGENCY_EW_PIN, P3, 3);  // INT1：东西方向请求
+
+/*-----------------------感应控制配置-------------------------*/
+// 0=定时控制（相位表固定时长）；1=感应控制：按车辆检测器延长、提前结束或跳过绿灯（traffic_light.c）
+#ifndef ACTUATED_ENABLE
+#define ACTUATED_ENABLE 0
+#endif
+
+// 车辆检测器输出（线圈/地磁检测器，有车时拉低），接在 T0/T1 引脚上但只作普通输入：
+// Timer0=节拍、Timer1=蜂鸣器音调、Timer2=串口波特率，INT0/INT1=紧急优先，没有空闲的计数器，
+// 因此与按键一样在Timer0节拍中每 DETECTOR_SAMPLE_TICKS 整字节采样一次P3，连续两次一致才确认（detector.c），
+// 耗时见 bench 的 Detector_Tick 行
+HAL_SBIT(DETECTOR_NS_PIN, P3, 4);   // T0：南北方向检测器
+HAL_SBIT(DETECTOR_EW_PIN, P3, 5);   // T1：东西方向检测器
+#define DET_BIT_NS  0x10            // P3 中的位（下标顺序与方向 0=南北 1=东西 一致）
+#define DET_BIT_EW  0x20
+#define DET_MASK    (DET_BIT_NS | DET_BIT_EW)
+#define DETECTOR_SAMPLE_TICKS KEY_SAMPLE_TICKS   // 约10ms，一辆车经过线圈至少占用数百毫秒
+
+// 绿灯时长：可调绿灯时间作为最长绿灯（max-out），有冲突方向的请求时才会走完；
+// 已放行 ACT_MIN_GREEN 秒后连续 ACT_PASSAGE_TIME 秒没有车辆则提前结束（gap-out），
+// 结束前照常闪烁 FLASH_START_TIME 秒；冲突方向没有车辆时绿灯停在 ACT_REST_TIME 秒等待
+#define ACT_MIN_GREEN    5  // 最短绿灯（秒）
+#define ACT_PASSAGE_TIME 3  // 每辆车延长的绿灯（秒，即允许的最大车头时距）
+#define ACT_REST_TIME    ((BUZZER_THRESHOLD > FLASH_START_TIME ? BUZZER_THRESHOLD : FLASH_START_TIME) + 1)
+
+/*-----------------------冲突监视与看门狗配置-----------------*/
+// 冲突监视：Timer0每个节拍末尾读回P2（FULL方案还有P0.4-P0.7）的实际输出，按code区兼容表查表判断，
+// 每节拍固定的几条指令（MOVC查表 + 与 + 判0），与相位、闪烁、紧急优先状态无关。
+// 违例（两个方向同时放行、同一方向多灯、六灯全灭、左转/行人与机动车同时放行等）时锁定故障：
+// 四面红灯闪烁、行人红灯常亮，屏蔽紧急请求，相位表停止，直到复位（见 traffic_light.c）
+// 看门狗：每个节拍末尾喂狗，但只有主循环在上次喂狗之后运行过才喂，
+// 节拍中断或主循环任一停止都会在 WDT_MIN_MS 以上、约两倍以内复位；主循环第一次运行后由节拍启动
+#ifndef WDT_ENABLE
+#define WDT_ENABLE 1
+#endif
+#define WDT_MIN_MS 100      // 最短溢出时间（毫秒），须大于主循环最长的一次处理
+
+// STC WDT_CONTR：STC89/STC90 在 0xE1，STC12/STC15/STC8（1T）在 0xC1；标准8052没有看门狗，写入无效
+#ifndef WDT_CONTR_ADDR
+#if CPU_CLK_DIV == 1
+#define WDT_CONTR_ADDR 0xC1
+#else
+#define WDT_CONTR_ADDR 0xE1
+#endif
+#endif
+#if WDT_ENABLE
+HAL_SFR(WDT_CONTR, WDT_CONTR_ADDR);
+#endif
+#define WDT_EN_WDT   0x20   // 启动（只能由复位关闭）
+#define WDT_CLR_WDT  0x10   // 清零计数（喂狗）
+#define WDT_IDLE_WDT 0x08   // 空闲模式下继续计数（主循环在 PCON.IDL 中停住同样会复位）
+
+// 溢出时间 = 12 × 2^(PS+1) × 32768 / FOSC，取满足 WDT_MIN_MS 的最小预分频
+#define WDT_COUNTS(ps) (12UL * 32768UL * (2UL << (ps)))
+#define WDT_NEED       (WDT_MIN_MS * (FOSC / 1000UL))
+#if WDT_COUNTS(0) >= WDT_NEED
+#define WDT_PS 0
+#elif WDT_COUNTS(1) >= WDT_NEED
+#define WDT_PS 1
+#elif WDT_COUNTS(2) >= WDT_NEED
+#define WDT_PS 2
+#elif WDT_COUNTS(3) >= WDT_NEED
+#define WDT_PS 3
+#elif WDT_COUNTS(4) >= WDT_NEED
+#define WDT_PS 4
+#elif WDT_COUNTS(5) >= WDT_NEED
+#define WDT_PS 5
+#elif WDT_COUNTS(6) >= WDT_NEED
+#define WDT_PS 6
+#elif WDT_COUNTS(7) >= WDT_NEED
+#define WDT_PS 7
+#else
+#error "看门狗最大溢出时间小于 WDT_MIN_MS"
+#endif
+#define WDT_FEED (WDT_EN_WDT | WDT_CLR_WDT | WDT_IDLE_WDT | WDT_PS)
+
 /*-----------------------蜂鸣器配置---------------------------*/
-sbit BUZZER_PIN = P0 ^ 3; // 蜂鸣器控制端口
+HAL_SBIT(BUZZER_PIN, P0, 3); // 蜂鸣器控制端口（无源蜂鸣器，经三极管驱动，空闲时保持低电平）
+
+// Timer1 模式2（8位自动重装）每次溢出中断翻转 BUZZER_PIN 产生方波，音调即重装值
+// 定时器时钟分频：与 TIMER0_CLK_DIV 相同的规则（1T内核的定时器上电默认12T）
+#ifndef TIMER1_CLK_DIV
+#if CPU_CLK_DIV == 1
+#define TIMER1_CLK_DIV 12
+#else
+#define TIMER1_CLK_DIV CPU_CLK_DIV
+#endif
+#endif
+
+#define BUZZER_TONE_LOW_HZ  2000    // 警告音
+#define BUZZER_TONE_HIGH_HZ 4000    // 行人提示音
+
+// 方波半周期的Timer1计数；8位重装最多256个计数，晶振较高时每 BUZZER_PRESCALE 次溢出才翻转一次
+#define BUZZER_HALF_COUNTS(hz) (FOSC / TIMER1_CLK_DIV / (2UL * (hz)))
+#define BUZZER_PRESCALE        ((BUZZER_HALF_COUNTS(BUZZER_TONE_LOW_HZ) + 255) / 256)
+#define BUZZER_RELOAD(hz)      ((unsigned char)(256 - BUZZER_HALF_COUNTS(hz) / BUZZER_PRESCALE))
+#if FOSC / TIMER1_CLK_DIV / (2 * BUZZER_TONE_HIGH_HZ) / \
+    ((FOSC / TIMER1_CLK_DIV / (2 * BUZZER_TONE_LOW_HZ) + 255) / 256) < 40
+#error "蜂鸣器高音的溢出间隔少于40个计数，Timer1中断占用过多CPU，请降低 BUZZER_TONE_HIGH_HZ"
+#endif
+
+// Timer1中断（高优先级）推迟紧急请求的最长时间（机器周期，手工计数：bench 用Timer1计时，不能自测）：
+// 向量 LCALL 2 + LJMP 2 + 函数体 + RETI 2；函数体为 CPL 1，分频时另加 DJNZ 2 + MOV 2
+#if BUZZER_PRESCALE > 1
+#define BUZZER_ISR_CYCLES 11
+#else
+#define BUZZER_ISR_CYCLES 7
+#endif
+
+// 音型队列长度（必须是2的幂），主循环投递、Timer0节拍播放
+#define BUZZER_QUEUE_SIZE 4
+
+/*-----------------------串口遥测配置-------------------------*/
+// 硬件串口（P3.0 RXD / P3.1 TXD）方式1（8N1），Timer2 作收发波特率发生器（RCLK=TCLK=1），
+// Timer1 已用于蜂鸣器。发送由中断从环形缓冲区逐字节取出，主循环只入队、不查询 TI
+// 1T系列的波特率发生器寄存器不同（STC12 为独立BRT，STC15 的T2不在 T2CON），需移植 Uart_Init()
+#ifndef UART_ENABLE
+#if CPU_CLK_DIV == 1
+#define UART_ENABLE 0
+#else
+#define UART_ENABLE 1
+#endif
+#endif
+
+#define UART_BAUD 9600UL
+
+// Timer2 波特率 = FOSC / (UART_T2_CLKS × (65536 - RCAP2))，12T内核 UART_T2_CLKS=32，6T内核为16
+#define UART_T2_CLKS   (32UL * CPU_CLK_DIV / 12)
+#define UART_DIVISOR   ((FOSC + UART_T2_CLKS * UART_BAUD / 2) / (UART_T2_CLKS * UART_BAUD))
+#define UART_RELOAD    ((unsigned int)(65536UL - UART_DIVISOR))
+#if UART_ENABLE
+#if UART_DIVISOR < 1 || UART_DIVISOR > 65535
+#error "Timer2 无法产生 UART_BAUD"
+#endif
+// 8N1 双方波特率误差之和需小于约4%，本机取2%
+#if FOSC / UART_T2_CLKS / UART_DIVISOR > UART_BAUD * 102 / 100 || \
+    FOSC / UART_T2_CLKS / UART_DIVISOR < UART_BAUD * 98 / 100
+#error "UART_BAUD 与晶振不匹配，波特率误差超过2%"
+#endif
+#endif
+
+// 发送环形缓冲区长度（必须是2的幂且不超过128），至少容纳两帧遥测
+#define UART_TX_SIZE 32
+
+// 遥测状态帧频率：Timer0 节拍按此间隔抓取快照，主循环组帧入队
+#define TELEMETRY_HZ    10
+#define TELEMETRY_TICKS ((1000000UL / TELEMETRY_HZ + TICK_US / 2) / TICK_US)
+#if TELEMETRY_TICKS < 1 || TELEMETRY_TICKS > 255
+#error "TELEMETRY_HZ 超出范围（抓取间隔须为1-255个节拍）"
+#endif
+
+/*-----------------------配时存储配置-------------------------*/
+// 按键/远程命令修改的配时保存在片内 EEPROM（STC89C52RC：IAP 地址 0x2000 起，每扇区512字节）。
+// 日志结构：每次保存追加一条带序号和CRC的记录，写满一个扇区换到下一个扇区，
+// EEPROM_SECTORS 个扇区轮流擦除（磨损均衡）；上电顺序扫描一遍，恢复序号最新且CRC正确的记录（见 eeprom.c）
+// 1T系列（STC12/STC15/STC8）的 IAP 寄存器地址、触发序列和等待时间都不同，需移植 eeprom.c
+#ifndef EEPROM_ENABLE
+#if CPU_CLK_DIV == 1
+#define EEPROM_ENABLE 0
+#else
+#define EEPROM_ENABLE 1
+#endif
+#endif
+
+#define EEPROM_BASE        0x2000  // 第一个扇区的 IAP 地址
+#define EEPROM_SECTOR_SIZE 512
+#define EEPROM_SECTORS     2       // 轮流使用的扇区数（2-8，STC89C52RC 共8个扇区）
+
+#if EEPROM_ENABLE
+// STC89 数据手册中名为 ISP_DATA 等，地址相同
+HAL_SFR(IAP_DATA,  0xE2);
+HAL_SFR(IAP_ADDRH, 0xE3);
+HAL_SFR(IAP_ADDRL, 0xE4);
+HAL_SFR(IAP_CMD,   0xE5);
+HAL_SFR(IAP_TRIG,  0xE6);
+HAL_SFR(IAP_CONTR, 0xE7);
+
+#define IAP_CMD_READ    1
+#define IAP_CMD_PROGRAM 2
+#define IAP_CMD_ERASE   3
+#define IAP_EN          0x80    // IAP_CONTR.7 允许 IAP 操作
+
+// IAP_CONTR 低3位：CPU等待 IAP 完成的时间，按晶振选择
+#if FOSC <= 5000000UL
+#define IAP_WAIT 3
+#elif FOSC <= 10000000UL
+#define IAP_WAIT 2
+#elif FOSC <= 20000000UL
+#define IAP_WAIT 1
+#elif FOSC <= 40000000UL
+#define IAP_WAIT 0
+#else
+#error "STC89 IAP 支持的晶振不超过40MHz"
+#endif
+
+// IAP 操作期间CPU暂停、不响应中断（数据手册：字节编程约55µs，扇区擦除约21ms）。
+// 擦除只在紧急请求中断被屏蔽时进行（eeprom.c），紧急请求最多被一次字节编程推迟：
+#define EEPROM_PROG_US      55
+#define EEPROM_STALL_CYCLES ((EEPROM_PROG_US * (FOSC / 1000UL) + 1000UL * CPU_CLK_DIV - 1) / (1000UL * CPU_CLK_DIV))
+#else
+#define EEPROM_STALL_CYCLES 0
+#endif
+
+/*-----------------------快速启动配置-------------------------*/
+// 复位到灯输出：STARTUP.A51（SDCC 为 traffic_light.c 中的 crt0 启动钩子）第一条指令就把端口写成全红（复位值0xFF会点亮全部灯），
+// System_Init() 不再延时等待，8888 自检显示留到第一个秒边界，Timer0 启动即按相位运行。
+// 热复位（看门狗、复位键，PCON.POF=0）时从 idata 顶部的保留记录接回原相位和剩余时间，
+// 记录无效则全红 ALL_RED_TIME 秒后从相位0开始；上电复位（POF=1）RAM 内容不可信，直接从相位0开始
+// 0=原流程：8888 显示1秒后启动，每次复位都从相位0开始
+#ifndef FAST_BOOT_ENABLE
+#define FAST_BOOT_ENABLE 1
+#endif
+
+// 复位后最先写出的端口值，STARTUP.A51 的 LAMPSAFE/AUXSAFE 须相同（SDCC 的启动钩子直接使用）
+#define BOOT_P2_SAFE 0xC9   // 四面红灯，位选线为高（段码端口复位为0xFF，数码管不亮）
+#define BOOT_P0_SAFE 0x87   // 按键输入保持1，蜂鸣器低，左转/行人绿灯熄灭，行人红灯亮
+
+#if (BOOT_P2_SAFE & LAMP_MASK) != LAMP_ALL_RED || (BOOT_P0_SAFE & AUX_MASK) != AUX_PED_STOP
+#error "BOOT_P2_SAFE/BOOT_P0_SAFE 不是全红"
+#endif
+
+// 热复位保留记录（4字节）：启动代码只清零 idata 0x00-0x7F（STARTUP.A51 IDATALEN），
+// 放在 idata 顶部，栈不能增长到这里（见RAM预算）；SDCC 的 crt0 清零全部 idata，记录经启动钩子暂存（Boot_Reclaim）
+#define BOOT_KEEP_ADDR 0xFC
+// PCON 上电标志（STC89：PCON.4 POF，上电复位置1，软件清0）
+#define PCON_POF 0x10
+
+/*-----------------------节拍任务调度配置---------------------*/
+// 蜂鸣器、按键、检测器、遥测由 sched.c 的任务表分派（周期、偏移），不再各自在中断里分频。
+// 按键/检测器/遥测的周期都是 KEY_SAMPLE_TICKS 的整数倍（检测器与按键同周期），
+// 偏移对 KEY_SAMPLE_TICKS 取余各不相同，因此永远不在同一节拍运行；蜂鸣器每个节拍运行（音型步长以节拍计）
+#define SCHED_KEYS_OFFSET       0
+#define SCHED_DETECTOR_OFFSET   2
+#define SCHED_TELEMETRY_OFFSET  4
+
+// 即 KEY_SAMPLE_TICKS（不带类型转换，供 #if 使用）
+#define SCHED_SLOT_TICKS ((KEY_SAMPLE_MS * 1000UL + TICK_US / 2) / TICK_US)
+#if SCHED_SLOT_TICKS <= SCHED_TELEMETRY_OFFSET || TELEMETRY_TICKS % SCHED_SLOT_TICKS != 0
+#error "节拍任务的偏移无法错开：遥测周期须为按键采样周期的整数倍，且按键采样周期须大于各偏移"
+#endif
+
+// 1=每次运行读取Timer0计数计时（每个到期任务多约20个机器周期），超出预算计数
+#define SCHED_BUDGET_ENABLE 1
+// 预算（12T机器周期，含调用和计时本身）：按指令数估算，bench 的 Sched:* 行为实测最长耗时；
+// 计时包含期间抢占的高优先级中断（蜂鸣器发声时每次约 BUZZER_ISR_CYCLES），预算按此留有余量
+#define SCHED_BUDGET_BUZZER     60      // 步结束时装载重装值、启停Timer1
+#define SCHED_BUDGET_KEYS       100     // 采样、消抖、自动重复、投递事件
+#define SCHED_BUDGET_DETECTOR   60      // 采样、确认、累计车辆数
+#define SCHED_BUDGET_TELEMETRY  80      // 抓取快照
+// 机器周期换算为Timer0计数（向上取整；1T内核一个机器周期按一个时钟计）
+#define SCHED_COUNTS(cycles) ((unsigned int)(((cycles) * (unsigned long)CPU_CLK_DIV + TIMER0_CLK_DIV - 1) / TIMER0_CLK_DIV))
 
 /*-----------------------扩展接口配置-------------------------*/
-// 预留蓝牙模块接口
-sbit BLUETOOTH_RX = P3 ^ 4; // 蓝牙接收端口
-sbit BLUETOOTH_TX = P3 ^ 5; // 蓝牙发送端口
+// 预留蓝牙模块接口（透传模块接硬件串口 RXD/TXD，与遥测共用；P3.4/P3.5 已用于车辆检测器）
+HAL_SBIT(BLUETOOTH_RX, P3, 0); // 蓝牙接收端口
+HAL_SBIT(BLUETOOTH_TX, P3, 1); // 蓝牙发送端口
 
 // // 预留WiFi/网络模块接口
 // sbit WIFI_CS = P1 ^ 4;  // WiFi片选
@@ -111,8 +551,8 @@ sbit BLUETOOTH_TX = P3 ^ 5; // 蓝牙发送端口
 // sbit FAN_CONTROL = P1 ^ 7; // 风扇控制端口
 
 // 红外遥控接口
-sbit IR_RECEIVER = P3 ^ 6;    // 红外接收端口
-sbit IR_RECEIVE_PIN = P3 ^ 6; // 红外接收端口（别名）
+HAL_SBIT(IR_RECEIVER, P3, 6);    // 红外接收端口
+HAL_SBIT(IR_RECEIVE_PIN, P3, 6); // 红外接收端口（别名）
 
 // 扩展模块电源控制
 // sbit EXT_POWER_PIN = P1 ^ 3; // 扩展模块电源控制
@@ -132,11 +572,12 @@ sbit IR_RECEIVE_PIN = P3 ^ 6; // 红外接收端口（别名）
 // 时间限制配置
 #define MIN_LIGHT_TIME 1        // 最小灯时间（原为5，导致初始默认值3无法再减少）
 #define MAX_LIGHT_TIME 99       // 最大灯时间
-#define EMERGENCY_EXTEND_TIME 5 // 紧急延时时间
+#define EMERGENCY_EXTEND_TIME 5 // 紧急绿灯在请求撤销后继续保持的时间（也是最短紧急绿灯）
+#define EMERGENCY_MAX_TIME 60   // 请求线持续为低时紧急绿灯最长保持时间（检测器故障时不长期占用路口）
 
 /*-----------------------显示和提示配置-----------------------*/
 #define BLINK_THRESHOLD 3  // 开始闪烁的剩余时间
-#define BUZZER_THRESHOLD 5 // 开始蜂鸣器提示的剩余时间
+#define BUZZER_THRESHOLD 5 // 开始蜂鸣器提示的剩余时间（有闪烁灯的相位每秒响一次警告音）
 #define BLINK_INTERVAL 500 // 闪烁间隔（毫秒）
 
 /*-----------------------系统状态定义-------------------------*/
@@ -0,0 +1,50 @@
+/**************************************************
+ * 文件名:    detector.c
+ * 作者:
+ * 日期:      2025-10-15
+ * 描述:      车辆检测器采样模块实现
+ *           与按键（keys.c）相同的整字节采样：一次读P3同时处理两个方向，
+ *           采样值与上次采样相同且与确认状态不同才翻转状态（约20ms滤除继电器抖动），
+ *           状态由无车变为有车即一辆车到达
+ **************************************************/
+
+#include "detector.h"
+
+/*-----------------------全局变量定义-------------------------*/
+volatile unsigned char detState = 0;            // 消抖后的状态（1=有车）
+volatile unsigned char detCount[2] = {0, 0};    // 各方向累计车辆数
+static unsigned char detLast = 0;               // 上次采样值（1=有车）
+static unsigned char detArrived = 0;            // 上次 Detector_Take() 以来有车辆到达的方向
+
+/**
+ * @brief  检测器节拍处理（Timer0中断上下文）
+ */
+void Detector_Tick(void)
+{
+    unsigned char raw;
+    unsigned char changed;
+
+    // 整字节采样（低电平=有车）；与上次采样一致、与确认状态不同的位翻转
+    raw = ~P3 & DET_MASK;
+    changed = (raw ^ detState) & ~(raw ^ detLast);
+    detLast = raw;
+    if (!changed) {
+        return;
+    }
+    detState ^= changed;
+    changed &= detState;                // 本次确认到达的方向
+    detArrived |= changed;
+    if (changed & DET_BIT_NS) detCount[0]++;
+    if (changed & DET_BIT_EW) detCount[1]++;
+}
+
+/**
+ * @brief  取出有车辆的方向（Timer0中断上下文）
+ */
+unsigned char Detector_Take(void)
+{
+    unsigned char seen = detArrived | detState;
+
+    detArrived = 0;
+    return seen;
+}
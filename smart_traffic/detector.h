@@ -0,0 +1,41 @@
+/**************************************************
+ * 文件名:    detector.h
+ * 作者:
+ * 日期:      2025-10-15
+ * 描述:      车辆检测器采样模块头文件
+ *           在Timer0节拍中整字节采样两个方向的检测器（P3.4/P3.5），
+ *           两次一致才确认；记录车辆到达供感应控制每秒取用，并累计各方向车辆数
+ **************************************************/
+
+#ifndef __DETECTOR_H__
+#define __DETECTOR_H__
+
+#include "config.h"
+
+/**
+ * @brief  检测器节拍处理（只能在Timer0中断中调用）
+ * @param  无
+ * @retval 无
+ * @note   每次调用采样一次，由节拍任务调度（sched.c）每 DETECTOR_SAMPLE_TICKS 个节拍调用
+ */
+void Detector_Tick(void);
+
+/**
+ * @brief  取出上次调用以来有车辆的方向（只能在Timer0中断中调用）
+ * @param  无
+ * @retval DET_BIT_* 的组合：期间有车辆到达，或此刻检测器仍被占用（排队车辆停在线圈上）
+ * @note   清除到达记录；与 Detector_Tick() 同在Timer0中断中，不需要关中断
+ */
+unsigned char Detector_Take(void);
+
+/**
+ * @brief  已消抖的检测器状态（DET_BIT_*，1=有车）
+ */
+extern volatile unsigned char detState;
+
+/**
+ * @brief  各方向累计车辆数（下标 0=南北 1=东西，8位回绕，读取方取差值）
+ */
+extern volatile unsigned char detCount[2];
+
+#endif /* __DETECTOR_H__ */
@@ -8,11 +8,11 @@
 
 #include "display.h"
 #include "config.h"
-// #include "timer.h"
+#include "timer.h"
 
 /*-----------------------数码管显示表-------------------------*/
-// 共阳极数码管段码表（原共阴极段码取反）
-static const unsigned char segmentTable[] = {
+// 共阳极数码管段码表（原共阴极段码取反），按半字节查表：0-9 为数字，0xA-0xF 为设置模式的颜色字母与空白
+static const unsigned char code segmentTable[16] = {
     ~0x3F,   // 0 → 0xC0
     ~0x06,   // 1 → 0xF9
     ~0x5B,   // 2 → 0xA4
@@ -22,11 +22,17 @@ static const unsigned char segmentTable[] = {
     ~0x7D,   // 6 → 0x82
     ~0x07,   // 7 → 0xF8
     ~0x7F,   // 8 → 0x80
-    ~0x6F    // 9 → 0x90
+    ~0x6F,   // 9 → 0x90
+    ~0x50,   // A: r → 0xAF
+    ~0x6E,   // B: y → 0x91
+    ~0x3D,   // C: G → 0xC2
+    ~0x00,   // D: 空白 → 0xFF
+    ~0x00,   // E: 空白
+    ~0x00    // F: 空白
 };
 
 /* 如果是共阴极数码管，请恢复原来的段码：
-static const unsigned char segmentTable[] = {
+static const unsigned char code segmentTable[16] = {
     0x3F,   // 0
     0x06,   // 1
     0x5B,   // 2
@@ -36,10 +42,38 @@ static const unsigned char segmentTable[] = {
     0x7D,   // 6
     0x07,   // 7
     0x7F,   // 8
-    0x6F    // 9
+    0x6F,   // 9
+    0x50,   // A: r
+    0x6E,   // B: y
+    0x3D,   // C: G
+    0x00,   // D: 空白
+    0x00,   // E: 空白
+    0x00    // F: 空白
 };
 */
 
+/*-----------------------亮度与扫描时隙表-------------------------*/
+// 各亮度级别在 DISPLAY_DIM_FRAMES 轮扫描中点亮的轮次（位k=第k轮点亮），点亮轮次尽量均匀分布
+static const unsigned char code dimPattern[DISPLAY_BRIGHTNESS_LEVELS] = {
+    0x01, 0x11, 0x49, 0x55, 0x5B, 0x77, 0x7F, 0xFF
+};
+// 扫描顺序（格雷码）：时隙 s 点亮第 scanOrder[s % 4] 位
+static const unsigned char code scanOrder[DISPLAY_DIGITS] = {0, 1, 3, 2};
+
+/*-----------------------全局变量定义-------------------------*/
+unsigned char displayBrightness = DISPLAY_BRIGHTNESS_DEFAULT;
+
+/*-----------------------扫描状态-----------------------------*/
+// 帧缓冲：每一位预先准备好的段码（已取反），由主循环写
+// 下标即74HC139的BA输入：0=南北十位 1=南北个位 2=东西十位 3=东西个位
+static unsigned char displayBuffer[DISPLAY_DIGITS] = {0xFF, 0xFF, 0xFF, 0xFF};
+// 扫描时隙表：由帧缓冲、亮度、闪烁预先展开成每个节拍要送出的段码（熄灭时为0xFF），中断只读
+static volatile unsigned char idata displaySlots[DISPLAY_SLOTS];
+// 当前时隙（低2位按格雷码决定位选，与 DISPLAY_SEL_B/DISPLAY_SEL_A 引脚一致）
+static unsigned char scanSlot = 0;
+static unsigned char blinkMask = 0;     // 闪烁的位（位k=第k位）
+static bit blinkOff = 0;                // 1=当前处于闪烁熄灭的半秒
+
 /*-----------------------函数实现-----------------------------*/
 
 /**
@@ -49,74 +83,173 @@ void Display_Init(void)
 {
     // 初始化显示端口（共阳极数码管用0xFF消隐）
     DISPLAY_DATA_PORT = 0xFF;    // 消隐显示（共阳极）
-    DISPLAY_COM1 = 0;            // 关闭第1位
-    DISPLAY_COM2 = 0;            // 关闭第2位
+    scanSlot = 0;                // 译码器选中第0位，与时隙0一致
+    DISPLAY_SEL_A = 0;
+    DISPLAY_SEL_B = 0;
+    Display_Refresh();
+}
+
+/**
+ * @brief  按帧缓冲、亮度和闪烁状态重建扫描时隙表
+ * @note   主循环在显示内容或效果变化时调用（约每秒1-3次，每次 DISPLAY_SLOTS 步），
+ *         中断里的 Display_Scan() 因此与亮度/闪烁无关，只做一次查表。
+ *         重建过程中被中断读到的时隙新旧混合，最多持续一轮扫描，不可见
+ */
+void Display_Refresh(void)
+{
+    unsigned char s;
+    unsigned char digit;
+    unsigned char frames = dimPattern[displayBrightness];
+    unsigned char dark = blinkOff ? blinkMask : 0;
+
+    for (s = 0; s < DISPLAY_SLOTS; s++) {
+        digit = scanOrder[s & (DISPLAY_DIGITS - 1)];
+        if ((frames & (1 << (s / DISPLAY_DIGITS))) && !(dark & (1 << digit))) {
+            displaySlots[s] = displayBuffer[digit];
+        } else {
+            displaySlots[s] = 0xFF;
+        }
+    }
+}
+
+/**
+ * @brief  设置显示亮度
+ * @param  brightness: 0-7（超过按7处理），7=常亮，0=八轮中点亮一轮
+ */
+void Display_SetBrightness(unsigned char brightness)
+{
+    if (brightness >= DISPLAY_BRIGHTNESS_LEVELS) {
+        brightness = DISPLAY_BRIGHTNESS_LEVELS - 1;
+    }
+    if (brightness != displayBrightness) {
+        displayBrightness = brightness;
+        Display_Refresh();
+    }
+}
+
+/**
+ * @brief  设置某一位是否闪烁
+ * @param  pos: DISPLAY_POS_NS_LEFT..DISPLAY_POS_EW_RIGHT，其余忽略
+ * @param  enable: 1=闪烁 0=常亮
+ * @note   闪烁的亮/灭由 Display_BlinkPhase() 在半秒边界切换
+ */
+void Display_Blink(DisplayPos_t pos, unsigned char enable)
+{
+    unsigned char mask;
+
+    if (pos >= DISPLAY_DIGITS) {
+        return;
+    }
+    mask = enable ? (blinkMask | (1 << pos)) : (blinkMask & ~(1 << pos));
+    if (mask != blinkMask) {
+        blinkMask = mask;
+        Display_Refresh();
+    }
+}
+
+/**
+ * @brief  切换闪烁的亮/灭半秒
+ * @param  on: 1=亮（秒边界） 0=灭（半秒边界）
+ * @note   没有闪烁的位时不重建时隙表
+ */
+void Display_BlinkPhase(unsigned char on)
+{
+    blinkOff = !on;
+    if (blinkMask) {
+        Display_Refresh();
+    }
+}
+
+/**
+ * @brief  清除显示（四位全部熄灭）
+ */
+void Display_Clear(void)
+{
+    unsigned char i;
+
+    for (i = 0; i < DISPLAY_DIGITS; i++) {
+        displayBuffer[i] = 0xFF;
+    }
+    Display_Refresh();
 }
 
 /**
- * @brief  显示两位数字（7SEG-MPX2-CA动态扫描） - 单次刷新版本
- * @param  nsTime: 南北方向剩余时间 (0-9)
- * @param  ewTime: 东西方向剩余时间 (0-9)
- * @note   使用7SEG-MPX2-CA（2位共阳极数码管）
- *         数码管1(COM1): 显示 nsTime（南北方向）
- *         数码管2(COM2): 显示 ewTime（东西方向）
- *         COM=高电平导通，段码已取反
- *         
- *         【重要】此函数仅执行一次快速扫描，需要外部循环调用
- *         推荐调用频率：100Hz以上（每秒100次）
+ * @brief  更新四位数字的帧缓冲（非阻塞）
+ * @param  nsTime: 南北方向剩余时间 (0-99)
+ * @param  ewTime: 东西方向剩余时间 (0-99)
+ * @note   转成BCD后与 Display_ShowBcd() 相同；实际扫描由 Display_Scan()
+ *         在Timer0中断中完成
  */
 void Display_ShowTime(unsigned char nsTime, unsigned char ewTime)
 {
-    unsigned int i, j;
-    
-    // 限制输入范围 (0-9)
-    if (nsTime > 9) nsTime = 9;
-    if (ewTime > 9) ewTime = 9;
-    
-    // ========== 显示第1位：南北方向时间 ==========
-    // 7SEG-MPX2-CA: COM1=高电平导通，COM2=低电平关闭
-    DISPLAY_DATA_PORT = 0xFF;       // 【关键】先消隐（共阳极用0xFF）
-    DISPLAY_COM1 = 1;               // COM1高电平，第1位导通
-    DISPLAY_COM2 = 0;               // COM2低电平，第2位关闭
-    
-    DISPLAY_DATA_PORT = segmentTable[nsTime];  // 送入段码
-    
-    // 保持时间：两位必须相同，约1-2ms
-    for(i=0; i<30; i++)
-        for(j=0; j<20; j++);
-
-    // ========== 显示第2位：东西方向时间 ==========
-    // 7SEG-MPX2-CA: COM1=低电平关闭，COM2=高电平导通
-    DISPLAY_DATA_PORT = 0xFF;       // 【关键】先消隐（共阳极用0xFF）
-    DISPLAY_COM1 = 0;               // COM1低电平，第1位关闭
-    DISPLAY_COM2 = 1;               // COM2高电平，第2位导通
-    
-    DISPLAY_DATA_PORT = segmentTable[ewTime];  // 送入段码
-    
-    // 保持时间：与第1位相同
-    for(i=0; i<30; i++)
-        for(j=0; j<20; j++);
+    Display_ShowBcd(Display_ToBcd(nsTime), Display_ToBcd(ewTime));
 }
 
 /**
- * @brief  持续显示1秒钟（高速刷新版本）
- * @param  nsTime: 南北方向剩余时间 (0-9)
- * @param  ewTime: 东西方向剩余时间 (0-9)
- * @note   此函数会持续刷新显示1秒钟，期间不会闪烁
- *         刷新频率：约200次/秒（每次刷新耗时约5ms）
- *         
- *         【调用方式】
- *         方式1：在主循环中每秒调用一次（阻塞式）
- *         方式2：在定时器中断中周期性调用 Display_ShowTime()（非阻塞）
+ * @brief  以压缩BCD更新四位帧缓冲（非阻塞）
+ * @param  nsBcd: 南北方向倒计时（压缩BCD）
+ * @param  ewBcd: 东西方向倒计时（压缩BCD）
+ * @note   每个半字节直接查段码表，十位为0时同样显示0（00-99），随后重建扫描时隙表；
+ *         半字节 0xA-0xF 显示颜色字母或空白（DISPLAY_BCD_*）
  */
-void Display_ShowTime_1s(unsigned char nsTime, unsigned char ewTime)
+void Display_ShowBcd(unsigned char nsBcd, unsigned char ewBcd)
+{
+    displayBuffer[0] = segmentTable[nsBcd >> 4];
+    displayBuffer[1] = segmentTable[nsBcd & 0x0F];
+    displayBuffer[2] = segmentTable[ewBcd >> 4];
+    displayBuffer[3] = segmentTable[ewBcd & 0x0F];
+    Display_Refresh();
+}
+
+/**
+ * @brief  二进制转压缩BCD
+ * @param  value: 0-99，超过按99处理
+ * @retval 压缩BCD（高半字节十位，低半字节个位）
+ * @note   用减10循环代替 /10 和 %10（8051上二者都是库函数调用）
+ */
+unsigned char Display_ToBcd(unsigned char value)
 {
-    unsigned int refresh_count;
-    
-    // 1秒 = 200次刷新 × 5ms/次
-    for(refresh_count = 0; refresh_count < 200; refresh_count++)
-    {
-        Display_ShowTime(nsTime, ewTime);
+    unsigned char bcd = 0;
+
+    if (value > 99) value = 99;
+    while (value >= 10) {
+        value -= 10;
+        bcd += 0x10;
     }
+    return bcd | value;
 }
 
+/**
+ * @brief  数码管扫描一步（4位经74HC139译码动态扫描，每次只点亮一位）
+ * @note   由Timer0中断每个节拍调用一次，四位轮流点亮，
+ *         常亮时每位占空比1/4、刷新率 DISPLAY_REFRESH_HZ（2ms节拍时125Hz）
+ *         按格雷码顺序 0→1→3→2 扫描：奇数时隙翻转A、偶数时隙翻转B，每步只改一根译码输入。
+ *         段码直接取自预先展开的时隙表，亮度和闪烁不增加任何判断；
+ *         消隐 → 切换位选 → 送段码，两条分支耗时相同，每位点亮时间都恰好是一个节拍
+ */
+void Display_Scan(void)
+{
+    DISPLAY_DATA_PORT = 0xFF;       // 【关键】先消隐（共阳极用0xFF）
+
+    scanSlot = (scanSlot + 1) & (DISPLAY_SLOTS - 1);
+    if (scanSlot & 1) {
+        DISPLAY_SEL_A = !DISPLAY_SEL_A;     // 0→1、3→2
+    } else {
+        DISPLAY_SEL_B = !DISPLAY_SEL_B;     // 1→3、2→0
+    }
+
+    DISPLAY_DATA_PORT = displaySlots[scanSlot];     // 送入段码
+}
+
+/**
+ * @brief  显示并保持1秒钟
+ * @param  nsTime: 南北方向剩余时间 (0-99)
+ * @param  ewTime: 东西方向剩余时间 (0-99)
+ * @note   写入帧缓冲后延时1秒，期间由Timer0中断负责刷新
+ *         必须在 Timer0_Init() 之后调用，否则数码管不会被扫描
+ */
+void Display_ShowTime_1s(unsigned char nsTime, unsigned char ewTime)
+{
+    Display_ShowTime(nsTime, ewTime);
+    Delay_ms(1000);
+}
@@ -30,6 +30,12 @@ typedef enum {
   DISPLAY_POS_SET_RIGHT = 5 // 设置显示右侧
 } DisplayPos_t;
 
+// 压缩BCD中的非数字半字节（Display_ShowBcd()）：设置模式指示正在设置的颜色
+#define DISPLAY_BCD_R      0x0A    // r（红灯）
+#define DISPLAY_BCD_Y      0x0B    // y（黄灯）
+#define DISPLAY_BCD_G      0x0C    // G（绿灯）
+#define DISPLAY_BCD_BLANK  0x0F    // 不亮
+
 /*-----------------------全局变量声明-------------------------*/
 extern DisplayMode_t displayMode;
 extern unsigned char displayBrightness;
@@ -44,21 +50,42 @@ extern unsigned char displayBrightness;
 void Display_Init(void);
 
 /**
- * @brief  显示倒计时（单次快速刷新）
- * @param  nsTime: 南北方向剩余时间
- * @param  ewTime: 东西方向剩余时间
- * @retval 无
- * @note   此函数执行一次快速扫描（约5ms），需要外部循环调用
+ * @brief  显示倒计时（更新帧缓冲）
+ * @param  nsTime: 南北方向剩余时间（0-99，超过按99显示）
+ * @param  ewTime: 东西方向剩余时间（0-99，超过按99显示）
+ * @note   非阻塞，只写帧缓冲；数码管由 Display_Scan() 在中断中刷新
  */
 void Display_ShowTime(unsigned char nsTime, unsigned char ewTime);
 
 /**
- * @brief  持续显示1秒钟（高速刷新，无闪烁）
+ * @brief  以压缩BCD更新四位帧缓冲（非阻塞，按半字节查段码表，无除法）
+ * @param  nsBcd: 南北方向倒计时（压缩BCD 0x00-0x99，半字节也可以是 DISPLAY_BCD_*）
+ * @param  ewBcd: 东西方向倒计时（同上）
+ * @retval 无
+ */
+void Display_ShowBcd(unsigned char nsBcd, unsigned char ewBcd);
+
+/**
+ * @brief  二进制转压缩BCD（减10循环，最多9次，无除法）
+ * @param  value: 0-99，超过按99处理
+ * @retval 压缩BCD
+ */
+unsigned char Display_ToBcd(unsigned char value);
+
+/**
+ * @brief  数码管扫描一步（每次调用只点亮一位）
+ * @param  无
+ * @retval 无
+ * @note   在Timer0中断中每个节拍调用一次，执行时间固定、无等待循环；
+ *         DISPLAY_DIGITS 位轮流点亮，每位刷新率 DISPLAY_REFRESH_HZ
+ */
+void Display_Scan(void);
+
+/**
+ * @brief  显示并保持1秒钟
  * @param  nsTime: 南北方向剩余时间
  * @param  ewTime: 东西方向剩余时间
- * @retval 无
- * @note   此函数会阻塞执行1秒，期间连续刷新显示200次
- *         适合在主循环中每秒调用一次
+ * @note   此函数会阻塞1秒（Delay_ms），显示刷新由Timer0中断完成
  */
 void Display_ShowTime_1s(unsigned char nsTime, unsigned char ewTime);
 
@@ -89,15 +116,17 @@ void Display_SetMode(DisplayMode_t mode);
 
 /**
  * @brief  设置显示亮度
- * @param  brightness: 亮度值（0-7）
+ * @param  brightness: 亮度值（0-7），7=常亮，每降一级少点亮八分之一的扫描轮次
  * @retval 无
+ * @note   亮度展开在扫描时隙表中，中断扫描的开销与亮度无关
  */
 void Display_SetBrightness(unsigned char brightness);
 
 /**
- * @brief  数码管显示刷新（定时调用）
+ * @brief  重建扫描时隙表（帧缓冲 × 亮度 × 闪烁）
  * @param  无
  * @retval 无
+ * @note   只在主循环中调用；显示内容、亮度、闪烁变化的函数内部已自动调用
  */
 void Display_Refresh(void);
 
@@ -118,12 +147,20 @@ void Display_ShowDigit(DisplayPos_t pos, unsigned char num);
 
 /**
  * @brief  显示闪烁效果
- * @param  pos: 显示位置
+ * @param  pos: 显示位置（DISPLAY_POS_NS_LEFT..DISPLAY_POS_EW_RIGHT）
  * @param  enable: 是否启用闪烁
  * @retval 无
  */
 void Display_Blink(DisplayPos_t pos, unsigned char enable);
 
+/**
+ * @brief  切换闪烁的亮/灭半秒
+ * @param  on: 1=亮（秒边界） 0=灭（半秒边界）
+ * @retval 无
+ * @note   主循环收到 EVT_SECOND/EVT_PHASE 时传1，收到 EVT_HALF_SECOND 时传0
+ */
+void Display_BlinkPhase(unsigned char on);
+
 /**
  * @brief  显示状态指示
  * @param  direction: 方向
@@ -0,0 +1,286 @@
+/**************************************************
+ * 文件名:    eeprom.c
+ * 作者:
+ * 日期:      2025-10-17
+ * 描述:      配时存储模块实现（STC89 IAP/EEPROM）
+ *           写入位置：上电扫描时记下最新记录所在扇区的第一个空白位置，之后每次保存加1；
+ *                     扇区写满后换到下一个扇区，擦除计数在各扇区之间轮流增加
+ *           掉电安全：只在空白位置编程，编程后读回校验，不符时换下一个位置重写；
+ *                     只擦除不含最新记录的扇区，任何时刻掉电都至少保留上一条完整记录
+ *           紧急优先：IAP 操作期间CPU暂停、不响应中断。擦除要十几毫秒，只在紧急请求中断被屏蔽时进行
+ *                     （上电时、设置模式、闪光运行）；响应紧急请求时只做字节读/编程，
+ *                     请求最多被一次字节编程推迟（EEPROM_STALL_CYCLES，计入 config.h 的响应上限）
+ **************************************************/
+
+#include "eeprom.h"
+#include "traffic_light.h"
+#include "uart.h"
+
+#if EEPROM_ENABLE
+
+#if EEPROM_SECTORS < 2 || EEPROM_SECTORS > 8
+#error "EEPROM_SECTORS 须为2-8"
+#endif
+
+#define EE_SECTOR_ADDR(s) (EEPROM_BASE + (unsigned int)(s) * EEPROM_SECTOR_SIZE)
+
+/*-----------------------全局变量定义-------------------------*/
+static unsigned char eeSector;      // 正在追加记录的扇区
+static unsigned char eeSlot;        // 该扇区下一条记录的位置（EE_SLOTS=已写满）
+static unsigned int eeSeq;          // 最新记录的序号
+static unsigned char eeGreen;       // 最新记录的配时（与当前配时相同时不再保存）
+static unsigned char eeYellow;
+static unsigned char eeBlank;       // 已知空白的扇区（位掩码：上电扫描得出，擦除置位、编程清除）
+unsigned char eepromFails = 0;
+
+/**
+ * @brief  执行一次 IAP 操作（读/编程/擦除）
+ * @retval IAP_DATA（读操作的结果）
+ * @note   触发序列写入后CPU暂停到操作完成；随后关闭 IAP，防止程序跑飞时误触发
+ */
+static unsigned char Iap_Op(unsigned char cmd, unsigned int addr)
+{
+    IAP_CONTR = IAP_EN | IAP_WAIT;
+    IAP_CMD = cmd;
+    IAP_ADDRH = addr >> 8;
+    IAP_ADDRL = addr;
+    IAP_TRIG = 0x46;
+    IAP_TRIG = 0xB9;
+    _nop_();
+    IAP_CONTR = 0;
+    IAP_CMD = 0;
+    IAP_TRIG = 0;
+    return IAP_DATA;
+}
+
+/**
+ * @brief  读出 n 个字节
+ * @retval 各字节按位与（0xFF 表示全部空白）
+ */
+static unsigned char Eeprom_Read(unsigned int addr, unsigned char *buf, unsigned char n)
+{
+    unsigned char all = 0xFF;
+
+    while (n--) {
+        *buf = Iap_Op(IAP_CMD_READ, addr++);
+        all &= *buf++;
+    }
+    return all;
+}
+
+/**
+ * @brief  比较 addr 起的一条记录
+ * @param  rec: 期望内容，为0时检查是否空白
+ */
+static unsigned char Eeprom_Same(unsigned int addr, const unsigned char *rec)
+{
+    unsigned char i;
+
+    for (i = 0; i < EE_REC_SIZE; i++) {
+        if (Iap_Op(IAP_CMD_READ, addr + i) != (rec ? rec[i] : 0xFF)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief  计算记录的CRC（[0]..[6]）
+ */
+static unsigned char Eeprom_Crc(const unsigned char *rec)
+{
+    unsigned char crc = 0;
+    unsigned char i;
+
+    for (i = 0; i < EE_REC_CRC; i++) {
+        UART_CRC8(crc, rec[i]);
+    }
+    return crc;
+}
+
+/**
+ * @brief  擦除扇区
+ * @note   擦除期间CPU暂停十几毫秒，同时停住Timer0计数：节拍整体推迟，
+ *         恢复后第一次中断的延迟仍小于一个节拍，重装值照常补偿（不会溢出后按错误的计数重装）
+ */
+static void Eeprom_Erase(unsigned char s)
+{
+    bit tr = TR0;
+
+    TR0 = 0;
+    Iap_Op(IAP_CMD_ERASE, EE_SECTOR_ADDR(s));
+    TR0 = tr;
+    eeBlank |= 1 << s;
+}
+
+/**
+ * @brief  下一个扇区号（轮流使用）
+ */
+static unsigned char Eeprom_Next(unsigned char s)
+{
+    return (s + 1 == EEPROM_SECTORS) ? 0 : s + 1;
+}
+
+/**
+ * @brief  是否允许擦除：紧急请求中断（INT0/INT1）都被屏蔽，十几毫秒的暂停不影响紧急响应上限
+ */
+static unsigned char Eeprom_MayErase(void)
+{
+    return !EX0 && !EX1;
+}
+
+/**
+ * @brief  预先擦除下一个扇区（不空白时）
+ */
+static void Eeprom_Prepare(void)
+{
+    unsigned char s = Eeprom_Next(eeSector);
+
+    if (!(eeBlank & (1 << s))) {
+        Eeprom_Erase(s);
+    }
+}
+
+/**
+ * @brief  不擦除能否再写一条记录
+ */
+static unsigned char Eeprom_Room(void)
+{
+    return eeSlot < EE_SLOTS || (eeBlank & (1 << Eeprom_Next(eeSector)));
+}
+
+/**
+ * @brief  恢复最新保存的配时（上电时调用）
+ */
+unsigned char Eeprom_LoadPlan(void)
+{
+    unsigned char rec[EE_REC_SIZE];
+    unsigned int addr;
+    unsigned int seq;
+    unsigned char found = 0;
+    unsigned char s;
+    unsigned char n;
+
+    eeBlank = 0;
+    eeSector = EEPROM_SECTORS - 1;  // 没有有效记录时，第一次保存换到扇区0
+    eeSlot = EE_SLOTS;
+    eeSeq = 0;
+    eeGreen = 0;                    // 不是有效配时：第一次保存一定写入
+    eeYellow = 0;
+
+    for (s = 0; s < EEPROM_SECTORS; s++) {
+        addr = EE_SECTOR_ADDR(s);
+        for (n = 0; n < EE_SLOTS; n++, addr += EE_REC_SIZE) {
+            if (Eeprom_Read(addr, rec, 3) == 0xFF) {
+                if (Eeprom_Read(addr + 3, rec + 3, EE_REC_SIZE - 3) == 0xFF) {
+                    break;          // 空白：扇区内按顺序追加，之后都没有写过
+                }
+                continue;           // 编程到一半掉电的残留
+            }
+            if (rec[EE_REC_TAG] != EE_TAG) {
+                continue;
+            }
+            seq = ((unsigned int)rec[EE_REC_SEQH] << 8) | rec[EE_REC_SEQL];
+            if (found && (short)(seq - eeSeq) <= 0) {
+                continue;           // 不比已找到的新：不读其余字节
+            }
+            Eeprom_Read(addr + 3, rec + 3, EE_REC_SIZE - 3);
+            if (Eeprom_Crc(rec) != rec[EE_REC_CRC] ||
+                rec[EE_REC_GREEN] < MIN_LIGHT_TIME || rec[EE_REC_GREEN] > MAX_LIGHT_TIME ||
+                rec[EE_REC_YELLOW] < MIN_LIGHT_TIME || rec[EE_REC_YELLOW] > MAX_LIGHT_TIME) {
+                continue;
+            }
+            found = 1;
+            eeSeq = seq;
+            eeSector = s;
+            eeGreen = rec[EE_REC_GREEN];
+            eeYellow = rec[EE_REC_YELLOW];
+        }
+        // 第一条就空白且最后一条也空白才算整个扇区空白（擦除到一半掉电时后面可能还有旧内容）
+        if (n == 0 && Eeprom_Same(EE_SECTOR_ADDR(s + 1) - EE_REC_SIZE, 0)) {
+            eeBlank |= 1 << s;
+        }
+        if (found && eeSector == s) {
+            eeSlot = n;             // 最新记录所在扇区的第一个空白位置
+        }
+    }
+
+    if (found) {
+        g_time_green = eeGreen;
+        g_time_yellow = eeYellow;
+        g_time_red = eeGreen + eeYellow;
+    }
+
+    // 预先擦除下一个扇区：其中只有比恢复的记录更旧的记录；Timer0尚未启动
+    Eeprom_Prepare();
+    return found;
+}
+
+/**
+ * @brief  能否保存指定配时（主循环上下文）
+ */
+unsigned char Eeprom_CanSave(unsigned char green, unsigned char yellow)
+{
+    return (green == eeGreen && yellow == eeYellow) || Eeprom_Room() || Eeprom_MayErase();
+}
+
+/**
+ * @brief  保存当前配时（主循环上下文）
+ */
+unsigned char Eeprom_SavePlan(void)
+{
+    unsigned char rec[EE_REC_SIZE];
+    unsigned int addr;
+    unsigned char tries;
+    unsigned char i;
+
+    if (g_time_green == eeGreen && g_time_yellow == eeYellow) {
+        return 1;
+    }
+
+    rec[EE_REC_TAG] = EE_TAG;
+    rec[EE_REC_SEQH] = (eeSeq + 1) >> 8;
+    rec[EE_REC_SEQL] = eeSeq + 1;
+    rec[EE_REC_GREEN] = g_time_green;
+    rec[EE_REC_YELLOW] = g_time_yellow;
+    rec[5] = 0xFF;
+    rec[6] = 0xFF;
+    rec[EE_REC_CRC] = Eeprom_Crc(rec);
+
+    for (tries = 0; tries < EE_SAVE_TRIES; tries++) {
+        if (eeSlot >= EE_SLOTS) {
+            if (!Eeprom_Room() && !Eeprom_MayErase()) {
+                break;                      // 备用扇区已用完：响应紧急请求期间不擦除
+            }
+            Eeprom_Prepare();
+            eeSector = Eeprom_Next(eeSector);
+            eeSlot = 0;
+        }
+        addr = EE_SECTOR_ADDR(eeSector) + (unsigned int)eeSlot * EE_REC_SIZE;
+        eeSlot++;
+        // 位置不空白（擦除到一半掉电的残留）时不编程，换下一个位置
+        if (!Eeprom_Same(addr, 0)) {
+            continue;
+        }
+        eeBlank &= ~(1 << eeSector);
+        for (i = 0; i < EE_REC_SIZE; i++) {
+            if (rec[i] != 0xFF) {
+                IAP_DATA = rec[i];
+                Iap_Op(IAP_CMD_PROGRAM, addr + i);
+            }
+        }
+        if (Eeprom_Same(addr, rec)) {
+            eeSeq++;
+            eeGreen = g_time_green;
+            eeYellow = g_time_yellow;
+            if (Eeprom_MayErase()) {
+                Eeprom_Prepare();           // 补足备用扇区，之后响应紧急请求时换扇区不必擦除
+            }
+            return 1;
+        }
+    }
+    eepromFails++;              // 配时仍在RAM中生效，下次保存再写
+    return 0;
+}
+
+#endif /* EEPROM_ENABLE */
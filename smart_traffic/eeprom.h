@@ -0,0 +1,75 @@
+/**************************************************
+ * 文件名:    eeprom.h
+ * 作者:
+ * 日期:      2025-10-17
+ * 描述:      配时存储模块头文件（STC89 IAP/EEPROM）
+ *           按键或远程命令修改的绿灯/黄灯时间写入片内 EEPROM，掉电后保留。
+ *           日志结构：每次保存在当前扇区末尾追加一条记录，不改写旧记录；
+ *           扇区写满后换到下一个扇区（事先擦除），EEPROM_SECTORS 个扇区轮流擦除。
+ *           上电从第一个扇区起顺序扫描一遍，取序号最新且CRC正确的记录。
+ *           擦除只在紧急请求中断被屏蔽时进行（上电、设置模式、闪光运行），此时把下一个扇区预先擦好；
+ *           正常运行中（远程命令）最多写完当前扇区和这个备用扇区，再保存须等设置模式或重新上电
+ *
+ *           记录格式（EE_REC_SIZE 字节，扇区内从0开始依次排列）：
+ *             [0] 标记 EE_TAG | [1] 序号高 | [2] 序号低 | [3] 绿灯秒 | [4] 黄灯秒 |
+ *             [5][6] 预留（0xFF，不编程） | [7] CRC-8（[0]..[6]，与串口帧相同的多项式）
+ *           全部为0xFF的位置是空白；写到一半掉电的记录CRC不符，扫描时跳过，
+ *           下一次保存写在它之后（闪存只能擦除后再写，不回头改写）
+ **************************************************/
+
+#ifndef __EEPROM_H__
+#define __EEPROM_H__
+
+#include "config.h"
+
+/*-----------------------记录格式-----------------------------*/
+#define EE_REC_SIZE    8
+#define EE_REC_TAG     0
+#define EE_REC_SEQH    1
+#define EE_REC_SEQL    2
+#define EE_REC_GREEN   3
+#define EE_REC_YELLOW  4
+#define EE_REC_CRC     7
+#define EE_TAG         0x5A
+#define EE_SLOTS       (EEPROM_SECTOR_SIZE / EE_REC_SIZE)   // 每扇区记录数
+#define EE_SAVE_TRIES  3         // 一次保存最多尝试的位置数
+
+/*-----------------------函数声明-----------------------------*/
+
+/**
+ * @brief  恢复最新保存的配时（上电时、Timer0启动之前调用）
+ * @param  无
+ * @retval 1=已恢复到 g_time_green/g_time_yellow/g_time_red，0=没有有效记录（保持默认配时）
+ * @note   单次顺序扫描全部扇区：空白位置结束本扇区，序号不比已找到的新的记录只读3个字节；
+ *         同时记下下一条记录的写入位置。下一个要用的扇区不空白时在这里预先擦除
+ */
+unsigned char Eeprom_LoadPlan(void);
+
+/**
+ * @brief  能否保存指定配时（只能在主循环中调用）
+ * @param  green:  绿灯时间
+ * @param  yellow: 黄灯时间
+ * @retval 1=与最新记录相同，或不擦除就有空白位置，或当前允许擦除；0=保存会被拒绝
+ * @note   远程命令据此在修改配时前回复忙，不留下保存不了的配时
+ */
+unsigned char Eeprom_CanSave(unsigned char green, unsigned char yellow);
+
+/**
+ * @brief  保存当前配时（只能在主循环中调用）
+ * @param  无
+ * @retval 1=已保存或与最新记录相同，0=没有保存（计入 eepromFails）
+ * @note   与最新记录相同时不写；否则追加一条记录（8字节逐字节编程并读回校验，
+ *         CPU在每字节编程期间暂停，两字节之间照常响应中断）。
+ *         紧急请求中断被屏蔽时（设置模式）换扇区或写完后把下一个扇区预先擦除，
+ *         擦除期间CPU暂停十几毫秒，为此暂停Timer0计数（节拍整体推迟，不会因溢出后补算重装值而错乱）；
+ *         紧急请求中断允许时从不擦除，备用扇区用完后返回0
+ */
+unsigned char Eeprom_SavePlan(void);
+
+/**
+ * @brief  放弃的保存次数（连续 EE_SAVE_TRIES 个位置都不空白或编程后读回不符、
+ *         或备用扇区用完而不允许擦除，8位回绕）
+ */
+extern unsigned char eepromFails;
+
+#endif /* __EEPROM_H__ */
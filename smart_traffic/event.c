@@ -0,0 +1,49 @@
+/**************************************************
+ * 文件名:    event.c
+ * 作者:
+ * 日期:      2025-10-11
+ * 描述:      中断→主循环事件队列实现
+ *           无锁原理：eventHead 只由中断写，eventTail 只由主循环写，
+ *           8051上单字节读写是原子的；生产者先写数据再推进 eventHead，
+ *           消费者先读数据再推进 eventTail，任何时刻打断都不会读到半个事件
+ **************************************************/
+
+#include "event.h"
+
+/*-----------------------全局变量定义-------------------------*/
+static unsigned char idata eventQueue[EVENT_QUEUE_SIZE]; // 事件缓冲区（间接寻址区）
+static volatile unsigned char eventHead = 0;             // 写位置（中断独占）
+static volatile unsigned char eventTail = 0;             // 读位置（主循环独占）
+volatile unsigned char eventOverflow = 0;                // 队列满丢弃的事件数
+
+/**
+ * @brief  投递事件（中断上下文）
+ * @param  evt: 事件代码
+ */
+void Event_Post(unsigned char evt)
+{
+    unsigned char next = (eventHead + 1) & EVENT_QUEUE_MASK;
+
+    if (next == eventTail) {
+        eventOverflow++;        // 队列满：主循环已积压8个事件，丢弃
+        return;
+    }
+    eventQueue[eventHead] = evt;
+    eventHead = next;           // 最后推进写位置，事件对主循环可见
+}
+
+/**
+ * @brief  取出一个事件（主循环上下文）
+ * @retval 事件代码，无事件返回 EVT_NONE
+ */
+unsigned char Event_Get(void)
+{
+    unsigned char evt;
+
+    if (eventTail == eventHead) {
+        return EVT_NONE;
+    }
+    evt = eventQueue[eventTail];
+    eventTail = (eventTail + 1) & EVENT_QUEUE_MASK;  // 读完再释放该位置
+    return evt;
+}
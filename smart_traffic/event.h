@@ -0,0 +1,48 @@
+/**************************************************
+ * 文件名:    event.h
+ * 作者:
+ * 日期:      2025-10-11
+ * 描述:      中断→主循环事件队列头文件
+ *           单生产者（Timer0中断，含按键采样）/单消费者（主循环）环形队列，
+ *           存放在 idata 中，双方都不需要关中断
+ **************************************************/
+
+#ifndef __EVENT_H__
+#define __EVENT_H__
+
+#include "config.h"
+
+/*-----------------------事件定义-----------------------------*/
+#define EVT_NONE    0   // 队列为空
+#define EVT_SECOND  1   // 经过1秒（正常运行时倒计时已递减）
+#define EVT_PHASE   2   // 交通灯状态切换（同时也是秒边界）
+#define EVT_HALF_SECOND 3  // 半秒边界（用于显示闪烁）
+#define EVT_KEY_UP   4  // 增加键按下或长按自动重复（按键事件必须排在最后）
+#define EVT_KEY_DOWN 5  // 减少键按下或长按自动重复
+#define EVT_KEY_SET  6  // 模式设置键按下
+
+// 队列长度（必须是2的幂）
+#define EVENT_QUEUE_SIZE 8
+#define EVENT_QUEUE_MASK (EVENT_QUEUE_SIZE - 1)
+
+/*-----------------------函数声明-----------------------------*/
+
+/**
+ * @brief  投递事件（只能在中断中调用，单生产者）
+ * @param  evt: 事件代码
+ * @retval 无
+ * @note   队列满时丢弃事件并累加 eventOverflow
+ */
+void Event_Post(unsigned char evt);
+
+/**
+ * @brief  取出一个事件（只能在主循环中调用，单消费者）
+ * @param  无
+ * @retval 事件代码，队列为空时返回 EVT_NONE
+ */
+unsigned char Event_Get(void);
+
+/*-----------------------外部变量声明-------------------------*/
+extern volatile unsigned char eventOverflow; // 队列满丢弃的事件数
+
+#endif /* __EVENT_H__ */
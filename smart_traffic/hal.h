@@ -0,0 +1,63 @@
+/**************************************************
+ * 文件名:    hal.h
+ * 作者:
+ * 日期:      2025-10-09
+ * 描述:      硬件抽象层 - 编译器/目标平台切换
+ *           Keil C51：直接使用 <reg52.h> 和 <intrins.h>
+ *           SDCC（周期基准测试，见 bench/）：<8052.h>，C51关键字映射为 __code 等
+ *           主机仿真（定义 HOST_SIM）：SFR/sbit 映射到普通内存，
+ *           固件源码无需修改即可在 Linux 上编译运行（见 host/）
+ *
+ *           引脚/附加SFR统一用 HAL_SBIT(名称, 端口, 位) / HAL_SFR(名称, 地址) 定义，
+ *           以便同一份 config.h 在三种编译器下通用；
+ *           固定地址的 idata 变量用 HAL_IDATA_AT(类型, 名称, 地址)（主机上为普通变量）
+ **************************************************/
+
+#ifndef __HAL_H__
+#define __HAL_H__
+
+#ifdef HOST_SIM
+
+#include "host/hal_host.h"
+
+#define HAL_SBIT(name, port, bitNo) static const hal_sbit name = port ^ bitNo
+#define HAL_SFR(name, addr)         static const hal_sfr name = addr
+#define HAL_IDATA_AT(type, name, addr) type name
+
+#elif defined(__SDCC)
+
+#include <8052.h>
+
+// SDCC 的 sbit 需要绝对位地址：端口名 → SFR地址
+#define HAL_ADDR_P0 0x80
+#define HAL_ADDR_P1 0x90
+#define HAL_ADDR_P2 0xA0
+#define HAL_ADDR_P3 0xB0
+
+#define HAL_SBIT(name, port, bitNo) __sbit __at(HAL_ADDR_##port + bitNo) name
+#define HAL_SFR(name, addr)         __sfr __at(addr) name
+#define HAL_IDATA_AT(type, name, addr) __idata __at(addr) type name
+#define HAL_ISR(vector)             __interrupt(vector)
+
+#define code      __code
+#define idata     __idata
+#define bdata     __data
+#define xdata     __xdata
+#define bit       __bit
+#define _nop_()   __asm nop __endasm
+
+#else  /* Keil C51 */
+
+#include <reg52.h>
+#include <intrins.h>   // _nop_()
+
+#define HAL_SBIT(name, port, bitNo) sbit name = port ^ bitNo
+#define HAL_SFR(name, addr)         sfr name = addr
+#define HAL_IDATA_AT(type, name, addr) type idata name _at_ addr
+
+// 中断服务函数声明：void Xxx_ISR(void) HAL_ISR(1)
+#define HAL_ISR(vector) interrupt vector
+
+#endif /* HOST_SIM */
+
+#endif /* __HAL_H__ */
@@ -0,0 +1,41 @@
+/**************************************************
+ * 文件名:    hal_host.cpp
+ * 作者:
+ * 日期:      2025-10-09
+ * 描述:      主机仿真用硬件抽象层实现
+ **************************************************/
+
+#include <string.h>
+
+#include "hal_host.h"
+
+/*==============================================
+ *                全局变量
+ *==============================================*/
+unsigned char halSfrMem[128];
+HalWriteHook_t halWriteHook = 0;
+
+/**
+ * @brief  复位SFR为8051上电默认值（端口=0xFF，SP=0x07，其余为0）
+ */
+void Hal_Reset(void)
+{
+    memset(halSfrMem, 0, sizeof(halSfrMem));
+    halSfrMem[0x80 - 0x80] = 0xFF;  // P0
+    halSfrMem[0x90 - 0x80] = 0xFF;  // P1
+    halSfrMem[0xA0 - 0x80] = 0xFF;  // P2
+    halSfrMem[0xB0 - 0x80] = 0xFF;  // P3
+    halSfrMem[0x81 - 0x80] = 0x07;  // SP
+    halSfrMem[0x87 - 0x80] = 0x10;  // PCON：上电复位 POF=1（热复位由测试清0）
+}
+
+/**
+ * @brief  写SFR并通知写钩子
+ */
+void Hal_Write(unsigned char addr, unsigned char value)
+{
+    halSfrMem[addr - 0x80] = value;
+    if (halWriteHook) {
+        halWriteHook(addr, value);
+    }
+}
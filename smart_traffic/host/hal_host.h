@@ -0,0 +1,177 @@
+/**************************************************
+ * 文件名:    hal_host.h
+ * 作者:
+ * 日期:      2025-10-09
+ * 描述:      主机仿真用硬件抽象层（替代 <reg52.h>）
+ *           以 C++ 方式编译固件源码：
+ *           - 所有SFR映射到 halSfrMem[]（地址0x80-0xFF）
+ *           - sbit 为 (SFR地址, 位) 句柄，可读可写
+ *           - code/idata/bdata 等C51存储类型关键字展开为空
+ *           - interrupt 由 HAL_ISR() 展开为空，ISR变成普通函数
+ *           由仿真程序按节拍直接调用 Timer0_ISR() 等中断函数
+ **************************************************/
+
+#ifndef __HAL_HOST_H__
+#define __HAL_HOST_H__
+
+/*==============================================
+ *                SFR存储与写钩子
+ *==============================================*/
+// SFR空间：halSfrMem[addr - 0x80]
+extern unsigned char halSfrMem[128];
+
+// SFR写钩子：每次写SFR（含sbit写）后调用，用于记录端口波形、模拟串口发送等
+typedef void (*HalWriteHook_t)(unsigned char addr, unsigned char value);
+extern HalWriteHook_t halWriteHook;
+
+// 上电复位：SFR 回到复位值（端口0xFF、PCON.POF=1）
+void Hal_Reset(void);
+void Hal_Write(unsigned char addr, unsigned char value);
+
+class hal_sbit;
+
+/**
+ * @brief  SFR句柄：P0 = 0xFF; TMOD |= 0x01; x = TH0; 等写法与C51一致
+ * @note   P2 ^ 0 返回位句柄（仅用于 sbit 定义），不是按位异或
+ */
+class hal_sfr {
+public:
+    hal_sfr(unsigned char addr) : a(addr) {}
+
+    operator unsigned char() const { return halSfrMem[a - 0x80]; }
+
+    const hal_sfr &operator=(unsigned char v) const { Hal_Write(a, v); return *this; }
+    const hal_sfr &operator=(const hal_sfr &o) const { return *this = (unsigned char)o; }
+    const hal_sfr &operator&=(unsigned char v) const { return *this = (unsigned char)((unsigned char)*this & v); }
+    const hal_sfr &operator|=(unsigned char v) const { return *this = (unsigned char)((unsigned char)*this | v); }
+    const hal_sfr &operator^=(unsigned char v) const { return *this = (unsigned char)((unsigned char)*this ^ v); }
+    const hal_sfr &operator+=(unsigned char v) const { return *this = (unsigned char)((unsigned char)*this + v); }
+    const hal_sfr &operator-=(unsigned char v) const { return *this = (unsigned char)((unsigned char)*this - v); }
+
+    hal_sbit operator^(int bit) const;
+
+    unsigned char addr(void) const { return a; }
+
+private:
+    unsigned char a;
+};
+
+/**
+ * @brief  位句柄：NS_RED_PIN = 1; if (TF0) ...; PIN = !PIN; 等写法与C51一致
+ */
+class hal_sbit {
+public:
+    hal_sbit(unsigned char addr, unsigned char bit) : a(addr), m((unsigned char)(1u << bit)) {}
+
+    operator unsigned char() const { return (halSfrMem[a - 0x80] & m) ? 1 : 0; }
+
+    const hal_sbit &operator=(unsigned char v) const
+    {
+        unsigned char cur = halSfrMem[a - 0x80];
+        Hal_Write(a, v ? (unsigned char)(cur | m) : (unsigned char)(cur & ~m));
+        return *this;
+    }
+    const hal_sbit &operator=(const hal_sbit &o) const { return *this = (unsigned char)o; }
+
+private:
+    unsigned char a;
+    unsigned char m;
+};
+
+inline hal_sbit hal_sfr::operator^(int bit) const { return hal_sbit(a, (unsigned char)bit); }
+
+/*==============================================
+ *                C51关键字映射
+ *==============================================*/
+#define sfr       static const hal_sfr
+#define sbit      static const hal_sbit
+#define bit       unsigned char
+#define code
+#define idata
+#define bdata
+#define xdata
+#define pdata
+#define reentrant
+
+#define HAL_ISR(vector)
+
+inline void _nop_(void) {}
+
+/*==============================================
+ *                8052 SFR定义（与 reg52.h 相同的名称/地址）
+ *==============================================*/
+sfr P0     = 0x80;
+sfr SP     = 0x81;
+sfr DPL    = 0x82;
+sfr DPH    = 0x83;
+sfr PCON   = 0x87;
+sfr TCON   = 0x88;
+sfr TMOD   = 0x89;
+sfr TL0    = 0x8A;
+sfr TL1    = 0x8B;
+sfr TH0    = 0x8C;
+sfr TH1    = 0x8D;
+sfr P1     = 0x90;
+sfr SCON   = 0x98;
+sfr SBUF   = 0x99;
+sfr P2     = 0xA0;
+sfr IE     = 0xA8;
+sfr P3     = 0xB0;
+sfr IP     = 0xB8;
+sfr T2CON  = 0xC8;
+sfr RCAP2L = 0xCA;
+sfr RCAP2H = 0xCB;
+sfr TL2    = 0xCC;
+sfr TH2    = 0xCD;
+sfr PSW    = 0xD0;
+sfr ACC    = 0xE0;
+sfr B      = 0xF0;
+
+/* TCON */
+sbit IT0 = TCON ^ 0;
+sbit IE0 = TCON ^ 1;
+sbit IT1 = TCON ^ 2;
+sbit IE1 = TCON ^ 3;
+sbit TR0 = TCON ^ 4;
+sbit TF0 = TCON ^ 5;
+sbit TR1 = TCON ^ 6;
+sbit TF1 = TCON ^ 7;
+
+/* IE */
+sbit EX0 = IE ^ 0;
+sbit ET0 = IE ^ 1;
+sbit EX1 = IE ^ 2;
+sbit ET1 = IE ^ 3;
+sbit ES  = IE ^ 4;
+sbit ET2 = IE ^ 5;
+sbit EA  = IE ^ 7;
+
+/* IP */
+sbit PX0 = IP ^ 0;
+sbit PT0 = IP ^ 1;
+sbit PX1 = IP ^ 2;
+sbit PT1 = IP ^ 3;
+sbit PS  = IP ^ 4;
+sbit PT2 = IP ^ 5;
+
+/* SCON */
+sbit RI  = SCON ^ 0;
+sbit TI  = SCON ^ 1;
+sbit RB8 = SCON ^ 2;
+sbit TB8 = SCON ^ 3;
+sbit REN = SCON ^ 4;
+sbit SM2 = SCON ^ 5;
+sbit SM1 = SCON ^ 6;
+sbit SM0 = SCON ^ 7;
+
+/* T2CON */
+sbit CP_RL2 = T2CON ^ 0;
+sbit C_T2   = T2CON ^ 1;
+sbit TR2    = T2CON ^ 2;
+sbit EXEN2  = T2CON ^ 3;
+sbit TCLK   = T2CON ^ 4;
+sbit RCLK   = T2CON ^ 5;
+sbit EXF2   = T2CON ^ 6;
+sbit TF2    = T2CON ^ 7;
+
+#endif /* __HAL_HOST_H__ */
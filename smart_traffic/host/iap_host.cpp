@@ -0,0 +1,126 @@
+/**************************************************
+ * 文件名:    iap_host.cpp
+ * 作者:
+ * 日期:      2025-10-17
+ * 描述:      主机仿真用 STC89 IAP/EEPROM 模型实现
+ **************************************************/
+
+#include <string.h>
+
+#include "hal_host.h"
+#include "iap_host.h"
+
+#define IAP_SFR(addr) halSfrMem[(addr) - 0x80]
+
+/*==============================================
+ *                全局变量
+ *==============================================*/
+unsigned char iapHostMem[IAP_HOST_SIZE];
+unsigned long iapHostErases[IAP_HOST_SECTORS];
+unsigned long iapHostReads = 0;
+unsigned long iapHostPrograms = 0;
+unsigned long iapHostOverwrites = 0;
+unsigned long iapHostBadAddr = 0;
+unsigned char iapHostDown = 0;
+
+static unsigned char iapLastTrig = 0;   // 上一次写入 IAP_TRIG 的值
+static long iapFailAfter = -1;          // 距掉电还剩的编程/擦除次数（<0：不掉电）
+
+void IapHost_Init(void)
+{
+    memset(iapHostMem, 0xFF, sizeof(iapHostMem));
+    memset(iapHostErases, 0, sizeof(iapHostErases));
+    iapHostReads = 0;
+    iapHostPrograms = 0;
+    iapHostOverwrites = 0;
+    iapHostBadAddr = 0;
+    iapHostDown = 0;
+    iapLastTrig = 0;
+    iapFailAfter = -1;
+}
+
+void IapHost_FailAfter(long ops)
+{
+    iapFailAfter = ops;
+}
+
+void IapHost_PowerUp(void)
+{
+    iapHostDown = 0;
+    iapLastTrig = 0;
+    iapFailAfter = -1;
+}
+
+/**
+ * @brief  编程/擦除前检查掉电
+ * @retval 1=本次操作时掉电
+ */
+static int IapHost_Fail(void)
+{
+    if (iapFailAfter < 0) {
+        return 0;
+    }
+    if (iapFailAfter-- > 0) {
+        return 0;
+    }
+    iapHostDown = 1;
+    return 1;
+}
+
+/**
+ * @brief  执行 IAP_CMD 指定的操作
+ */
+static void IapHost_Execute(void)
+{
+    unsigned int addr = ((unsigned int)IAP_SFR(0xE3) << 8) | IAP_SFR(0xE4);
+    unsigned int off;
+    unsigned int base;
+
+    if (iapHostDown || !(IAP_SFR(0xE7) & 0x80)) {
+        return;
+    }
+    if (addr < IAP_HOST_BASE || addr >= IAP_HOST_BASE + IAP_HOST_SIZE) {
+        iapHostBadAddr++;
+        return;
+    }
+    off = addr - IAP_HOST_BASE;
+
+    switch (IAP_SFR(0xE5) & 0x03) {
+        case 1:     // 读：不经写钩子，直接放入 IAP_DATA
+            iapHostReads++;
+            IAP_SFR(0xE2) = iapHostMem[off];
+            break;
+        case 2:     // 编程
+            if (IapHost_Fail()) {
+                break;
+            }
+            iapHostPrograms++;
+            if (iapHostMem[off] != 0xFF) {
+                iapHostOverwrites++;
+            }
+            iapHostMem[off] &= IAP_SFR(0xE2);
+            break;
+        case 3:     // 擦除：地址所在的整个扇区
+            base = off - off % IAP_HOST_SECTOR;
+            if (IapHost_Fail()) {
+                memset(&iapHostMem[base], 0xFF, IAP_HOST_SECTOR / 2);
+                break;
+            }
+            iapHostErases[base / IAP_HOST_SECTOR]++;
+            memset(&iapHostMem[base], 0xFF, IAP_HOST_SECTOR);
+            break;
+        default:    // 待机
+            break;
+    }
+}
+
+void IapHost_Write(unsigned char addr, unsigned char value)
+{
+    if (addr != 0xE6) {
+        return;
+    }
+    if (iapLastTrig == 0x46 && value == 0xB9) {
+        IapHost_Execute();
+    }
+    iapLastTrig = value;
+}
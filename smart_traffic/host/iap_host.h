@@ -0,0 +1,50 @@
+/**************************************************
+ * 文件名:    iap_host.h
+ * 作者:
+ * 日期:      2025-10-17
+ * 描述:      主机仿真用 STC89 IAP/EEPROM 模型
+ *           IAP_TRIG 依次写入 0x46、0xB9 且 IAP_CONTR.7=1 时按 IAP_CMD 执行一次操作：
+ *           读（结果写入 IAP_DATA）、编程（闪存只能把1写成0：结果为原内容与数据按位与）、
+ *           擦除扇区（全部写成0xFF，按扇区计数）。
+ *           可设置在第 N 次编程/擦除时掉电：该次编程不生效、擦除只完成前半个扇区，
+ *           之后的操作全部无效，直到 IapHost_PowerUp()。闪存内容不随 Hal_Reset() 改变
+ *           仿真程序在 SFR 写钩子中转发 IapHost_Write()
+ **************************************************/
+
+#ifndef __IAP_HOST_H__
+#define __IAP_HOST_H__
+
+#define IAP_HOST_BASE    0x2000
+#define IAP_HOST_SECTOR  512
+#define IAP_HOST_SECTORS 8                                  // STC89C52RC：4KB
+#define IAP_HOST_SIZE    (IAP_HOST_SECTOR * IAP_HOST_SECTORS)
+
+/**
+ * @brief  出厂状态：全部擦除，计数清零，不掉电
+ */
+void IapHost_Init(void);
+
+/**
+ * @brief  SFR写钩子转发：写 IAP_TRIG 时检查触发序列并执行操作
+ */
+void IapHost_Write(unsigned char addr, unsigned char value);
+
+/**
+ * @brief  再执行 ops 次编程/擦除后掉电（ops=0：下一次编程/擦除就掉电），负数取消
+ */
+void IapHost_FailAfter(long ops);
+
+/**
+ * @brief  重新上电：此后的操作恢复有效（闪存内容保持）
+ */
+void IapHost_PowerUp(void);
+
+extern unsigned char iapHostMem[IAP_HOST_SIZE];
+extern unsigned long iapHostErases[IAP_HOST_SECTORS];  // 各扇区擦除次数
+extern unsigned long iapHostReads;          // 读字节数
+extern unsigned long iapHostPrograms;       // 编程字节数
+extern unsigned long iapHostOverwrites;     // 对不是0xFF的字节编程（会把原内容和新数据混在一起）
+extern unsigned long iapHostBadAddr;        // 地址不在 EEPROM 区内
+extern unsigned char iapHostDown;           // 1=已掉电
+
+#endif /* __IAP_HOST_H__ */
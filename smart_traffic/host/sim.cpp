@@ -0,0 +1,285 @@
+/**************************************************
+ * 文件名:    sim.cpp
+ * 作者:
+ * 日期:      2025-10-09
+ * 描述:      主机仿真程序 - 在Linux上运行未修改的固件
+ *           固件源码经 hal_host.h 映射后以C++编译，
+ *           本程序按Timer0节拍交替执行主循环(Main_Poll/Main_Idle)与Timer0_ISR，
+ *           固件写 PCON.IDL 进入空闲时，仿真直接推进到下一次Timer0溢出并执行中断，
+ *           仿真时间由Timer0节拍计数值和晶振频率(FOSC)换算，与主机速度无关
+ *
+ *           串口发送由 uart_host.cpp 按波特率计时，每个节拍末尾推进
+ *
+ *           用法: ./sim [-s 仿真秒数] [-p 每节拍主循环次数] [-t] [-u 文件]
+ *             -s  仿真时长（秒），默认86400（1天）
+ *             -p  每个Timer0节拍之间最多执行主循环的次数，默认4（进入空闲则提前结束本节拍）
+ *             -t  打印每次灯色变化
+ *             -u  把串口发出的字节（遥测帧）写入文件，可用 tlmdump 解码
+ **************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// 固件 main.c 直接包含进来，以便访问其中的 static 函数（Main_Poll / Keys_Scan 等）
+#define main firmware_main
+#include "../main.c"
+#undef main
+
+#include "uart_host.h"
+
+void Timer0_ISR(void);
+
+/*==============================================
+ *                仿真参数
+ *==============================================*/
+#define LAMP_NS_MOVING  (LAMP_NS_YELLOW | LAMP_NS_GREEN)
+#define LAMP_EW_MOVING  (LAMP_EW_YELLOW | LAMP_EW_GREEN)
+
+/*==============================================
+ *                统计数据
+ *==============================================*/
+static unsigned long conflictCount = 0;   // 冲突放行的次数
+static unsigned long countdownErrors = 0; // BCD倒计时与相位表计算值不一致的次数
+static unsigned long p2WriteCount = 0;
+static unsigned long idleCount = 0;       // 进入空闲模式的次数
+static int simTickDone = 0;               // 本节拍的Timer0中断已在空闲唤醒时执行
+static FILE *simUartFile = 0;             // -u：串口字节流输出
+
+static int Sim_Timer0Enabled(void);
+static void Sim_Timer0Overflow(void);
+
+/**
+ * @brief  判断灯输出（P2）与扩展灯（P0高4位）组合是否存在冲突放行：
+ *         南北、东西同时放行；左转箭头与对向直行同时放行；行人与任一车流同时放行
+ */
+static int Sim_IsConflict(unsigned char lamps, unsigned char aux)
+{
+    if ((lamps & LAMP_NS_MOVING) && (lamps & LAMP_EW_MOVING)) {
+        return 1;
+    }
+#if PHASE_PLAN == PHASE_PLAN_FULL
+    if ((aux & AUX_NS_LEFT) && (lamps & LAMP_EW_MOVING)) {
+        return 1;
+    }
+    if ((aux & AUX_EW_LEFT) && (lamps & LAMP_NS_MOVING)) {
+        return 1;
+    }
+    if ((aux & AUX_PED_WALK) &&
+        ((lamps & (LAMP_NS_MOVING | LAMP_EW_MOVING)) || (aux & (AUX_NS_LEFT | AUX_EW_LEFT)))) {
+        return 1;
+    }
+#else
+    (void)aux;
+#endif
+    return 0;
+}
+
+/**
+ * @brief  检查中断维护的BCD倒计时与按相位表直接计算的值一致（超过99显示99）
+ */
+static void Sim_CheckCountdown(void)
+{
+    unsigned char d;
+    for (d = 0; d < 2; d++) {
+        unsigned int v = Phase_Countdown(currentState, d, timeLeft);
+        if (v > 99) {
+            v = 99;
+        }
+        if (countdownBcd[d] != (((v / 10) << 4) | (v % 10))) {
+            countdownErrors++;
+        }
+    }
+}
+
+/**
+ * @brief  SFR写钩子：每次写P2/P0后检查当前灯组合是否冲突；
+ *         写 PCON.IDL 时CPU停止取指直到下一个中断：直接执行本节拍的Timer0溢出，
+ *         中断返回后固件从 PCON 写入之后继续（与硬件一致，IDL位由中断清除）
+ */
+static void Sim_WriteHook(unsigned char addr, unsigned char value)
+{
+    UartHost_Write(addr, value);
+    if (addr == 0x87 && (value & PCON_IDL)) {
+        halSfrMem[0x87 - 0x80] = (unsigned char)(value & ~PCON_IDL);
+        idleCount++;
+        if (Sim_Timer0Enabled() && !simTickDone) {
+            simTickDone = 1;
+            Sim_Timer0Overflow();
+        }
+        return;
+    }
+    if (addr != 0xA0 && addr != 0x80) {
+        return;
+    }
+    if (addr == 0xA0) {
+        p2WriteCount++;
+    }
+    (void)value;
+    if (Sim_IsConflict(P2, P0)) {
+        conflictCount++;
+    }
+}
+
+/**
+ * @brief  Timer0是否允许产生中断（TR0、ET0、EA均置位）
+ */
+static int Sim_Timer0Enabled(void)
+{
+    return TR0 && ET0 && EA;
+}
+
+/**
+ * @brief  一个节拍的实际时长（秒），与硬件相同：TIMER0_COUNTS 个计数
+ */
+static double Sim_TickSeconds(void)
+{
+    return (double)TIMEBASE_TICK_CLKS / (double)FOSC;
+}
+
+/**
+ * @brief  模拟Timer0溢出：计数器回到0后进入中断
+ */
+static void Sim_Timer0Overflow(void)
+{
+    TH0 = 0;
+    TL0 = 0;
+    Timer0_ISR();
+}
+
+/**
+ * @brief  串口线路另一端：写入 -u 指定的文件
+ */
+static void Sim_UartSink(unsigned char b)
+{
+    if (simUartFile) {
+        fputc(b, simUartFile);
+    }
+}
+
+static const char *Sim_LampName(unsigned char lamps)
+{
+    switch (lamps & LAMP_MASK) {
+        case 0x0C: return "NS绿 EW红";
+        case 0x0A: return "NS黄 EW红";
+        case 0x21: return "NS红 EW绿";
+        case 0x11: return "NS红 EW黄";
+        case 0x09: return "全红";
+        case 0x08: return "NS灭 EW红";    // 南北绿/黄闪烁的熄灭半秒
+        case 0x01: return "NS红 EW灭";
+        default:   return "异常";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    double simSeconds = 86400.0;
+    unsigned int pollsPerTick = 4;
+    int trace = 0;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            simSeconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            pollsPerTick = (unsigned int)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0) {
+            trace = 1;
+        } else if (strcmp(argv[i], "-u") == 0 && i + 1 < argc) {
+            simUartFile = fopen(argv[++i], "wb");
+            if (!simUartFile) {
+                perror(argv[i]);
+                return 2;
+            }
+        } else {
+            fprintf(stderr, "用法: %s [-s 仿真秒数] [-p 每节拍主循环次数] [-t] [-u 文件]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    Hal_Reset();
+    UartHost_Init(Sim_UartSink);
+
+    // 上电复位时端口为0xFF（六个灯全亮），初始化阶段的过渡不计入冲突统计
+    System_Init();
+    Main_RefreshDisplay();
+    halWriteHook = Sim_WriteHook;
+    if (!Sim_Timer0Enabled()) {
+        fprintf(stderr, "Timer0 未启动\n");
+        return 1;
+    }
+
+    {
+        const double tickSeconds = Sim_TickSeconds();
+        const unsigned long long totalTicks = (unsigned long long)(simSeconds / tickSeconds);
+        unsigned long long tick;
+        unsigned long long lastChangeTick = 0;
+        unsigned long phaseChanges = 0;
+        unsigned char lastState = currentState;
+        unsigned char lastLamps = P2 & LAMP_MASK;
+        unsigned int configuredCycle = 0;
+        unsigned long long pollCount = 0;
+        clock_t wallStart = clock();
+        double wallSeconds;
+
+        configuredCycle = phaseStart[PHASE_COUNT];
+
+        for (tick = 0; tick < totalTicks; tick++) {
+            unsigned int n;
+            simTickDone = 0;
+            for (n = 0; n < pollsPerTick && !simTickDone; n++) {
+                Main_Poll();
+                Main_Idle();
+                pollCount++;
+            }
+            if (!simTickDone && Sim_Timer0Enabled()) {
+                Sim_Timer0Overflow();
+            }
+            UartHost_Run(tickSeconds);
+            Sim_CheckCountdown();
+
+            if (currentState != lastState) {
+                phaseChanges++;
+                lastState = currentState;
+            }
+            if (trace && (P2 & LAMP_MASK) != lastLamps) {
+                double t = (tick + 1) * tickSeconds;
+                printf("%10.3fs  %s  (持续 %.3fs)\n", t, Sim_LampName(P2),
+                       (tick + 1 - lastChangeTick) * tickSeconds);
+                lastChangeTick = tick + 1;
+                lastLamps = P2 & LAMP_MASK;
+            }
+        }
+
+        wallSeconds = (double)(clock() - wallStart) / CLOCKS_PER_SEC;
+
+        printf("仿真时长        : %.0f s (%llu 个节拍, 每节拍 %.3f ms)\n",
+               totalTicks * tickSeconds, totalTicks, tickSeconds * 1000.0);
+        printf("状态切换次数    : %lu\n", phaseChanges);
+        printf("配置周期        : %u s\n", configuredCycle);
+        printf("相位方案        : %d (%d 个相位)\n", PHASE_PLAN, PHASE_COUNT);
+        if (phaseChanges >= PHASE_COUNT) {
+            printf("实测周期        : %.3f s\n",
+                   totalTicks * tickSeconds / ((double)phaseChanges / PHASE_COUNT));
+        }
+        printf("P2写入次数      : %lu\n", p2WriteCount);
+        printf("冲突放行次数    : %lu\n", conflictCount);
+        printf("倒计时错误      : %lu\n", countdownErrors);
+        printf("事件队列溢出    : %u\n", eventOverflow);
+        printf("串口发送        : %lu 字节 (%.1f%% 带宽, 缓冲区满丢帧 %u)\n", uartHostBytes,
+               100.0 * uartHostBytes * UartHost_ByteSeconds() / (totalTicks * tickSeconds), uartTxDropped);
+        printf("主循环/节拍     : %.2f (空闲 %lu 次)\n", (double)pollCount / totalTicks, idleCount);
+#if IDLE_STATS_ENABLE
+        // 仿真没有指令周期模型，中断和主循环耗时为0，此值只用于验证统计通路
+        printf("空闲占比(统计)  : %.2f%%\n", 100.0 * idleCountsLastSecond / IDLE_COUNTS_PER_S);
+#endif
+        printf("主机耗时        : %.2f s (加速比 %.0fx)\n", wallSeconds,
+               wallSeconds > 0 ? totalTicks * tickSeconds / wallSeconds : 0.0);
+    }
+
+    if (simUartFile) {
+        fclose(simUartFile);
+    }
+    return (conflictCount || countdownErrors) ? 1 : 0;
+}
@@ -0,0 +1,309 @@
+/**************************************************
+ * 文件名:    test_actuated.cpp
+ * 作者:
+ * 日期:      2025-10-15
+ * 描述:      感应控制测试（主机，ACTUATED_ENABLE=1）
+ *           按车辆模型驱动检测器引脚（每辆车占用线圈 OCCUPY_TICKS），逐节拍检查灯输出：
+ *           - 无车：两相位方案绿灯停留，不放行空方向；有左转/行人的方案跳过空的直行放行
+ *           - 空方向来一辆车：在 黄灯+清空+闪烁 的上限内放行，此后停在该方向
+ *           - 持续来车：绿灯走满可调绿灯时间（max-out）
+ *           - 稀疏来车：绿灯在最短绿灯+车头时距+闪烁的上限内提前结束（gap-out）
+ *           - 随机车流：不冲突放行、没有非法灯色变化、黄灯不缩短，每个请求在一个最长周期内放行
+ **************************************************/
+
+#include <stdio.h>
+
+#define main firmware_main
+#include "../main.c"
+#undef main
+
+void Timer0_ISR(void);
+
+#define DIR_NS 0
+#define DIR_EW 1
+
+#define COLOR_NONE   0
+#define COLOR_RED    1
+#define COLOR_YELLOW 2
+#define COLOR_GREEN  3
+
+#define SEC(s)        ((unsigned long)(s) * TIMEBASE_SEC_TICKS)
+#define OCCUPY_TICKS  (SEC(3) / 10)     // 一辆车占用线圈约300ms
+#define TEST_GREEN    30                // 测试用可调绿灯时间（最长绿灯）
+
+/*-----------------------车辆模型-----------------------------*/
+static unsigned long nowTick = 0;
+static unsigned long nextCar[2];        // 下一辆车到达的节拍（0=不来车）
+static unsigned long carEvery[2];       // 固定间隔（节拍），0=随机
+static unsigned long carMean[2];        // 随机车流的平均间隔（节拍），0=不来车
+static unsigned long occupyUntil[2] = {0, 0};
+static unsigned long rngState = 2025;
+
+static unsigned long Test_Rand(unsigned long n)
+{
+    rngState = rngState * 1103515245UL + 12345UL;
+    return (rngState >> 16) % n;
+}
+
+/**
+ * @brief  设置车流：every>0 为固定间隔，否则 mean>0 为随机间隔（均值 mean），两者都为0不来车
+ */
+static void Test_Traffic(unsigned char d, unsigned long every, unsigned long mean)
+{
+    carEvery[d] = every;
+    carMean[d] = mean;
+    nextCar[d] = (every || mean) ? nowTick + 1 : 0;
+}
+
+/*-----------------------灯色监视-----------------------------*/
+static unsigned char lastColor[2] = {COLOR_NONE, COLOR_NONE};
+static unsigned long colorSince[2] = {0, 0};
+static unsigned long greenStart[2] = {0, 0};
+static unsigned long waitSince[2] = {0, 0};     // 红灯方向第一辆等待车辆的到达节拍（0=没有）
+static unsigned long conflicts = 0;
+static unsigned long illegal = 0;
+static unsigned long shortYellow = 0;
+
+// 本阶段统计
+static unsigned long greens[2];
+static unsigned long greenMin[2];
+static unsigned long greenMax[2];
+static unsigned long greenSum[2];
+static unsigned long maxWait[2];
+static unsigned long pedWalks;
+
+static void Stats_Reset(void)
+{
+    unsigned char d;
+
+    for (d = 0; d < 2; d++) {
+        greens[d] = 0;
+        greenMin[d] = 0xFFFFFFFFUL;
+        greenMax[d] = 0;
+        greenSum[d] = 0;
+        maxWait[d] = 0;
+        greenStart[d] = 0;      // 进行中的绿灯不计入本阶段
+    }
+    pedWalks = 0;
+}
+
+static unsigned char Test_Color(unsigned char lamps, unsigned char d)
+{
+    switch ((d == DIR_NS ? lamps : lamps >> 3) & 0x07) {
+        case 0x00: return COLOR_NONE;       // 闪烁熄灭的半秒
+        case 0x01: return COLOR_RED;
+        case 0x02: return COLOR_YELLOW;
+        case 0x04: return COLOR_GREEN;
+        default:   illegal++; return COLOR_NONE;
+    }
+}
+
+/**
+ * @brief  检查本节拍的灯输出，记录各方向绿灯时长与等待时间
+ */
+static void Test_Check(void)
+{
+    unsigned char lamps = P2 & LAMP_MASK;
+    unsigned char moving = 0;
+    unsigned char d;
+
+#if PHASE_PLAN == PHASE_PLAN_FULL
+    static unsigned char lastWalk = 0;
+    unsigned char walk = (P0 & AUX_PED_WALK) != 0;
+
+    if (walk && !lastWalk) {
+        pedWalks++;
+    }
+    lastWalk = walk;
+#endif
+    for (d = 0; d < 2; d++) {
+        unsigned char c = Test_Color(lamps, d);
+
+        if (c == COLOR_NONE) {
+            c = lastColor[d];
+        }
+        if (c == COLOR_GREEN || c == COLOR_YELLOW) {
+            moving++;
+        }
+        if (c == lastColor[d]) {
+            continue;
+        }
+        if ((lastColor[d] == COLOR_GREEN && c == COLOR_RED) ||
+            (lastColor[d] == COLOR_YELLOW && c == COLOR_GREEN)) {
+            illegal++;
+        }
+        if (lastColor[d] == COLOR_YELLOW && nowTick - colorSince[d] + 1 < SEC(g_time_yellow)) {
+            shortYellow++;
+        }
+        if (c == COLOR_GREEN) {
+            greenStart[d] = nowTick;
+            if (waitSince[d]) {
+                if (nowTick - waitSince[d] > maxWait[d]) {
+                    maxWait[d] = nowTick - waitSince[d];
+                }
+                waitSince[d] = 0;
+            }
+        }
+        if (lastColor[d] == COLOR_GREEN && greenStart[d]) {
+            unsigned long t = nowTick - greenStart[d];
+            greens[d]++;
+            greenSum[d] += t;
+            if (t < greenMin[d]) greenMin[d] = t;
+            if (t > greenMax[d]) greenMax[d] = t;
+        }
+        lastColor[d] = c;
+        colorSince[d] = nowTick;
+    }
+    if (moving > 1) {
+        conflicts++;
+    }
+}
+
+/**
+ * @brief  运行指定节拍数：驱动检测器引脚，执行Timer0节拍和主循环事件，检查灯输出
+ */
+static void Test_Run(unsigned long ticks)
+{
+    unsigned char d;
+
+    while (ticks--) {
+        nowTick++;
+        for (d = 0; d < 2; d++) {
+            if (nextCar[d] && nowTick >= nextCar[d]) {
+                occupyUntil[d] = nowTick + OCCUPY_TICKS;
+                if (lastColor[d] != COLOR_GREEN && !waitSince[d]) {
+                    waitSince[d] = nowTick;
+                }
+                // 随机间隔不短于占用时间+0.2秒，相邻两辆车在检测器上可以分辨
+                if (carEvery[d]) {
+                    nextCar[d] = nowTick + carEvery[d];
+                } else if (!carMean[d]) {
+                    nextCar[d] = 0;     // 单独安排的一辆车
+                } else {
+                    nextCar[d] = nowTick + OCCUPY_TICKS + SEC(1) / 5 + Test_Rand(2 * carMean[d]);
+                }
+            }
+        }
+        DETECTOR_NS_PIN = nowTick < occupyUntil[DIR_NS] ? 0 : 1;
+        DETECTOR_EW_PIN = nowTick < occupyUntil[DIR_EW] ? 0 : 1;
+        TH0 = 0;
+        TL0 = 0;
+        Timer0_ISR();
+        Main_Poll();
+        Test_Check();
+    }
+}
+
+static unsigned char Test_IsGreen(unsigned char d)
+{
+    return lastColor[d] == COLOR_GREEN;
+}
+
+int main(void)
+{
+    // 黄灯 + 清空（最长的清空相位） + gap-out 后的闪烁，按秒边界计数各多1秒
+    unsigned long serveBound = SEC(FLASH_START_TIME + 2 + DEFAULT_YELLOW_TIME + 1 +
+                                   (PED_CLEAR_TIME > ALL_RED_TIME ? PED_CLEAR_TIME : ALL_RED_TIME) + 1);
+    unsigned long cycleMax;
+    unsigned long gapBound = SEC(ACT_MIN_GREEN + ACT_PASSAGE_TIME + FLASH_START_TIME + 2);
+    unsigned char d;
+    int ok = 1;
+
+    Hal_Reset();
+    System_Init();
+    g_time_green = TEST_GREEN;
+    UpdateStateTimeTable();
+    Plan_Swap();
+    currentState = 0;
+    timeLeft = stateTimeTable[0];
+    SetTrafficLights(0);
+    Countdown_Reload();
+    cycleMax = SEC(phaseStart[PHASE_COUNT]);
+#if PHASE_PLAN == PHASE_PLAN_FULL
+    // 空方向的直行被跳过，来车后最多等一个最长周期
+    serveBound = cycleMax + SEC(2);
+#endif
+
+    // 1. 无车：不放行空方向
+    Stats_Reset();
+    Test_Traffic(DIR_NS, 0, 0);
+    Test_Traffic(DIR_EW, 0, 0);
+    Test_Run(3 * cycleMax);
+#if PHASE_PLAN == PHASE_PLAN_FULL
+    if (greens[DIR_NS] || greens[DIR_EW] || Test_IsGreen(DIR_NS) || Test_IsGreen(DIR_EW) || pedWalks < 3) {
+        printf("无车: 直行放行 %lu/%lu 次、行人 %lu 次，应跳过直行且行人照常\n",
+               greens[DIR_NS], greens[DIR_EW], pedWalks);
+        ok = 0;
+    }
+#else
+    if (greens[DIR_NS] || greens[DIR_EW] || !Test_IsGreen(DIR_NS) || timeLeft != ACT_REST_TIME) {
+        printf("无车: 南北绿灯应停留在 %u 秒（实际放行 %lu/%lu 次，剩余 %u）\n",
+               ACT_REST_TIME, greens[DIR_NS], greens[DIR_EW], timeLeft);
+        ok = 0;
+    }
+#endif
+
+    // 2. 空方向来一辆车：在上限内放行，此后停在该方向
+    Stats_Reset();
+    Test_Traffic(DIR_EW, 0, 0);
+    nextCar[DIR_EW] = nowTick + SEC(1);
+    Test_Run(serveBound + SEC(2));
+    if (waitSince[DIR_EW] || maxWait[DIR_EW] > serveBound) {
+        printf("一辆车: 东西方向%s放行，等待 %.2fs（上限 %.2fs）\n", waitSince[DIR_EW] ? "没有" : "",
+               (double)maxWait[DIR_EW] / TIMEBASE_SEC_TICKS, (double)serveBound / TIMEBASE_SEC_TICKS);
+        ok = 0;
+    }
+#if PHASE_PLAN != PHASE_PLAN_FULL
+    Test_Run(2 * cycleMax);
+    if (!Test_IsGreen(DIR_EW) || greens[DIR_EW]) {
+        printf("一辆车: 放行后东西绿灯应停留等待\n");
+        ok = 0;
+    }
+#endif
+
+    // 3. 南北持续来车（车头时距小于 ACT_PASSAGE_TIME），东西少量来车：南北走满最长绿灯，东西提前结束
+    Stats_Reset();
+    Test_Traffic(DIR_NS, SEC(ACT_PASSAGE_TIME) - SEC(1) / 2, 0);
+    Test_Traffic(DIR_EW, SEC(20), 0);
+    Test_Run(6 * cycleMax);
+    if (greens[DIR_NS] < 2 ||
+        greenMin[DIR_NS] + SEC(1) < SEC(TEST_GREEN) || greenMax[DIR_NS] > SEC(TEST_GREEN) + SEC(1)) {
+        printf("持续来车: 南北绿灯 %lu 次 %.2f~%.2fs，应为最长绿灯 %us\n", greens[DIR_NS],
+               (double)greenMin[DIR_NS] / TIMEBASE_SEC_TICKS, (double)greenMax[DIR_NS] / TIMEBASE_SEC_TICKS,
+               TEST_GREEN);
+        ok = 0;
+    }
+    if (greens[DIR_EW] < 2 || greenMin[DIR_EW] + SEC(1) < SEC(ACT_MIN_GREEN) || greenMax[DIR_EW] > gapBound) {
+        printf("稀疏来车: 东西绿灯 %lu 次 %.2f~%.2fs，应在 %u~%.2fs 内提前结束\n", greens[DIR_EW],
+               (double)greenMin[DIR_EW] / TIMEBASE_SEC_TICKS, (double)greenMax[DIR_EW] / TIMEBASE_SEC_TICKS,
+               ACT_MIN_GREEN, (double)gapBound / TIMEBASE_SEC_TICKS);
+        ok = 0;
+    }
+
+    // 4. 随机车流（各方向平均间隔在稀疏与繁忙之间变化）：安全与等待上限
+    Stats_Reset();
+    for (d = 0; d < 24; d++) {
+        Test_Traffic(DIR_NS, 0, SEC(1 + Test_Rand(30)));
+        Test_Traffic(DIR_EW, 0, SEC(1 + Test_Rand(30)));
+        Test_Run(SEC(600));
+    }
+    if (maxWait[DIR_NS] > cycleMax + SEC(2) || maxWait[DIR_EW] > cycleMax + SEC(2)) {
+        printf("随机车流: 最长等待 %.2f/%.2fs，超过一个最长周期 %.2fs\n",
+               (double)maxWait[DIR_NS] / TIMEBASE_SEC_TICKS, (double)maxWait[DIR_EW] / TIMEBASE_SEC_TICKS,
+               (double)cycleMax / TIMEBASE_SEC_TICKS);
+        ok = 0;
+    }
+
+    if (conflicts || illegal || shortYellow) {
+        ok = 0;
+    }
+    printf("相位方案 %u 感应控制: 随机车流4小时 平均绿灯 南北 %.1fs 东西 %.1fs（最长 %us），"
+           "最长等待 %.1f/%.1fs, 冲突放行 %lu, 非法变化 %lu, 黄灯过短 %lu  %s\n",
+           PHASE_PLAN,
+           greens[DIR_NS] ? (double)greenSum[DIR_NS] / greens[DIR_NS] / TIMEBASE_SEC_TICKS : 0.0,
+           greens[DIR_EW] ? (double)greenSum[DIR_EW] / greens[DIR_EW] / TIMEBASE_SEC_TICKS : 0.0,
+           TEST_GREEN,
+           (double)maxWait[DIR_NS] / TIMEBASE_SEC_TICKS, (double)maxWait[DIR_EW] / TIMEBASE_SEC_TICKS,
+           conflicts, illegal, shortYellow, ok ? "通过" : "失败");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,242 @@
+/**************************************************
+ * 文件名:    test_boot.cpp
+ * 作者:
+ * 日期:      2025-10-17
+ * 描述:      快速启动测试（主机，各相位方案分别构建）
+ *           随机运行一段时间后制造一种情形，再热复位（POF=0，保留记录不清零）：
+ *           - 正常运行：接回同一相位和剩余时间，每个方向的灯色与复位前相同（闪烁熄灭的半秒除外）
+ *           - 紧急优先、设置模式、闪光运行、冲突监视故障期间，保留记录被改写，
+ *             或接回后第一个秒边界之前再次复位：全红 ALL_RED_TIME 秒后从相位0开始，
+ *             期间不出现放行灯，结束后恢复响应紧急请求
+ *           - 上电复位（POF=1）不采用保留记录，从相位0开始
+ *           复位后继续运行，冲突监视不得报故障
+ **************************************************/
+
+#include <stdio.h>
+
+#define main firmware_main
+#include "../main.c"
+#undef main
+
+void Timer0_ISR(void);
+void Emergency_NsISR(void);
+void Emergency_EwISR(void);
+
+#define TRIALS    3000
+#define LAMP_GO   (LAMP_NS_GREEN | LAMP_NS_YELLOW | LAMP_EW_GREEN | LAMP_EW_YELLOW)
+
+// 复位前制造的情形
+enum {
+    CASE_NORMAL,        // 正常运行
+    CASE_EMERGENCY,     // 紧急优先进行中
+    CASE_SETTING,       // 设置模式
+    CASE_FLASH,         // 闪光运行
+    CASE_FAULT,         // 冲突监视故障
+    CASE_CORRUPT,       // 保留记录被改写
+    CASE_TWICE,         // 接回后第一个秒边界之前再次复位
+    CASE_POWER,         // 上电复位
+    CASE_COUNT
+};
+
+static const char *const caseName[CASE_COUNT] = {
+    "正常", "紧急", "设置", "闪光", "故障", "记录损坏", "连续复位", "上电"
+};
+
+/*-----------------------随机数-------------------------------*/
+static unsigned long rngState = 7;
+
+static unsigned long Test_Rand(unsigned long n)
+{
+    rngState = rngState * 1103515245UL + 12345UL;
+    return (rngState >> 16) % n;
+}
+
+/**
+ * @brief  执行一个Timer0节拍并运行一次主循环
+ */
+static void Test_Tick(void)
+{
+    TH0 = 0;
+    TL0 = 0;
+    Timer0_ISR();
+    Main_Poll();
+}
+
+static void Test_Run(unsigned long ticks)
+{
+    while (ticks--) {
+        Test_Tick();
+    }
+}
+
+/**
+ * @brief  复位：上电（POF=1）或热复位（POF=0）
+ * @note   模拟启动代码：第一条指令写出全红，清零 idata 0x00-0x7F 并执行变量初始化
+ *         （这里只复原测试用到的固件状态），idata 顶部的保留记录不动
+ */
+static void Test_Reset(unsigned char power)
+{
+    Hal_Reset();
+    if (!power) {
+        PCON = 0;
+    }
+    P2 = BOOT_P2_SAFE;
+    P0 = BOOT_P0_SAFE;
+
+    emgRequest = 0;
+    emgStage = EMG_IDLE;
+    flashReq = 0;
+    flashStage = FLASH_OFF;
+    forcePhase = PHASE_NONE;
+    monFault = MON_OK;
+    countdownStale = 0;
+    g_isSettingMode = 0;
+    g_selectedColor = 0;
+    mainSelfTest = 1;
+    while (Event_Get() != EVT_NONE) {
+    }
+    System_Init();
+}
+
+/**
+ * @brief  运行直到 flashStage 成为 stage（最多两个周期）
+ */
+static int Test_RunUntilFlash(unsigned char stage)
+{
+    unsigned long n = 2UL * phaseStart[PHASE_COUNT] * TIMEBASE_SEC_TICKS;
+
+    while (n-- && flashStage != stage) {
+        Test_Tick();
+    }
+    return flashStage == stage;
+}
+
+int main(void)
+{
+    unsigned long count[CASE_COUNT] = {0};
+    unsigned long wrongMode = 0;      // 启动方式与情形不符
+    unsigned long wrongPhase = 0;     // 接回的相位/剩余时间与复位前不同
+    unsigned long lampChange = 0;     // 接回后某方向灯色与复位前不同
+    unsigned long clearShort = 0;     // 全红清空短于 ALL_RED_TIME 或期间出现放行灯
+    unsigned long emgOff = 0;         // 清空结束后没有恢复响应紧急请求
+    unsigned long faults = 0;         // 复位后冲突监视故障
+    unsigned long trial;
+    unsigned long clearTicks = (unsigned long)ALL_RED_TIME * TIMEBASE_SEC_TICKS;
+    int ok;
+
+    Test_Reset(1);
+
+    for (trial = 0; trial < TRIALS; trial++) {
+        unsigned char c = (unsigned char)Test_Rand(CASE_COUNT);
+        unsigned char expect = BOOT_CLEAR;
+        unsigned char phase;
+        unsigned char left;
+        unsigned char before;
+        unsigned char after;
+        unsigned char d;
+        unsigned long n;
+
+        // 每次从上电开始，运行至少1秒（第一个秒边界才记下保留记录）
+        Test_Reset(1);
+        Test_Run(TIMEBASE_SEC_TICKS + Test_Rand(2UL * phaseStart[PHASE_COUNT] * TIMEBASE_SEC_TICKS));
+
+        switch (c) {
+            case CASE_NORMAL:
+                expect = BOOT_RESUME;
+                break;
+            case CASE_EMERGENCY:
+                if (Test_Rand(2)) {
+                    Emergency_NsISR();
+                } else {
+                    Emergency_EwISR();
+                }
+                Test_Run(Test_Rand((unsigned long)(ALL_RED_TIME + 2) * TIMEBASE_SEC_TICKS));
+                break;
+            case CASE_SETTING:
+                Keys_Handle(EVT_KEY_SET);
+                Test_Run(Test_Rand(3UL * TIMEBASE_SEC_TICKS));
+                break;
+            case CASE_FLASH:
+                flashReq = 1;
+                if (!Test_RunUntilFlash(FLASH_ON)) {
+                    wrongMode++;
+                }
+                Test_Run(Test_Rand(3UL * TIMEBASE_SEC_TICKS));
+                break;
+            case CASE_FAULT:
+                // 秒边界的相位切换会在检查之前覆盖写入的灯，写到锁定为止
+                for (n = 0; n < 3 && !monFault; n++) {
+                    P2 = (unsigned char)((P2 & ~LAMP_MASK) | LAMP_NS_GREEN | LAMP_EW_GREEN);
+                    Test_Tick();
+                }
+                if (!monFault) {
+                    wrongMode++;
+                }
+                break;
+            case CASE_CORRUPT:
+                bootKeep[Test_Rand(BOOT_KEEP_SIZE)] ^= (unsigned char)(1 << Test_Rand(8));
+                break;
+            case CASE_TWICE:
+                Test_Reset(0);
+                Test_Run(Test_Rand(TIMEBASE_SEC_TICKS - 1));
+                break;
+            default:    // CASE_POWER
+                expect = BOOT_COLD;
+                break;
+        }
+        count[c]++;
+
+        phase = currentState;
+        left = timeLeft;
+        before = P2 & LAMP_MASK;
+        Test_Reset(c == CASE_POWER);
+        after = P2 & LAMP_MASK;
+
+        if (bootMode != expect) {
+            printf("情形 %s: 启动方式 %u，应为 %u\n", caseName[c], bootMode, expect);
+            wrongMode++;
+            continue;
+        }
+        if (expect == BOOT_RESUME) {
+            if (currentState != phase || timeLeft != left) {
+                wrongPhase++;
+            }
+            // 复位前在闪烁熄灭的半秒时该方向为0，不比较
+            for (d = 0; d < 2; d++) {
+                unsigned char b = (unsigned char)((before >> (3 * d)) & 0x07);
+                unsigned char a = (unsigned char)((after >> (3 * d)) & 0x07);
+                if (b && a != b) {
+                    lampChange++;
+                }
+            }
+        } else if (expect == BOOT_COLD) {
+            if (currentState != 0) {
+                wrongPhase++;
+            }
+        } else {
+            // 全红清空：ALL_RED_TIME 秒内只亮红灯，之后从相位0开始并恢复响应紧急请求
+            for (n = 0; n < clearTicks + 1 && !(P2 & LAMP_GO) && flashStage != FLASH_OFF; n++) {
+                Test_Tick();
+            }
+            if (n + 1 < clearTicks || flashStage != FLASH_OFF || currentState != 0) {
+                clearShort++;
+            }
+            if ((IE & 0x05) != 0x05) {
+                emgOff++;
+            }
+        }
+
+        Test_Run(2UL * phaseStart[PHASE_COUNT] * TIMEBASE_SEC_TICKS);
+        if (monFault) {
+            faults++;
+        }
+    }
+
+    ok = !wrongMode && !wrongPhase && !lampChange && !clearShort && !emgOff && !faults;
+    printf("相位方案 %u 快速启动: 复位 %lu 次（正常 %lu 紧急 %lu 设置 %lu 闪光 %lu 故障 %lu 记录损坏 %lu 连续 %lu 上电 %lu）, "
+           "启动方式不符 %lu, 相位不符 %lu, 灯色改变 %lu, 清空不足 %lu, 未恢复紧急 %lu, 监视故障 %lu  %s\n",
+           PHASE_PLAN, (unsigned long)TRIALS, count[CASE_NORMAL], count[CASE_EMERGENCY], count[CASE_SETTING],
+           count[CASE_FLASH], count[CASE_FAULT], count[CASE_CORRUPT], count[CASE_TWICE], count[CASE_POWER],
+           wrongMode, wrongPhase, lampChange, clearShort, emgOff, faults, ok ? "通过" : "失败");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+/**************************************************
+ * 文件名:    test_buzzer.cpp
+ * 作者:
+ * 日期:      2025-10-14
+ * 描述:      蜂鸣器音调与音型测试（主机）
+ *           按振荡周期推进仿真时间：Timer1 每 TIMER1_CLK_DIV 个周期加1，
+ *           模式2溢出时从TH1重装并调用 Buzzer_ISR()；每 TIMEBASE_TICK_CLKS 个周期调用一次 Buzzer_Tick()。
+ *           记录Timer1启停分段和BUZZER_PIN翻转时刻，检查：
+ *           - 每段发声的频率与配置音调误差小于1%
+ *           - 各发声/静音段的节拍数与音型表完全一致，多个音型按投递顺序播放
+ *           - 队列满时 Buzzer_Play() 立即返回0并丢弃音型
+ *           - 播放结束后Timer1停止、引脚为低电平
+ **************************************************/
+
+#include <stdio.h>
+#include <math.h>
+
+#include "../buzzer.c"
+
+#define MAX_SEGS 32
+
+typedef struct {
+    unsigned char on;           // 1=发声段（TR1=1）
+    unsigned long ticks;        // 持续节拍数
+    unsigned long toggles;      // 引脚翻转次数
+    unsigned long long firstClk;
+    unsigned long long lastClk; // 首末次翻转时刻（振荡周期）
+} Seg_t;
+
+static Seg_t segs[MAX_SEGS];
+static unsigned char segCount = 0;
+static unsigned long long nowClk = 0;
+
+static void Seg_Open(unsigned char on)
+{
+    if (segCount < MAX_SEGS) {
+        segs[segCount].on = on;
+        segs[segCount].ticks = 0;
+        segs[segCount].toggles = 0;
+        segCount++;
+    }
+}
+
+/**
+ * @brief  运行指定节拍数
+ */
+static void Test_Run(unsigned long ticks)
+{
+    unsigned long t;
+    unsigned long c;
+    unsigned char lastTr = TR1;
+    unsigned char lastPin = BUZZER_PIN;
+
+    for (t = 0; t < ticks; t++) {
+        Buzzer_Tick();
+        if (TR1 != lastTr) {
+            lastTr = TR1;
+            Seg_Open(lastTr);
+        }
+        if (segCount) {
+            segs[segCount - 1].ticks++;
+        }
+        // 一个节拍内 Timer1 的计数（振荡周期对齐到 TIMER1_CLK_DIV）
+        for (c = 0; c < TIMEBASE_TICK_CLKS / TIMER1_CLK_DIV; c++) {
+            nowClk += TIMER1_CLK_DIV;
+            if (!TR1) {
+                continue;
+            }
+            TL1 = (unsigned char)(TL1 + 1);
+            if (TL1 == 0) {
+                TL1 = TH1;
+                Buzzer_ISR();
+                if (BUZZER_PIN != lastPin && segCount) {
+                    Seg_t *s = &segs[segCount - 1];
+                    lastPin = BUZZER_PIN;
+                    if (s->toggles == 0) {
+                        s->firstClk = nowClk;
+                    }
+                    s->lastClk = nowClk;
+                    s->toggles++;
+                }
+            }
+        }
+        lastPin = BUZZER_PIN;
+    }
+}
+
+/**
+ * @brief  按音型表算出期望的分段（节拍数，发声段为正、静音段为负），音型之间空一个节拍
+ */
+static unsigned char Test_Expect(const unsigned char *pats, unsigned char n, long *out, long *hz)
+{
+    unsigned char count = 0;
+    unsigned char i;
+
+    for (i = 0; i < n; i++) {
+        unsigned char s = patternStart[pats[i]];
+        for (; buzzerSteps[s].tone != TONE_END; s++) {
+            long ticks = buzzerSteps[s].ticks;
+            unsigned char tone = buzzerSteps[s].tone;
+            // 相邻同类分段合并（音型结束的静音节拍与下一音型之间）
+            if (count && (out[count - 1] < 0) == (tone == TONE_OFF)) {
+                out[count - 1] += tone == TONE_OFF ? -ticks : ticks;
+                continue;
+            }
+            hz[count] = tone == TONE_LOW ? BUZZER_TONE_LOW_HZ : tone == TONE_HIGH ? BUZZER_TONE_HIGH_HZ : 0;
+            out[count++] = tone == TONE_OFF ? -ticks : ticks;
+        }
+        // TONE_END：停一个节拍后取下一个音型
+        if (i + 1 < n) {
+            hz[count] = 0;
+            out[count++] = -1;
+        }
+    }
+    return count;
+}
+
+int main(void)
+{
+    static const unsigned char pats[] = { BUZZER_PAT_WARN, BUZZER_PAT_CHIRP, BUZZER_PAT_BEEP };
+    long expect[MAX_SEGS];
+    long expectHz[MAX_SEGS];
+    unsigned char nExpect;
+    unsigned char accepted = 0;
+    unsigned char i;
+    double maxErr = 0.0;
+    int ok = 1;
+
+    Buzzer_Init();
+    if (!PT1) {
+        printf("Timer1 须为高优先级：低优先级时会被Timer0节拍中断推迟翻转、丢失溢出\n");
+        ok = 0;
+    }
+    Test_Run(10);
+    if (TR1 || BUZZER_PIN || segCount) {
+        printf("空闲时蜂鸣器不应发声\n");
+        ok = 0;
+    }
+
+    // 一次投递三个音型（队列容量 BUZZER_QUEUE_SIZE-1），第四个必须被丢弃
+    accepted += Buzzer_Play(BUZZER_PAT_NONE);
+    for (i = 0; i < sizeof(pats); i++) {
+        accepted += Buzzer_Play(pats[i]);
+    }
+    if (accepted != sizeof(pats) || Buzzer_Play(BUZZER_PAT_BEEP) != 0) {
+        printf("队列: 接受 %u 个音型，应为 %u，且队列满时应拒绝\n", accepted, (unsigned)sizeof(pats));
+        ok = 0;
+    }
+
+    Test_Run(1000);
+    // 最后一段为播放结束后的静音，不比较其长度
+    if (segCount && !segs[segCount - 1].on) {
+        segCount--;
+    }
+
+    nExpect = Test_Expect(pats, sizeof(pats), expect, expectHz);
+    if (nExpect != segCount) {
+        printf("分段数 %u，应为 %u\n", segCount, nExpect);
+        ok = 0;
+    }
+    for (i = 0; i < segCount && i < nExpect; i++) {
+        long got = segs[i].on ? (long)segs[i].ticks : -(long)segs[i].ticks;
+        if (got != expect[i]) {
+            printf("第%u段: %ld 节拍，应为 %ld\n", i, got, expect[i]);
+            ok = 0;
+        }
+        if (segs[i].on) {
+            double hz;
+            double err;
+            if (segs[i].toggles < 3) {
+                printf("第%u段: 只有 %lu 次翻转\n", i, segs[i].toggles);
+                ok = 0;
+                continue;
+            }
+            // 相邻两次翻转为半个周期
+            hz = (double)FOSC * (segs[i].toggles - 1) / 2.0 / (double)(segs[i].lastClk - segs[i].firstClk);
+            err = fabs(hz - expectHz[i]) / expectHz[i];
+            if (err > maxErr) {
+                maxErr = err;
+            }
+        }
+    }
+    if (maxErr > 0.01 || TR1 || BUZZER_PIN) {
+        ok = 0;
+    }
+
+    printf("蜂鸣器: Timer1 分频 %u 重装 %u/%u, 分段 %u/%u, 音调最大误差 %.2f%%, 队列满丢弃  %s\n",
+           (unsigned)BUZZER_PRESCALE, toneReload[TONE_LOW], toneReload[TONE_HIGH],
+           segCount, nExpect, maxErr * 100.0, ok ? "通过" : "失败");
+    return ok ? 0 : 1;
+}
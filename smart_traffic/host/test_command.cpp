@@ -0,0 +1,725 @@
+/**************************************************
+ * 文件名:    test_command.cpp
+ * 作者:
+ * 日期:      2025-10-17
+ * 描述:      串口命令回环测试（主机，各相位方案分别构建）
+ *           上位机一端用主机编码器（tlm_decode.cpp）组帧，经串口模型（uart_host.cpp）按波特率
+ *           逐字节送入固件的接收中断；固件的应答与遥测从同一线路回来，由主机解码器解帧。
+ *           串口中断唤醒空闲的主循环（与硬件相同，不等下一个Timer0节拍），检查：
+ *           - 读取/修改配时：应答内容与固件方案一致，新配时在周期边界生效，倒计时始终与相位表一致
+ *           - 参数越界、长度不符、未知命令、设置模式下的命令得到对应的拒绝应答，不改变任何状态
+ *           - CRC错误、杂散字节、被截断的帧不会被执行；接收状态机随后的帧正常同步（超时重发成功）
+ *           - 强制相位：在允许跳转的相位边界进入目标相位，放行不被截成非法灯色（绿→红、黄→绿），
+ *             有全红清空的方案不省略清空，冲突监视从不动作
+ *           - 闪光运行：两个方向红灯交替闪烁，不响应按键和紧急请求；退出后全红清空，从相位0开始
+ *           - 连续发送多条命令（不等应答）全部执行并应答
+ *           - 往返延迟：命令第一个字节开始发送到应答最后一个字节收完
+ **************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#define main firmware_main
+#include "../main.c"
+#undef main
+
+#include "uart_host.h"
+#include "tlm_decode.h"
+#include "iap_host.h"
+
+void Timer0_ISR(void);
+
+#if CMD_REPLY_PLAN != TLM_DEC_TYPE_PLAN || CMD_REPLY_ACK != TLM_DEC_TYPE_ACK || \
+    CMD_GET_PLAN != TLM_CMD_GET_PLAN || CMD_SET_PLAN != TLM_CMD_SET_PLAN || \
+    CMD_FORCE_PHASE != TLM_CMD_FORCE_PHASE || CMD_FLASH != TLM_CMD_FLASH
+#error "主机编解码器与固件命令格式不一致"
+#endif
+
+#define TICK_S         ((double)TIMEBASE_TICK_CLKS / (double)FOSC)
+#define SUBSTEPS       20       // 每个节拍内串口模型推进的步数（往返延迟分辨率 0.1ms）
+#define REPLY_TIMEOUT  0.1      // 等待应答的超时（秒），之后重发
+#define TRIES          3
+#define PLAN_TRIALS    60
+#define FORCE_TRIALS   150
+#define NOISE_TRIALS   200
+#define PIPELINE       8
+#define GREEN_CAP      20       // 随机配时的绿灯上限（秒），控制仿真时长
+#define YELLOW_CAP     6
+
+#define DIR_NS         0
+#define DIR_EW         1
+#define COLOR_NONE     0
+#define COLOR_RED      1
+#define COLOR_YELLOW   2
+#define COLOR_GREEN    3
+
+#if PHASE_PLAN == PHASE_PLAN_FULL
+#define MOVING_AUX (AUX_NS_LEFT | AUX_EW_LEFT | AUX_PED_WALK)
+#else
+#define MOVING_AUX 0
+#endif
+
+// 强制相位可以接受的目标：绿灯相位和保护放行相位（按相位表独立列出，黄灯、清空相位须拒绝）
+static const unsigned char forceTargets[] = {
+#if PHASE_PLAN == PHASE_PLAN_BASIC
+    0, 2
+#elif PHASE_PLAN == PHASE_PLAN_ALLRED
+    0, 3
+#elif PHASE_PLAN == PHASE_PLAN_FULL
+    0, 2, 5, 7, 10
+#endif
+};
+#define FORCE_TARGETS (sizeof(forceTargets) / sizeof(forceTargets[0]))
+
+/*-----------------------仿真状态-----------------------------*/
+typedef struct {
+    unsigned char type;
+    unsigned char len;
+    unsigned char payload[TLM_DEC_MAX_LEN];
+    double t;                                   // 最后一个字节收完的时刻
+} Reply_t;
+
+static unsigned long nowTick = 0;
+static double nowS = 0.0;
+static TlmDecoder_t dec;
+static std::vector<Reply_t> replies;            // 尚未取走的应答
+static unsigned long statusFrames = 0;
+static unsigned long flashModeFrames = 0;       // 带 TLM_F_FLASHMODE 的状态帧
+static unsigned long countdownErrors = 0;
+static unsigned long faults = 0;
+static unsigned long retries = 0;
+
+/*-----------------------往返延迟-----------------------------*/
+typedef struct {
+    unsigned long n;
+    double sum;
+    double min;
+    double max;
+} Latency_t;
+
+static Latency_t latPlan = {0, 0.0, 1e9, 0.0};  // GET_PLAN → 配时帧
+static Latency_t latAck = {0, 0.0, 1e9, 0.0};   // 其余命令 → 应答帧
+
+/*-----------------------安全监视-----------------------------*/
+static unsigned char lastColor[2] = {COLOR_RED, COLOR_RED};
+static unsigned long lastMoving[2] = {0, 0};    // 各方向（含左转/行人）最后一次放行的节拍
+static unsigned long conflicts = 0;
+static unsigned long illegal = 0;               // 绿→红、黄→绿、红→黄、同方向多灯
+static unsigned long shortClear = 0;            // 有清空相位的方案中放行前清空不足 ALL_RED_TIME
+static int checking = 0;                        // 初始化写出第一个相位之后才检查
+
+/*-----------------------随机数-------------------------------*/
+static unsigned long rngState = 29;
+
+static unsigned long Test_Rand(unsigned long n)
+{
+    rngState = rngState * 1103515245UL + 12345UL;
+    return (rngState >> 16) % n;
+}
+
+static unsigned char Test_Color(unsigned char lamps, unsigned char dir)
+{
+    unsigned char bits = (unsigned char)((dir == DIR_NS ? lamps : lamps >> 3) & 0x07);
+
+    switch (bits) {
+        case 0x00: return COLOR_NONE;       // 闪烁熄灭的半秒
+        case 0x01: return COLOR_RED;
+        case 0x02: return COLOR_YELLOW;
+        case 0x04: return COLOR_GREEN;
+        default:   illegal++; return COLOR_NONE;
+    }
+}
+
+static unsigned char Test_AuxMoving(unsigned char aux, unsigned char dir)
+{
+#if PHASE_PLAN == PHASE_PLAN_FULL
+    return (aux & AUX_PED_WALK) || (aux & (dir == DIR_NS ? AUX_NS_LEFT : AUX_EW_LEFT));
+#else
+    (void)aux;
+    (void)dir;
+    return 0;
+#endif
+}
+
+/**
+ * @brief  检查当前灯输出（每次P2/P0写入后调用，设置模式同样检查）
+ */
+static void Test_Check(void)
+{
+    unsigned char lamps = P2 & LAMP_MASK;
+    unsigned char aux = P0 & AUX_MASK;
+    unsigned char moving[2];
+    unsigned char d;
+
+    if (!checking) {
+        return;
+    }
+    for (d = 0; d < 2; d++) {
+        unsigned char c = Test_Color(lamps, d);
+
+        moving[d] = (c == COLOR_GREEN || c == COLOR_YELLOW);
+        if (c != COLOR_NONE && c != lastColor[d]) {
+            if ((lastColor[d] == COLOR_GREEN && c == COLOR_RED) ||
+                (lastColor[d] == COLOR_YELLOW && c == COLOR_GREEN) ||
+                (lastColor[d] == COLOR_RED && c == COLOR_YELLOW)) {
+                illegal++;
+            }
+            // 两相位方案黄灯直接接对向绿灯；其余方案放行前必须全红清空
+            if (PHASE_PLAN != PHASE_PLAN_BASIC && c == COLOR_GREEN &&
+                nowTick - lastMoving[d ^ 1] + 1 < (unsigned long)ALL_RED_TIME * TIMEBASE_SEC_TICKS) {
+                shortClear++;
+            }
+            lastColor[d] = c;
+        }
+    }
+    for (d = 0; d < 2; d++) {
+        if (moving[d] || Test_AuxMoving(aux, d)) {
+            lastMoving[d] = nowTick;
+        }
+    }
+    if (moving[DIR_NS] && moving[DIR_EW]) {
+        conflicts++;
+    }
+    if ((aux & MOVING_AUX) && (moving[DIR_NS] || moving[DIR_EW])) {
+        conflicts++;
+    }
+}
+
+static void Test_WriteHook(unsigned char addr, unsigned char value)
+{
+    UartHost_Write(addr, value);
+    IapHost_Write(addr, value);
+    if (addr == 0xA0 || addr == 0x80) {
+        Test_Check();
+    }
+}
+
+/**
+ * @brief  解码器回调：状态帧只做统计，应答帧排队等测试取走
+ */
+static void Test_OnFrame(const TlmDecoder_t *d, void *ctx)
+{
+    TlmStatus_t s;
+    Reply_t r;
+
+    (void)ctx;
+    if (Tlm_ParseStatus(d, &s)) {
+        statusFrames++;
+        if (s.flags & TLM_F_FLASHMODE) {
+            flashModeFrames++;
+        }
+        return;
+    }
+    r.type = d->type;
+    r.len = d->len;
+    memcpy(r.payload, d->payload, d->len);
+    r.t = nowS;
+    replies.push_back(r);
+}
+
+static void Test_Sink(unsigned char b)
+{
+    Tlm_Feed(&dec, b, Test_OnFrame, 0);
+}
+
+/**
+ * @brief  检查中断维护的BCD倒计时与相位表计算值一致（按相位表运行时）
+ */
+static void Test_CheckCountdown(void)
+{
+    unsigned char d;
+
+    if (g_isSettingMode || emgStage != EMG_IDLE || flashStage != FLASH_OFF || monFault) {
+        return;
+    }
+    for (d = 0; d < 2; d++) {
+        unsigned int v = Phase_Countdown(currentState, d, timeLeft);
+
+        if (v > 99) {
+            v = 99;
+        }
+        if (countdownBcd[d] != (((v / 10) << 4) | (v % 10))) {
+            countdownErrors++;
+        }
+    }
+}
+
+/**
+ * @brief  执行一个节拍：Timer0中断 → 主循环 → 串口收发一个节拍的时长；
+ *         其间串口中断每次执行后主循环都从空闲中唤醒运行一次
+ */
+static void Test_Tick(void)
+{
+    unsigned long isr;
+    int k;
+
+    nowTick++;
+    TH0 = 0;
+    TL0 = 0;
+    Timer0_ISR();
+    Test_CheckCountdown();
+    Main_Poll();
+    for (k = 0; k < SUBSTEPS; k++) {
+        isr = uartHostIsrCalls;
+        UartHost_Run(TICK_S / SUBSTEPS);
+        nowS += TICK_S / SUBSTEPS;
+        if (uartHostIsrCalls != isr) {
+            Main_Poll();
+        }
+    }
+    if (monFault) {
+        faults++;
+    }
+}
+
+static void Test_Run(unsigned long ticks)
+{
+    while (ticks--) {
+        Test_Tick();
+    }
+}
+
+static void Test_Latency(Latency_t *l, double s)
+{
+    l->n++;
+    l->sum += s;
+    if (s < l->min) {
+        l->min = s;
+    }
+    if (s > l->max) {
+        l->max = s;
+    }
+}
+
+/**
+ * @brief  发送一条命令并等待应答，超时重发
+ * @param  garbage: 第一次发送前先送出几个杂散字节（可能含同步字节）
+ * @retval 应答；重发 TRIES 次仍收不到时 type=0
+ */
+static Reply_t Test_Request(unsigned char type, const unsigned char *payload, unsigned char len, int garbage)
+{
+    unsigned char frame[TLM_DEC_MAX_LEN + 4];
+    unsigned int n = Tlm_Encode(type, payload, len, frame);
+    Reply_t none;
+    Reply_t r;
+    double t0;
+    int i;
+
+    memset(&none, 0, sizeof(none));
+    for (i = 0; i < TRIES; i++) {
+        if (garbage && i == 0) {
+            unsigned char junk[4];
+            unsigned int k;
+            unsigned int m = 1 + (unsigned int)Test_Rand(4);
+
+            for (k = 0; k < m; k++) {
+                junk[k] = Test_Rand(3) ? (unsigned char)Test_Rand(256) : (unsigned char)TLM_DEC_SYNC;
+            }
+            UartHost_Receive(junk, m);
+            while (UartHost_RxPending()) {
+                Test_Tick();
+            }
+        }
+        replies.clear();
+        t0 = nowS;
+        UartHost_Receive(frame, n);
+        while (replies.empty() && nowS - t0 < REPLY_TIMEOUT) {
+            Test_Tick();
+        }
+        if (!replies.empty()) {
+            r = replies.front();
+            replies.erase(replies.begin());
+            if (i == 0) {
+                Test_Latency(type == TLM_CMD_GET_PLAN ? &latPlan : &latAck, r.t - t0);
+            }
+            return r;
+        }
+        retries++;
+    }
+    return none;
+}
+
+/**
+ * @brief  命令应得到结果为 expect 的应答帧
+ */
+static int Test_Ack(unsigned char type, const unsigned char *payload, unsigned char len, unsigned char expect,
+                    const char *what)
+{
+    Reply_t r = Test_Request(type, payload, len, 0);
+
+    if (r.type != TLM_DEC_TYPE_ACK || r.len != 2 || r.payload[0] != type || r.payload[1] != expect) {
+        printf("%s: 应答类型 0x%02X 长度 %u 内容 %02X %02X，期望结果 %u\n",
+               what, r.type, r.len, r.payload[0], r.payload[1], expect);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief  读取配时，与固件生效方案比较
+ */
+static int Test_CheckPlan(int garbage)
+{
+    Reply_t r = Test_Request(TLM_CMD_GET_PLAN, 0, 0, garbage);
+    unsigned char i;
+
+    if (r.type != TLM_DEC_TYPE_PLAN || r.len != 3 + PHASE_COUNT) {
+        printf("读取配时: 应答类型 0x%02X 长度 %u\n", r.type, r.len);
+        return 0;
+    }
+    if (r.payload[0] != g_time_green || r.payload[1] != g_time_yellow || r.payload[2] != planPending) {
+        printf("读取配时: 绿 %u/%u 黄 %u/%u 待切换 %u/%u（应答/固件）\n",
+               r.payload[0], g_time_green, r.payload[1], g_time_yellow, r.payload[2], planPending);
+        return 0;
+    }
+    for (i = 0; i < PHASE_COUNT; i++) {
+        if (r.payload[3 + i] != stateTimeTable[i]) {
+            printf("读取配时: 相位 %u 时长 %u，生效方案 %u\n", i, r.payload[3 + i], stateTimeTable[i]);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static unsigned long Test_CycleTicks(void)
+{
+    return (unsigned long)phaseStart[PHASE_COUNT] * TIMEBASE_SEC_TICKS;
+}
+
+/**
+ * @brief  随机时刻读取/修改配时：应答正确，新配时在两个周期内生效
+ */
+static int Test_Plan(void)
+{
+    unsigned char expect[PHASE_COUNT];
+    unsigned char arg[2];
+    unsigned long limit;
+    unsigned int n;
+    unsigned int late = 0;
+    int ok = 1;
+
+    for (n = 0; n < PLAN_TRIALS && ok; n++) {
+        Test_Run(Test_Rand(Test_CycleTicks()));
+        arg[0] = (unsigned char)(MIN_LIGHT_TIME + Test_Rand(GREEN_CAP));
+        arg[1] = (unsigned char)(MIN_LIGHT_TIME + Test_Rand(YELLOW_CAP));
+        ok &= Test_Ack(TLM_CMD_SET_PLAN, arg, 2, 0, "修改配时");
+        if (g_time_green != arg[0] || g_time_yellow != arg[1] || g_time_red != arg[0] + arg[1] || !planPending) {
+            printf("修改配时后 绿 %u 黄 %u 红 %u 待切换 %u\n", g_time_green, g_time_yellow, g_time_red, planPending);
+            ok = 0;
+        }
+        memcpy(expect, planTime[planActive ^ 1], sizeof(expect));
+        ok &= Test_CheckPlan(0);
+
+        limit = 2 * Test_CycleTicks() + 2 * TIMEBASE_SEC_TICKS;
+        while (planPending && limit--) {
+            Test_Tick();
+        }
+        if (planPending || memcmp(expect, stateTimeTable, sizeof(expect))) {
+            late++;
+        }
+        ok &= Test_CheckPlan(0);
+    }
+    ok &= !late && !countdownErrors;
+    printf("读取/修改配时 %u 次: 未按时生效 %u, 倒计时不一致 %lu  %s\n",
+           n, late, countdownErrors, ok ? "通过" : "失败");
+    return ok;
+}
+
+/**
+ * @brief  拒绝的命令：参数越界、长度不符、未知命令、设置模式下的命令
+ */
+static int Test_Reject(void)
+{
+    unsigned char green = g_time_green;
+    unsigned char yellow = g_time_yellow;
+    unsigned char pending = planPending;
+    unsigned char arg[2];
+    int ok = 1;
+
+    arg[0] = MIN_LIGHT_TIME - 1;
+    arg[1] = 3;
+    ok &= Test_Ack(TLM_CMD_SET_PLAN, arg, 2, CMD_R_RANGE, "绿灯过短");
+    arg[0] = 10;
+    arg[1] = MAX_LIGHT_TIME + 1;
+    ok &= Test_Ack(TLM_CMD_SET_PLAN, arg, 2, CMD_R_RANGE, "黄灯过长");
+    ok &= Test_Ack(TLM_CMD_SET_PLAN, arg, 1, CMD_R_RANGE, "配时长度不符");
+    arg[0] = PHASE_COUNT;
+    ok &= Test_Ack(TLM_CMD_FORCE_PHASE, arg, 1, CMD_R_RANGE, "相位越界");
+    // 黄灯、清空相位不能作为目标（跳过去会红灯直接变黄灯或跳过过渡）
+    for (arg[0] = 0; arg[0] < PHASE_COUNT; arg[0]++) {
+        if (!memchr(forceTargets, arg[0], FORCE_TARGETS)) {
+            ok &= Test_Ack(TLM_CMD_FORCE_PHASE, arg, 1, CMD_R_RANGE, "非放行相位");
+        }
+    }
+    arg[0] = 2;
+    ok &= Test_Ack(TLM_CMD_FLASH, arg, 1, CMD_R_RANGE, "闪光参数");
+    ok &= Test_Ack(0x7E, 0, 0, CMD_R_TYPE, "未知命令");
+    if (g_time_green != green || g_time_yellow != yellow || planPending != pending ||
+        forcePhase != PHASE_NONE || flashReq) {
+        printf("被拒绝的命令改变了状态\n");
+        ok = 0;
+    }
+
+    // 设置模式：配时归按键，远程命令一律拒绝
+    while (emgStage != EMG_IDLE) {
+        Test_Tick();
+    }
+    Keys_Handle(EVT_KEY_SET);
+    arg[0] = 15;
+    arg[1] = 4;
+    ok &= Test_Ack(TLM_CMD_SET_PLAN, arg, 2, CMD_R_BUSY, "设置模式修改配时");
+    arg[0] = 0;
+    ok &= Test_Ack(TLM_CMD_FORCE_PHASE, arg, 1, CMD_R_BUSY, "设置模式强制相位");
+    arg[0] = 1;
+    ok &= Test_Ack(TLM_CMD_FLASH, arg, 1, CMD_R_BUSY, "设置模式闪光");
+    ok &= Test_CheckPlan(0);
+    Keys_Handle(EVT_KEY_SET);
+    Keys_Handle(EVT_KEY_SET);
+    Keys_Handle(EVT_KEY_SET);
+    if (g_isSettingMode || g_time_green == 15 || flashReq || forcePhase != PHASE_NONE) {
+        printf("设置模式下的远程命令被执行\n");
+        ok = 0;
+    }
+    printf("拒绝的命令: 越界/长度/未知/设置模式  %s\n", ok ? "通过" : "失败");
+    return ok;
+}
+
+/**
+ * @brief  CRC错误、截断的帧不执行；杂散字节之后的命令超时重发成功
+ */
+static int Test_Noise(void)
+{
+    unsigned char frame[TLM_DEC_MAX_LEN + 4];
+    unsigned char arg[2] = {7, 3};
+    unsigned char errors = cmdRxErrors;
+    unsigned char green = g_time_green;
+    unsigned long before = retries;
+    unsigned int n;
+    unsigned int len;
+    int ok = 1;
+
+    // CRC错误：不执行、不应答
+    len = Tlm_Encode(TLM_CMD_SET_PLAN, arg, 2, frame);
+    frame[len - 1] ^= 0x5A;
+    replies.clear();
+    UartHost_Receive(frame, len);
+    Test_Run((unsigned long)(REPLY_TIMEOUT / TICK_S));
+    if (!replies.empty() || g_time_green != green || (unsigned char)(cmdRxErrors - errors) != 1) {
+        printf("CRC错误的命令被执行或应答\n");
+        ok = 0;
+    }
+
+    // 截断的帧（只发出一半）之后紧跟完整的帧：前者吞掉后者的开头，后者重发成功
+    len = Tlm_Encode(TLM_CMD_SET_PLAN, arg, 2, frame);
+    UartHost_Receive(frame, len / 2);
+    ok &= Test_CheckPlan(0);
+    if (g_time_green != green) {
+        printf("截断的命令被执行\n");
+        ok = 0;
+    }
+
+    // 每条命令前随机杂散字节
+    for (n = 0; n < NOISE_TRIALS && ok; n++) {
+        ok &= Test_CheckPlan(1);
+        Test_Run(Test_Rand(TIMEBASE_SEC_TICKS));
+    }
+    ok &= g_time_green == green && uartHostRxOverruns == 0 && uartHostRxLost == 0;
+    printf("干扰: %u 条命令前插入杂散字节, 重发 %lu 次, 接收错误帧 %u, 接收溢出 %lu  %s\n",
+           n, retries - before, (unsigned char)(cmdRxErrors - errors), uartHostRxOverruns, ok ? "通过" : "失败");
+    return ok;
+}
+
+/**
+ * @brief  强制相位：在允许跳转的相位边界进入目标相位
+ */
+static int Test_Force(void)
+{
+    unsigned char arg[1];
+    unsigned long limit;
+    unsigned long start;
+    unsigned char prev = currentState;
+    unsigned long worst = 0;
+    unsigned long sum = 0;
+    unsigned long bound;
+    unsigned int late = 0;
+    unsigned int n;
+    int ok = 1;
+
+    // 最坏：放行截为 FLASH_START_TIME+1 秒 → 黄灯 → 清空，目标与黄灯方向相同时再绕过对向一次
+    bound = 2UL * (FLASH_START_TIME + 1 + YELLOW_CAP + MIN_LIGHT_TIME +
+                   (PED_CLEAR_TIME > ALL_RED_TIME ? PED_CLEAR_TIME : ALL_RED_TIME)) + 2;
+    for (n = 0; n < FORCE_TRIALS && ok; n++) {
+        Test_Run(Test_Rand(Test_CycleTicks()));
+        arg[0] = forceTargets[Test_Rand(FORCE_TARGETS)];
+        ok &= Test_Ack(TLM_CMD_FORCE_PHASE, arg, 1, CMD_R_OK, "强制相位");
+        start = nowTick;
+        limit = bound * TIMEBASE_SEC_TICKS;
+        // 请求在目标相位内完成：已在目标相位时，完成的同一秒相位可能恰好结束
+        while (forcePhase != PHASE_NONE && limit--) {
+            prev = currentState;
+            Test_Tick();
+        }
+        if (forcePhase != PHASE_NONE || (currentState != arg[0] && prev != arg[0])) {
+            printf("强制相位 %u: %lu 秒后仍在相位 %u\n", arg[0], bound, currentState);
+            late++;
+            continue;
+        }
+        sum += nowTick - start;
+        if (nowTick - start > worst) {
+            worst = nowTick - start;
+        }
+    }
+    ok &= !late && !illegal && !conflicts && !shortClear && !faults && !countdownErrors;
+    printf("强制相位 %u 次: 平均 %.1f 秒、最长 %.1f 秒进入目标（上限 %lu 秒）, 超时 %u, "
+           "非法灯色 %lu, 冲突 %lu, 清空不足 %lu, 监视故障 %lu  %s\n",
+           n, n ? sum * TICK_S / n : 0.0, worst * TICK_S, bound, late, illegal, conflicts, shortClear, faults,
+           ok ? "通过" : "失败");
+    return ok;
+}
+
+/**
+ * @brief  闪光运行：进入、保持（红灯交替、按键/紧急请求不响应）、退出后从相位0开始
+ */
+static int Test_Flash(void)
+{
+    unsigned char arg[2];
+    unsigned char expect[PHASE_COUNT];
+    unsigned long limit;
+    unsigned long frames;
+    unsigned long k;
+    unsigned int round;
+    unsigned int badLamps = 0;
+    int ok = 1;
+
+    for (round = 0; round < 20 && ok; round++) {
+        Test_Run(Test_Rand(Test_CycleTicks()));
+        arg[0] = 1;
+        ok &= Test_Ack(TLM_CMD_FLASH, arg, 1, CMD_R_OK, "进入闪光");
+        limit = 30UL * TIMEBASE_SEC_TICKS;
+        while (flashStage != FLASH_ON && limit--) {
+            Test_Tick();
+        }
+        if (flashStage != FLASH_ON) {
+            printf("30 秒后仍未进入闪光运行（相位 %u）\n", currentState);
+            ok = 0;
+            break;
+        }
+
+        // 保持：每个节拍只有一个方向亮红灯，半秒交替；按键、强制相位、紧急请求均不响应
+        frames = flashModeFrames;
+        for (k = 0; k < 6UL * TIMEBASE_SEC_TICKS; k++) {
+            unsigned char lamps = P2 & LAMP_MASK;
+
+            Test_Tick();
+            if (lamps != LAMP_NS_RED && lamps != LAMP_EW_RED) {
+                badLamps++;
+            }
+            if ((P0 & AUX_MASK & MOVING_AUX) || EX0 || EX1) {
+                badLamps++;
+            }
+        }
+        if (Keys_Handle(EVT_KEY_SET) || g_isSettingMode) {
+            printf("闪光运行时响应了按键\n");
+            ok = 0;
+        }
+        arg[0] = 0;
+        ok &= Test_Ack(TLM_CMD_FORCE_PHASE, arg, 1, CMD_R_BUSY, "闪光时强制相位");
+        // 闪光期间修改配时：退出时（新周期）生效
+        arg[0] = (unsigned char)(MIN_LIGHT_TIME + Test_Rand(GREEN_CAP));
+        arg[1] = (unsigned char)(MIN_LIGHT_TIME + Test_Rand(YELLOW_CAP));
+        ok &= Test_Ack(TLM_CMD_SET_PLAN, arg, 2, CMD_R_OK, "闪光时修改配时");
+        memcpy(expect, planTime[planActive ^ 1], sizeof(expect));
+        if (flashModeFrames == frames) {
+            printf("闪光运行时遥测没有闪光标志\n");
+            ok = 0;
+        }
+
+        arg[0] = 0;
+        ok &= Test_Ack(TLM_CMD_FLASH, arg, 1, CMD_R_OK, "退出闪光");
+        limit = (ALL_RED_TIME + 2UL) * TIMEBASE_SEC_TICKS;
+        while (flashStage != FLASH_OFF && limit--) {
+            Test_Tick();
+        }
+        if (flashStage != FLASH_OFF || currentState != 0 || !EX0 || !EX1 ||
+            memcmp(expect, stateTimeTable, sizeof(expect)) || timeLeft + 1 < stateTimeTable[0]) {
+            printf("退出闪光后 阶段 %u 相位 %u 剩余 %u EX0/EX1 %u/%u\n",
+                   flashStage, currentState, timeLeft, (unsigned char)EX0, (unsigned char)EX1);
+            ok = 0;
+        }
+        Test_Run(Test_CycleTicks());
+    }
+    ok &= !badLamps && !illegal && !conflicts && !shortClear && !faults && !countdownErrors;
+    printf("闪光运行 %u 次: 灯色/中断不符 %u, 非法灯色 %lu, 冲突 %lu, 清空不足 %lu, 监视故障 %lu  %s\n",
+           round, badLamps, illegal, conflicts, shortClear, faults, ok ? "通过" : "失败");
+    return ok;
+}
+
+/**
+ * @brief  连续发送多条命令（不等应答）：全部执行并按顺序应答
+ */
+static int Test_Pipeline(void)
+{
+    unsigned char frame[PIPELINE][8];
+    unsigned int len[PIPELINE];
+    unsigned char arg[1] = {0};
+    unsigned char dropped = cmdRxDropped;
+    unsigned int i;
+    unsigned int acks = 0;
+    int ok;
+
+    for (i = 0; i < PIPELINE; i++) {
+        len[i] = Tlm_Encode(TLM_CMD_FLASH, arg, 1, frame[i]);
+    }
+    replies.clear();
+    for (i = 0; i < PIPELINE; i++) {
+        UartHost_Receive(frame[i], len[i]);
+    }
+    Test_Run((unsigned long)(REPLY_TIMEOUT / TICK_S));
+    for (i = 0; i < replies.size(); i++) {
+        if (replies[i].type == TLM_DEC_TYPE_ACK && replies[i].payload[0] == TLM_CMD_FLASH &&
+            replies[i].payload[1] == CMD_R_OK) {
+            acks++;
+        }
+    }
+    ok = acks == PIPELINE && cmdRxDropped == dropped;
+    printf("连续 %u 条命令: 应答 %u, 主循环来不及取走 %u  %s\n",
+           PIPELINE, acks, (unsigned char)(cmdRxDropped - dropped), ok ? "通过" : "失败");
+    return ok;
+}
+
+int main(void)
+{
+    int ok = 1;
+
+    Hal_Reset();
+    IapHost_Init();
+    UartHost_Init(Test_Sink);
+    Tlm_Init(&dec);
+    halWriteHook = Test_WriteHook;
+    System_Init();
+    lastColor[DIR_NS] = Test_Color(P2 & LAMP_MASK, DIR_NS);
+    lastColor[DIR_EW] = Test_Color(P2 & LAMP_MASK, DIR_EW);
+    checking = 1;
+    if (!UartHost_ByteSeconds() || !REN) {
+        printf("串口未按方式1/Timer2波特率初始化或未允许接收\n");
+        return 1;
+    }
+    Test_Run(TIMEBASE_SEC_TICKS);
+
+    ok &= Test_Plan();
+    ok &= Test_Reject();
+    ok &= Test_Noise();
+    ok &= Test_Force();
+    ok &= Test_Flash();
+    ok &= Test_Pipeline();
+
+    printf("往返延迟（%lu bps）: 读取配时 %lu 次 最短 %.1f / 平均 %.1f / 最长 %.1f ms；"
+           "其余命令 %lu 次 最短 %.1f / 平均 %.1f / 最长 %.1f ms\n",
+           (unsigned long)UART_BAUD,
+           latPlan.n, latPlan.min * 1000.0, latPlan.n ? latPlan.sum / latPlan.n * 1000.0 : 0.0, latPlan.max * 1000.0,
+           latAck.n, latAck.min * 1000.0, latAck.n ? latAck.sum / latAck.n * 1000.0 : 0.0, latAck.max * 1000.0);
+    printf("相位方案 %u 串口命令: 遥测帧 %lu, 解码CRC错误 %lu  %s\n",
+           PHASE_PLAN, statusFrames, dec.crcErrors, ok ? "通过" : "失败");
+    return ok ? 0 : 1;
+}
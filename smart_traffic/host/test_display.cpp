@@ -0,0 +1,247 @@
+/**************************************************
+ * 文件名:    test_display.cpp
+ * 作者:
+ * 日期:      2025-10-13
+ * 描述:      4位数码管动态扫描测试（主机）
+ *           通过SFR写钩子记录段码口P1与74HC139译码输入P2.6/P2.7，
+ *           运行一个完整周期（绿灯45秒，倒计时出现两位数），检查：
+ *           - 译码输入只在段码消隐（0xFF）时改变，不会串显到相邻位
+ *           - 每个节拍只翻转一根译码输入，四位点亮的节拍数相同（占空比1/4）
+ *           - 每位刷新率不低于100Hz
+ *           - 上电自检：第一个秒边界之前四位显示8888（快速启动，不延时等待）
+ *           - 主循环处理完事件后，四位显示的数字与按相位表计算的倒计时一致（00-99）
+ *           - 亮度0-7：每位点亮的节拍数恰好是常亮时的 (n+1)/8
+ *           - 设置模式：南北两位显示颜色字母和空白、东西两位显示时间；每秒亮半秒、灭半秒，熄灭的半秒内四位全部消隐
+ **************************************************/
+
+#include <stdio.h>
+
+#define main firmware_main
+#include "../main.c"
+#undef main
+
+void Timer0_ISR(void);
+
+#define P2_ADDR  0xA0
+#define SEL_MASK 0xC0
+
+static unsigned char lastP2;
+static unsigned long ghostCount = 0;      // 段码未消隐时切换位选的次数
+static unsigned long doubleFlipCount = 0; // 一次写入同时翻转A、B的次数
+
+// 共阳极段码（与 display.c 的段码表相同，独立写出以便核对）
+static const unsigned char segCA[10] = {
+    0xC0, 0xF9, 0xA4, 0xB0, 0x99, 0x92, 0x82, 0xF8, 0x80, 0x90
+};
+
+#define SEG_CA_G 0xC2     // 设置模式的绿灯字母 G（共阳极）
+
+// 共阳极段码 → 数字（不是数字返回0xFF）
+static unsigned char Test_Decode(unsigned char seg)
+{
+    unsigned char n;
+    for (n = 0; n < 10; n++) {
+        if (segCA[n] == seg) {
+            return n;
+        }
+    }
+    return 0xFF;
+}
+
+static void Test_WriteHook(unsigned char addr, unsigned char value)
+{
+    unsigned char changed;
+
+    if (addr != P2_ADDR) {
+        return;
+    }
+    changed = (unsigned char)((value ^ lastP2) & SEL_MASK);
+    if (changed && P1 != 0xFF) {
+        ghostCount++;
+    }
+    if (changed == SEL_MASK) {
+        doubleFlipCount++;
+    }
+    lastP2 = value;
+}
+
+/**
+ * @brief  执行一个Timer0节拍并处理主循环事件，返回本节拍点亮的位（熄灭返回 DISPLAY_DIGITS）
+ */
+static unsigned char Test_Tick(void)
+{
+    TH0 = 0;
+    TL0 = 0;
+    Timer0_ISR();
+    Main_Poll();
+    return P1 != 0xFF ? (unsigned char)(P2 >> 6) : (unsigned char)DISPLAY_DIGITS;
+}
+
+/**
+ * @brief  各亮度级别：运行100个完整时隙表周期，每位点亮节拍数必须为 100×(n+1)
+ */
+static int Test_Brightness(void)
+{
+    unsigned char level;
+    unsigned long n;
+    int ok = 1;
+
+    for (level = 0; level < DISPLAY_BRIGHTNESS_LEVELS; level++) {
+        unsigned long lit[DISPLAY_DIGITS + 1] = {0, 0, 0, 0, 0};
+        unsigned char d;
+
+        Display_SetBrightness(level);
+        for (n = 0; n < 100UL * DISPLAY_SLOTS; n++) {
+            lit[Test_Tick()]++;
+        }
+        for (d = 0; d < DISPLAY_DIGITS; d++) {
+            if (lit[d] != 100UL * (level + 1)) {
+                printf("亮度 %u: 第%u位点亮 %lu 个节拍，应为 %lu\n",
+                       level, d, lit[d], 100UL * (level + 1));
+                ok = 0;
+            }
+        }
+    }
+    Display_SetBrightness(DISPLAY_BRIGHTNESS_DEFAULT);
+    return ok;
+}
+
+/**
+ * @brief  设置模式闪烁：运行3秒，统计点亮占比和持续半秒以上的熄灭段数，
+ *         并检查南北两位为绿灯字母 G 与空白（颜色只在数码管上指示）、东西两位为绿灯时间
+ * @note   空白位本身不亮，亮的半秒内点亮占比为 3/4，整体为 3/8
+ */
+static int Test_Blink(double *litRatio, unsigned int *darkRuns)
+{
+    unsigned long ticks = 3UL * TIMEBASE_SEC_TICKS;
+    unsigned long n;
+    unsigned long lit = 0;
+    unsigned long darkRun = 0;
+    unsigned char seg[DISPLAY_DIGITS] = {0xFF, 0xFF, 0xFF, 0xFF};
+    unsigned char d;
+    int ok;
+
+    g_isSettingMode = 1;
+    g_selectedColor = 2;
+    Main_RefreshDisplay();
+    *darkRuns = 0;
+    for (n = 0; n < ticks; n++) {
+        d = Test_Tick();
+        if (d < DISPLAY_DIGITS) {
+            seg[d] = P1;
+            lit++;
+            darkRun = 0;
+        } else if (++darkRun == HALF_SECOND_TICKS) {
+            (*darkRuns)++;
+        }
+    }
+    g_isSettingMode = 0;
+    Main_RefreshDisplay();
+
+    *litRatio = (double)lit / ticks;
+    ok = *litRatio > 0.365 && *litRatio < 0.385 && *darkRuns == 3;
+    if (seg[0] != SEG_CA_G || seg[1] != 0xFF ||
+        Test_Decode(seg[2]) * 10 + Test_Decode(seg[3]) != g_time_green) {
+        printf("设置模式显示 %02X %02X %02X %02X，应为 G、空白、%02u\n", seg[0], seg[1], seg[2], seg[3], g_time_green);
+        ok = 0;
+    }
+    return ok;
+}
+
+int main(void)
+{
+    unsigned long ticks;
+    unsigned long cycleTicks;
+    unsigned long litTicks[DISPLAY_DIGITS] = {0, 0, 0, 0};
+    unsigned char shown[DISPLAY_DIGITS] = {0xFF, 0xFF, 0xFF, 0xFF};
+    unsigned long mismatchCount = 0;
+    unsigned long checked = 0;
+    unsigned long changeTick = 0;         // 倒计时最近一次变化的节拍
+    unsigned int lastValue[2] = {0, 0};
+    unsigned char maxShown = 0;
+    unsigned long selfTestTicks = 0;      // 显示8888的节拍数
+    unsigned long selfTestBad = 0;        // 自检期间点亮的位不是8
+    double refreshHz;
+    double blinkRatio;
+    unsigned int darkRuns;
+    int ok = 1;
+    unsigned char d;
+
+    // 绿灯45秒：红灯倒计时48秒，覆盖两位数显示
+    g_time_green = 45;
+    g_time_yellow = 3;
+    g_time_red = 48;
+
+    Hal_Reset();
+    System_Init();
+    Main_RefreshDisplay();
+    lastP2 = P2;
+    halWriteHook = Test_WriteHook;
+
+    cycleTicks = (unsigned long)phaseStart[PHASE_COUNT] * FOSC / TIMEBASE_TICK_CLKS + 1;
+    for (ticks = 0; ticks < cycleTicks; ticks++) {
+        unsigned char digit = Test_Tick();
+
+        // 本节拍点亮的位及其显示的数字
+        if (digit < DISPLAY_DIGITS) {
+            litTicks[digit]++;
+            shown[digit] = Test_Decode(P1);
+        }
+
+        // 倒计时变化后的一轮扫描中部分位还是旧值，四位都刷新过之后才比较
+        for (d = 0; d < 2; d++) {
+            unsigned int v = Phase_Countdown(currentState, d, timeLeft);
+            if (v != lastValue[d]) {
+                lastValue[d] = v;
+                changeTick = ticks;
+            }
+        }
+#if FAST_BOOT_ENABLE
+        // 自检期间（第一个秒边界之前）显示8888，之后四位在一轮扫描内换成倒计时
+        if (mainSelfTest) {
+            selfTestTicks++;
+            if (digit < DISPLAY_DIGITS && shown[digit] != 8) {
+                selfTestBad++;
+            }
+            continue;
+        }
+#endif
+        if (ticks - changeTick >= DISPLAY_DIGITS) {
+            for (d = 0; d < 2; d++) {
+                unsigned int v = lastValue[d];
+                unsigned char tens = shown[d * 2];
+                unsigned char ones = shown[d * 2 + 1];
+                if (v > 99) {
+                    v = 99;
+                }
+                checked++;
+                if (tens > 9 || ones > 9 || (unsigned int)(tens * 10 + ones) != v) {
+                    mismatchCount++;
+                } else if (v > maxShown) {
+                    maxShown = (unsigned char)v;
+                }
+            }
+        }
+    }
+
+    for (d = 1; d < DISPLAY_DIGITS; d++) {
+        if (litTicks[d] + 1 < litTicks[0] || litTicks[d] > litTicks[0] + 1) {
+            ok = 0;
+        }
+    }
+    refreshHz = (double)litTicks[0] / ((double)cycleTicks * TIMEBASE_TICK_CLKS / FOSC);
+    if (ghostCount || doubleFlipCount || mismatchCount || refreshHz < 100.0 || maxShown < 10 ||
+        selfTestBad || selfTestTicks > TIMEBASE_SEC_TICKS) {
+        ok = 0;
+    }
+
+    ok &= Test_Brightness();
+    ok &= Test_Blink(&blinkRatio, &darkRuns);
+
+    printf("数码管: 每位刷新 %.1fHz (点亮节拍 %lu/%lu/%lu/%lu), 串显 %lu 次, 双位翻转 %lu 次, "
+           "自检8888 %lu 个节拍（非8 %lu）, 显示不一致 %lu/%lu, 最大显示 %02u, 闪烁点亮 %.1f%% 熄灭段 %u  %s\n",
+           refreshHz, litTicks[0], litTicks[1], litTicks[2], litTicks[3],
+           ghostCount, doubleFlipCount, selfTestTicks, selfTestBad, mismatchCount, checked, maxShown,
+           blinkRatio * 100.0, darkRuns, ok ? "通过" : "失败");
+    return ok ? 0 : 1;
+}
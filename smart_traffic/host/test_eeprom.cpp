@@ -0,0 +1,345 @@
+/**************************************************
+ * 文件名:    test_eeprom.cpp
+ * 作者:
+ * 日期:      2025-10-17
+ * 描述:      配时存储测试（主机，STC89 IAP/EEPROM 模型 iap_host.cpp）
+ *           - 空白闪存上电保持默认配时；按键退出设置、远程修改配时后重新上电恢复新配时
+ *           - 磨损：随机配时连续保存（序号跨过16位回绕），随机间隔重新上电，每次恢复的都是最后保存的配时；
+ *             各扇区擦除次数相差不超过1，只用 EEPROM_SECTORS 个扇区，从不对未擦除的字节编程
+ *           - 掉电：随机在保存或上电预擦除的第 N 次编程/擦除时掉电，重新上电后恢复的
+ *             是最后一条完整保存的配时，之后的保存照常
+ *           - 上电扫描读取的字节数（最坏情况：各扇区全部写满）
+ *           - 紧急请求中断允许时从不擦除：写完当前扇区和备用扇区后保存被拒绝、远程修改配时回复忙；
+ *             设置模式中保存时补足备用扇区（擦除后 Timer0 恢复运行），之后远程修改照常
+ *           磨损/掉电/扫描各项按设置模式保存（紧急请求中断屏蔽，允许擦除）
+ **************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#define main firmware_main
+#include "../main.c"
+#undef main
+
+#include "iap_host.h"
+
+#define WEAR_SAVES   70000UL    // 超过65536，覆盖序号回绕
+#define FAIL_TRIALS  3000
+#define BOOT_GAP     200        // 随机重新上电的最大间隔（次保存）
+
+/*-----------------------随机数-------------------------------*/
+static unsigned long rngState = 23;
+
+static unsigned long Test_Rand(unsigned long n)
+{
+    rngState = rngState * 1103515245UL + 12345UL;
+    return (rngState >> 16) % n;
+}
+
+static void Test_WriteHook(unsigned char addr, unsigned char value)
+{
+    IapHost_Write(addr, value);
+}
+
+/**
+ * @brief  重新上电：RAM中的配时回到默认值，只恢复配时存储；紧急请求中断保持屏蔽（允许擦除）
+ * @retval Eeprom_LoadPlan() 的返回值
+ */
+static unsigned char Test_Boot(void)
+{
+    EX0 = 0;
+    EX1 = 0;
+    g_time_green = DEFAULT_GREEN_TIME;
+    g_time_yellow = DEFAULT_YELLOW_TIME;
+    g_time_red = DEFAULT_RED_TIME;
+    return Eeprom_LoadPlan();
+}
+
+/**
+ * @brief  换一组与当前不同的随机配时并保存
+ * @retval Eeprom_SavePlan() 的返回值
+ */
+static unsigned char Test_SaveRandom(void)
+{
+    unsigned char g;
+    unsigned char y;
+
+    do {
+        g = (unsigned char)(MIN_LIGHT_TIME + Test_Rand(MAX_LIGHT_TIME - MIN_LIGHT_TIME + 1));
+        y = (unsigned char)(MIN_LIGHT_TIME + Test_Rand(MAX_LIGHT_TIME - MIN_LIGHT_TIME + 1));
+    } while (g == g_time_green && y == g_time_yellow);
+    g_time_green = g;
+    g_time_yellow = y;
+    g_time_red = g + y;
+    return Eeprom_SavePlan();
+}
+
+/**
+ * @brief  经串口命令接收状态机送入一条 SET_PLAN 并执行
+ */
+static void Test_Command(unsigned char green, unsigned char yellow)
+{
+    unsigned char frame[6] = { TLM_SYNC, CMD_SET_PLAN, 2, green, yellow, 0 };
+    unsigned char i;
+
+    for (i = 1; i < 5; i++) {
+        frame[5] = Uart_Crc8(frame[5], frame[i]);
+    }
+    for (i = 0; i < 6; i++) {
+        Command_RxByte(frame[i]);
+    }
+    Command_Poll();
+}
+
+/**
+ * @brief  各扇区擦除次数之和
+ */
+static unsigned long Test_Erases(void)
+{
+    unsigned long total = 0;
+    unsigned char s;
+
+    for (s = 0; s < IAP_HOST_SECTORS; s++) {
+        total += iapHostErases[s];
+    }
+    return total;
+}
+
+/**
+ * @brief  按键进入设置模式后直接退出（配时不变时不写）
+ */
+static void Test_KeySave(void)
+{
+    unsigned char n;
+
+    for (n = 0; n < 4; n++) {
+        Keys_Handle(EVT_KEY_SET);
+    }
+}
+
+/**
+ * @brief  整机上电与按键/远程命令保存
+ */
+static int Test_System(void)
+{
+    int ok = 1;
+    unsigned char n;
+    unsigned int saved = 0;
+    unsigned long erases;
+
+    IapHost_Init();
+    Hal_Reset();
+    System_Init();
+    if (g_time_green != DEFAULT_GREEN_TIME || g_time_yellow != DEFAULT_YELLOW_TIME) {
+        printf("空白闪存上电后配时 %u/%u\n", g_time_green, g_time_yellow);
+        ok = 0;
+    }
+
+    // 按键：进入设置，红（即绿）+4，黄+2，退出
+    Keys_Handle(EVT_KEY_SET);
+    for (n = 0; n < 4; n++) {
+        Keys_Handle(EVT_KEY_UP);
+    }
+    Keys_Handle(EVT_KEY_SET);
+    for (n = 0; n < 2; n++) {
+        Keys_Handle(EVT_KEY_UP);
+    }
+    Keys_Handle(EVT_KEY_SET);
+    Keys_Handle(EVT_KEY_SET);
+    Hal_Reset();
+    System_Init();
+    if (g_time_green != DEFAULT_GREEN_TIME + 4 || g_time_yellow != DEFAULT_YELLOW_TIME + 2 ||
+        g_time_red != g_time_green + g_time_yellow) {
+        printf("按键保存后重新上电配时 %u/%u/%u\n", g_time_green, g_time_yellow, g_time_red);
+        ok = 0;
+    }
+
+    // 远程命令
+    Test_Command(17, 4);
+    Hal_Reset();
+    System_Init();
+    if (g_time_green != 17 || g_time_yellow != 4) {
+        printf("远程命令保存后重新上电配时 %u/%u\n", g_time_green, g_time_yellow);
+        ok = 0;
+    }
+
+    // 紧急请求中断允许（正常运行）：只写当前扇区和备用扇区，不擦除，用完后拒绝
+    erases = Test_Erases();
+    while (saved < 3 * EE_SLOTS && Eeprom_CanSave(g_time_green + 1, g_time_yellow)) {
+        Test_SaveRandom();
+        saved++;
+    }
+    if (!EX0 || !EX1 || Test_Erases() != erases || saved < EE_SLOTS || saved > 2 * EE_SLOTS) {
+        printf("正常运行中保存 %u 次后拒绝，擦除 %lu 次\n", saved, Test_Erases() - erases);
+        ok = 0;
+    }
+    n = g_time_yellow;
+    Test_Command(g_time_green, n == MIN_LIGHT_TIME ? n + 1 : n - 1);
+    if (g_time_yellow != n || Test_Erases() != erases) {
+        printf("备用扇区用完后远程修改配时没有被拒绝\n");
+        ok = 0;
+    }
+
+    // 设置模式中保存：擦除换入的扇区写下记录，再补足备用扇区（各擦除一次），Timer0 照常运行，之后远程修改照常
+    g_time_green = g_time_green == MIN_LIGHT_TIME ? g_time_green + 1 : g_time_green - 1;
+    g_time_red = g_time_green + g_time_yellow;
+    Test_KeySave();
+    if (Test_Erases() != erases + 2 || !TR0 || !EX0 || !EX1) {
+        printf("设置模式中保存没有补足备用扇区（擦除 %lu 次）或 Timer0 停止\n", Test_Erases() - erases);
+        ok = 0;
+    }
+    Test_Command(17, 4);
+    Hal_Reset();
+    System_Init();
+    if (g_time_green != 17 || g_time_yellow != 4) {
+        printf("补足备用扇区后远程命令保存、重新上电配时 %u/%u\n", g_time_green, g_time_yellow);
+        ok = 0;
+    }
+    return ok;
+}
+
+/**
+ * @brief  磨损均衡与序号回绕
+ */
+static int Test_Wear(void)
+{
+    unsigned long n;
+    unsigned long boots = 0;
+    unsigned long wrong = 0;
+    unsigned long next = 1;
+    unsigned long total = 0;
+    unsigned long lo = ~0UL;
+    unsigned long hi = 0;
+    unsigned long other = 0;
+    unsigned char g = 0;
+    unsigned char y = 0;
+    unsigned char s;
+    int ok;
+
+    IapHost_Init();
+    Test_Boot();
+    for (n = 1; n <= WEAR_SAVES; n++) {
+        Test_SaveRandom();
+        g = g_time_green;
+        y = g_time_yellow;
+        if (n == next) {
+            boots++;
+            if (!Test_Boot() || g_time_green != g || g_time_yellow != y) {
+                wrong++;
+            }
+            next = n + 1 + Test_Rand(BOOT_GAP);
+        }
+    }
+
+    for (s = 0; s < IAP_HOST_SECTORS; s++) {
+        if (s < EEPROM_SECTORS) {
+            total += iapHostErases[s];
+            lo = iapHostErases[s] < lo ? iapHostErases[s] : lo;
+            hi = iapHostErases[s] > hi ? iapHostErases[s] : hi;
+        } else {
+            other += iapHostErases[s];
+        }
+    }
+    ok = !wrong && hi - lo <= 1 && !other && !iapHostOverwrites && !iapHostBadAddr && !eepromFails &&
+         total <= WEAR_SAVES / EE_SLOTS + 1;
+    printf("配时存储磨损: 保存 %lu 次（序号回绕）, 上电 %lu 次恢复错误 %lu, "
+           "扇区擦除 %lu~%lu 次（每次擦除保存 %.1f 次）, 改写未擦除字节 %lu  %s\n",
+           WEAR_SAVES, boots, wrong, lo, hi, (double)WEAR_SAVES / total, iapHostOverwrites,
+           ok ? "通过" : "失败");
+    return ok;
+}
+
+/**
+ * @brief  保存或上电预擦除途中随机掉电
+ */
+static int Test_PowerFail(void)
+{
+    unsigned long trials;
+    unsigned long downs = 0;
+    unsigned long bootDowns = 0;
+    unsigned long wrong = 0;
+    unsigned char g;
+    unsigned char y;
+    int ok;
+
+    IapHost_Init();
+    Test_Boot();
+    Test_SaveRandom();
+    g = g_time_green;
+    y = g_time_yellow;
+
+    for (trials = 0; trials < FAIL_TRIALS; trials++) {
+        // 一条记录最多8次编程，换扇区、补足备用扇区时各加一次擦除；
+        // 记录写完后在补足备用扇区时掉电，记录仍然有效（保存返回1）
+        IapHost_FailAfter((long)Test_Rand(EE_REC_SIZE + 2));
+        if (Test_SaveRandom()) {
+            g = g_time_green;
+            y = g_time_yellow;
+        }
+        if (iapHostDown) {
+            downs++;
+        }
+        IapHost_PowerUp();
+
+        // 偶尔在上电预擦除时再掉电一次（没有要擦除的扇区时不会掉电）
+        if (Test_Rand(4) == 0) {
+            IapHost_FailAfter(0);
+            Test_Boot();
+            if (iapHostDown) {
+                bootDowns++;
+            }
+            IapHost_PowerUp();
+        }
+        if (!Test_Boot() || g_time_green != g || g_time_yellow != y) {
+            printf("第 %lu 次掉电后恢复 %u/%u，应为 %u/%u\n", trials, g_time_green, g_time_yellow, g, y);
+            wrong++;
+        }
+    }
+    ok = !wrong && downs && bootDowns && !iapHostOverwrites;
+    printf("配时存储掉电: %lu 次保存中途掉电 %lu 次, 上电擦除中途掉电 %lu 次, 恢复错误 %lu, "
+           "改写未擦除字节 %lu  %s\n",
+           (unsigned long)FAIL_TRIALS, downs, bootDowns, wrong, iapHostOverwrites, ok ? "通过" : "失败");
+    return ok;
+}
+
+/**
+ * @brief  上电扫描的读取量：各扇区写满、最新记录在最后一个扇区末尾
+ */
+static int Test_ScanCost(void)
+{
+    unsigned long reads;
+    unsigned long n;
+    unsigned long bound = EEPROM_SECTORS * (unsigned long)EEPROM_SECTOR_SIZE + EEPROM_SECTORS * EE_REC_SIZE;
+    int ok;
+
+    IapHost_Init();
+    Test_Boot();
+    for (n = 0; n < (unsigned long)EEPROM_SECTORS * EE_SLOTS; n++) {
+        Test_SaveRandom();
+    }
+    reads = iapHostReads;
+    Test_Boot();
+    reads = iapHostReads - reads;
+    ok = reads <= bound;
+    printf("配时存储上电扫描: %u 个扇区写满时读取 %lu 字节（上限 %lu）  %s\n",
+           EEPROM_SECTORS, reads, bound, ok ? "通过" : "失败");
+    return ok;
+}
+
+int main(void)
+{
+    int ok = 1;
+
+    halWriteHook = Test_WriteHook;
+
+    if (!Test_System()) {
+        printf("配时存储上电恢复  失败\n");
+        ok = 0;
+    } else {
+        printf("配时存储上电恢复: 空白闪存默认配时, 按键/远程命令保存后重新上电恢复, 运行中不擦除、备用扇区用完回复忙  通过\n");
+    }
+    ok &= Test_Wear();
+    ok &= Test_PowerFail();
+    ok &= Test_ScanCost();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,481 @@
+/**************************************************
+ * 文件名:    test_emergency.cpp
+ * 作者:
+ * 日期:      2025-10-15
+ * 描述:      紧急优先测试（主机，各相位方案分别构建）
+ *           触发方式与硬件相同：置位 IE0/IE1 作为锁存的下降沿，
+ *           只要 EA 与 EX0/EX1 允许就在下一次SFR写入处调用中断函数。
+ *           触发点随机落在Timer0中断内部第0-40次SFR写入处，覆盖相位切换、闪烁异或、
+ *           灯输出临界区等各处被高优先级中断打断的情况。每次P2/P0写入都检查：
+ *           - 两个方向不同时放行（绿/黄），左转箭头/行人绿灯亮时机动车全红
+ *           - 每个方向只有 绿→黄→红→绿 的变化，黄灯不短于该方向黄灯相位的时长
+ *           - 请求中断返回时对向已经没有绿灯、左转箭头与行人绿灯已熄灭（无需等待节拍）
+ *           - 紧急绿灯前全红清空不短于 ALL_RED_TIME，从触发到放行不超过上限
+ *           - 请求撤销后绿灯再保持 EMERGENCY_EXTEND_TIME，然后从该方向黄灯接回相位表
+ *           - 紧急优先期间不能进入设置模式，设置模式期间的请求被丢弃
+ *           - 远程修改配时、保存到 EEPROM（IAP 模型 iap_host.cpp）途中到来的请求：
+ *             最多等一次 IAP 操作就被响应，紧急请求中断允许时从不擦除扇区
+ **************************************************/
+
+#include <stdio.h>
+
+#define main firmware_main
+#include "../main.c"
+#undef main
+
+#include "iap_host.h"
+
+void Timer0_ISR(void);
+void Emergency_NsISR(void);
+void Emergency_EwISR(void);
+
+#define DIR_NS    0    // 方向下标（与 Phase_Countdown() 的 dir 相同）
+#define DIR_EW    1
+#define P0_ADDR   0x80
+#define P2_ADDR   0xA0
+#define SCENARIOS 400
+#define SAVE_SCENARIOS 150      // 多于空白闪存上两个扇区的记录数：之后的远程修改需要擦除，应回复忙
+#define SAVE_WRITES    200      // 一次保存的SFR写入次数的量级（每次 IAP 操作约9次）
+
+#define COLOR_NONE   0
+#define COLOR_RED    1
+#define COLOR_YELLOW 2
+#define COLOR_GREEN  3
+
+#if PHASE_PLAN == PHASE_PLAN_FULL
+#define MOVING_AUX (AUX_NS_LEFT | AUX_EW_LEFT | AUX_PED_WALK)
+#else
+#define MOVING_AUX 0
+#endif
+
+/*-----------------------仿真状态-----------------------------*/
+static unsigned long nowTick = 0;
+static unsigned char inHook = 0;
+static unsigned long writeIndex = 0;          // SFR写入序号
+static unsigned long triggerAt = 0xFFFFFFFFUL; // 在第几次写入处锁存下降沿
+static unsigned char triggerDir = DIR_NS;
+static unsigned char inSave = 0;              // 正在执行远程修改配时（含保存）
+static unsigned long saveTriggers = 0;        // 在保存途中锁存的请求
+static unsigned long saveRefused = 0;         // 备用扇区用完、回复忙的远程修改
+static unsigned long iapPending = 0;          // 请求已锁存、尚未响应期间执行的 IAP 操作数
+static unsigned long iapPendingMax = 0;
+static unsigned long serviceErases = 0;       // 紧急请求中断允许时的擦除
+
+/*-----------------------安全监视-----------------------------*/
+static unsigned char lastColor[2] = {COLOR_RED, COLOR_RED};
+static unsigned long colorSince[2] = {0, 0};
+static unsigned long lastMoving[2] = {0, 0};  // 各方向（含该方向左转/行人）最后一次放行的节拍
+static unsigned long conflicts = 0;           // 同时放行
+static unsigned long illegal = 0;             // 非法灯色变化（绿→红、黄→绿、同方向多灯）
+static unsigned long shortYellow = 0;         // 黄灯过短
+static unsigned long isrLeftConflict = 0;     // 请求中断返回时仍有冲突放行
+static unsigned char yellowSec[2];            // 各方向黄灯相位时长（秒）
+
+/*-----------------------本次紧急优先-------------------------*/
+static unsigned char watchDir = 0xFF;         // 正在检查的请求方向
+static unsigned long triggerTick = 0;
+static unsigned char startGreen = 0;          // 触发时请求方向已在放行
+static unsigned long greenTick = 0;           // 紧急绿灯开始（0=尚未放行）
+static unsigned long greenEndTick = 0;        // 紧急绿灯结束
+static unsigned long shortAllRed = 0;         // 紧急绿灯前清空过短
+static unsigned long maxToGreen = 0;          // 触发到放行的最长节拍数
+
+static unsigned char Test_Color(unsigned char lamps, unsigned char dir)
+{
+    unsigned char bits = (unsigned char)((dir == DIR_NS ? lamps : lamps >> 3) & 0x07);
+
+    switch (bits) {
+        case 0x00: return COLOR_NONE;       // 闪烁熄灭的半秒
+        case 0x01: return COLOR_RED;
+        case 0x02: return COLOR_YELLOW;
+        case 0x04: return COLOR_GREEN;
+        default:   illegal++; return COLOR_NONE;
+    }
+}
+
+static unsigned char Test_AuxMoving(unsigned char aux, unsigned char dir)
+{
+#if PHASE_PLAN == PHASE_PLAN_FULL
+    // 行人通行与两个方向都冲突
+    return (aux & AUX_PED_WALK) || (aux & (dir == DIR_NS ? AUX_NS_LEFT : AUX_EW_LEFT));
+#else
+    (void)aux;
+    (void)dir;
+    return 0;
+#endif
+}
+
+/**
+ * @brief  检查当前灯输出（每次P2/P0写入后调用）
+ */
+static void Test_Check(void)
+{
+    unsigned char lamps = P2 & LAMP_MASK;
+    unsigned char aux = P0 & AUX_MASK;
+    unsigned char moving[2];
+    unsigned char d;
+
+    for (d = 0; d < 2; d++) {
+        unsigned char c = Test_Color(lamps, d);
+
+        moving[d] = (c == COLOR_GREEN || c == COLOR_YELLOW);
+        if (c != COLOR_NONE && c != lastColor[d]) {
+            if ((lastColor[d] == COLOR_GREEN && c == COLOR_RED) ||
+                (lastColor[d] == COLOR_YELLOW && c == COLOR_GREEN)) {
+                illegal++;
+            }
+            if (lastColor[d] == COLOR_YELLOW && c == COLOR_RED &&
+                nowTick - colorSince[d] + 1 < (unsigned long)yellowSec[d] * TIMEBASE_SEC_TICKS) {
+                shortYellow++;
+            }
+            // 紧急绿灯：此前冲突方向的放行（含黄灯、左转、行人）必须已清空 ALL_RED_TIME
+            if (d == watchDir && c == COLOR_GREEN && !greenTick) {
+                greenTick = nowTick;
+                if (nowTick - lastMoving[d ^ 1] + 1 < (unsigned long)ALL_RED_TIME * TIMEBASE_SEC_TICKS) {
+                    shortAllRed++;
+                }
+            }
+            if (d == watchDir && lastColor[d] == COLOR_GREEN && triggerTick && greenTick && !greenEndTick) {
+                greenEndTick = nowTick;
+            }
+            lastColor[d] = c;
+            colorSince[d] = nowTick;
+        }
+    }
+    for (d = 0; d < 2; d++) {
+        if (moving[d] || Test_AuxMoving(aux, d)) {
+            lastMoving[d] = nowTick;
+        }
+    }
+    if (moving[DIR_NS] && moving[DIR_EW]) {
+        conflicts++;
+    }
+    if ((aux & MOVING_AUX) && (moving[DIR_NS] || moving[DIR_EW])) {
+        conflicts++;
+    }
+}
+
+/**
+ * @brief  按硬件规则响应锁存的外部中断（EA、EXn 允许且不在中断中）
+ */
+static void Test_Dispatch(void)
+{
+    unsigned char dir;
+    unsigned char watching;
+
+    for (dir = 0; dir < 2; dir++) {
+        unsigned char pending = dir == DIR_NS ? IE0 : IE1;
+        unsigned char enabled = dir == DIR_NS ? EX0 : EX1;
+
+        if (!pending || !enabled || !EA) {
+            continue;
+        }
+        // 边沿触发：响应时硬件清除标志
+        watching = emgStage == EMG_IDLE && !emgRequest;
+        if (dir == DIR_NS) {
+            IE0 = 0;
+            Emergency_NsISR();
+        } else {
+            IE1 = 0;
+            Emergency_EwISR();
+        }
+        iapPending = 0;
+        // 中断返回时对向绿灯、左转箭头、行人绿灯必须已经熄灭
+        if (watching && ((P2 & (dir == DIR_NS ? LAMP_EW_GREEN : LAMP_NS_GREEN)) || (P0 & MOVING_AUX & AUX_MASK))) {
+            isrLeftConflict++;
+        }
+        Test_Check();
+    }
+}
+
+/**
+ * @brief  转发给 IAP 模型：CPU在操作期间暂停，统计请求等待的操作数和运行中的擦除
+ */
+static void Test_Iap(unsigned char addr, unsigned char value)
+{
+    unsigned long ops = iapHostReads + iapHostPrograms;
+    unsigned long erases = 0;
+    unsigned char s;
+
+    for (s = 0; s < IAP_HOST_SECTORS; s++) {
+        erases += iapHostErases[s];
+    }
+    IapHost_Write(addr, value);
+    for (s = 0; s < IAP_HOST_SECTORS; s++) {
+        erases -= iapHostErases[s];
+    }
+    if (erases && (EX0 || EX1)) {
+        serviceErases++;
+    }
+    if ((iapHostReads + iapHostPrograms != ops || erases) && EA && ((IE0 && EX0) || (IE1 && EX1))) {
+        if (++iapPending > iapPendingMax) {
+            iapPendingMax = iapPending;
+        }
+    }
+}
+
+static void Test_WriteHook(unsigned char addr, unsigned char value)
+{
+    if (inHook) {
+        return;
+    }
+    inHook = 1;
+    if (writeIndex++ == triggerAt) {
+        saveTriggers += inSave;
+        // 检测器拉低请求线：锁存下降沿
+        triggerAt = 0xFFFFFFFFUL;
+        triggerTick = nowTick;
+        startGreen = lastColor[triggerDir] == COLOR_GREEN;
+        if (startGreen) {
+            greenTick = nowTick;    // 不检查清空，只检查保持与接回
+        }
+        if (triggerDir == DIR_NS) {
+            EMERGENCY_NS_PIN = 0;
+            IE0 = 1;
+        } else {
+            EMERGENCY_EW_PIN = 0;
+            IE1 = 1;
+        }
+    }
+    // 写入 IAP_TRIG 启动的操作在响应已锁存的请求之前执行完（CPU暂停）
+    Test_Iap(addr, value);
+    if (addr == P2_ADDR || addr == P0_ADDR) {
+        Test_Check();
+    }
+    Test_Dispatch();
+    inHook = 0;
+}
+
+/**
+ * @brief  执行一个Timer0节拍并处理主循环事件
+ */
+static void Test_Tick(void)
+{
+    nowTick++;
+    TH0 = 0;
+    TL0 = 0;
+    Timer0_ISR();
+    Main_Poll();
+}
+
+/*-----------------------随机数-------------------------------*/
+static unsigned long rngState = 2025;
+
+static unsigned long Test_Rand(unsigned long n)
+{
+    rngState = rngState * 1103515245UL + 12345UL;
+    return (rngState >> 16) % n;
+}
+
+/**
+ * @brief  经串口命令接收状态机送入一条 SET_PLAN 并执行（只改绿灯：黄灯时长检查不变）
+ */
+static void Test_SetGreen(void)
+{
+    unsigned char frame[6] = { TLM_SYNC, CMD_SET_PLAN, 2, 0, g_time_yellow, 0 };
+    unsigned char i;
+
+    do {
+        frame[3] = (unsigned char)(MIN_LIGHT_TIME + Test_Rand(MAX_LIGHT_TIME - MIN_LIGHT_TIME + 1));
+    } while (frame[3] == g_time_green);
+    for (i = 1; i < 5; i++) {
+        frame[5] = Uart_Crc8(frame[5], frame[i]);
+    }
+    inSave = 1;
+    for (i = 0; i < 6; i++) {
+        Command_RxByte(frame[i]);
+    }
+    Command_Poll();
+    inSave = 0;
+    saveRefused += g_time_green != frame[3];
+}
+
+/**
+ * @brief  一次紧急请求：随机时刻、随机中断打断点，请求线保持 holdTicks 后撤销
+ * @param  duringSave: 1=先执行远程修改配时，请求在其保存途中随机的SFR写入处到来
+ * @retval 1=时序符合要求
+ */
+static int Test_Scenario(unsigned char dir, unsigned long holdTicks, unsigned long boundTicks,
+                         unsigned char duringSave)
+{
+    unsigned long t;
+    unsigned long releaseTick = 0;
+    unsigned long limit;
+
+    watchDir = dir;
+    greenTick = 0;
+    greenEndTick = 0;
+    triggerDir = dir;
+    triggerTick = 0;
+    if (duringSave) {
+        triggerAt = writeIndex + Test_Rand(SAVE_WRITES);
+        Test_SetGreen();
+    } else {
+        triggerAt = writeIndex + Test_Rand(40);
+    }
+
+    limit = nowTick + boundTicks + holdTicks + 10UL * TIMEBASE_SEC_TICKS;
+    while (nowTick < limit) {
+        Test_Tick();
+        if (triggerTick && !releaseTick && nowTick - triggerTick >= holdTicks) {
+            releaseTick = nowTick;
+            if (dir == DIR_NS) {
+                EMERGENCY_NS_PIN = 1;
+            } else {
+                EMERGENCY_EW_PIN = 1;
+            }
+        }
+        if (greenEndTick) {
+            break;
+        }
+    }
+    watchDir = 0xFF;
+
+    if (!triggerTick || !greenEndTick) {
+        printf("方向 %u: 没有完成紧急放行（触发 %lu，绿灯 %lu）\n", dir, triggerTick, greenTick);
+        return 0;
+    }
+    if (!startGreen) {
+        t = greenTick - triggerTick;
+        if (t > maxToGreen) {
+            maxToGreen = t;
+        }
+        if (t > boundTicks) {
+            printf("方向 %u: 触发后 %lu 个节拍才放行（上限 %lu）\n", dir, t, boundTicks);
+            return 0;
+        }
+    }
+    // 撤销后的保持：撤销发生在两个秒边界之间，保持 (EXTEND-1, EXTEND] 秒
+    t = greenEndTick - (releaseTick > greenTick ? releaseTick : greenTick);
+    if (t + TIMEBASE_SEC_TICKS < (unsigned long)EMERGENCY_EXTEND_TIME * TIMEBASE_SEC_TICKS ||
+        t > (unsigned long)(EMERGENCY_EXTEND_TIME + 1) * TIMEBASE_SEC_TICKS) {
+        printf("方向 %u: 撤销后绿灯保持 %lu 个节拍\n", dir, t);
+        return 0;
+    }
+    // 从请求方向的黄灯接回相位表
+    if (emgStage != EMG_IDLE || Test_Color(P2 & LAMP_MASK, dir) != COLOR_YELLOW ||
+        Phase_Countdown(currentState, dir, timeLeft) != timeLeft) {
+        printf("方向 %u: 结束后没有接回黄灯相位（相位 %u 灯 %02X）\n", dir, currentState, P2 & LAMP_MASK);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief  设置模式与紧急优先互斥
+ */
+static int Test_SettingMode(void)
+{
+    unsigned char lamps;
+    unsigned char i;
+    int ok = 1;
+
+    // 紧急优先进行中：SET键不进入设置模式
+    triggerDir = DIR_EW;
+    triggerAt = writeIndex;
+    Test_Tick();
+    EMERGENCY_EW_PIN = 1;
+    if (emgStage == EMG_IDLE || Keys_Handle(EVT_KEY_SET) || g_isSettingMode) {
+        printf("紧急优先期间进入了设置模式\n");
+        ok = 0;
+    }
+    while (emgStage != EMG_IDLE || emgRequest) {
+        Test_Tick();
+    }
+
+    // 设置模式中：请求被屏蔽，退出时丢弃
+    Keys_Handle(EVT_KEY_SET);
+    lamps = P2 & LAMP_MASK;
+    IE0 = 1;
+    Test_Tick();
+    if (!g_isSettingMode || (P2 & LAMP_MASK) != lamps || emgRequest) {
+        printf("设置模式中响应了紧急请求\n");
+        ok = 0;
+    }
+    for (i = 0; i < 3; i++) {
+        Keys_Handle(EVT_KEY_SET);
+    }
+    Test_Tick();
+    if (g_isSettingMode || emgRequest || emgStage != EMG_IDLE || !EX0 || !EX1) {
+        printf("退出设置模式后紧急请求状态不正确\n");
+        ok = 0;
+    }
+    return ok;
+}
+
+int main(void)
+{
+    unsigned long cycleTicks;
+    unsigned long boundTicks;
+    unsigned long maxHold = 0;
+    unsigned int n;
+    unsigned int served[2] = {0, 0};
+    int ok = 1;
+
+    Hal_Reset();
+    IapHost_Init();
+    halWriteHook = Test_Iap;
+    System_Init();
+    yellowSec[DIR_NS] = g_time_yellow;
+    yellowSec[DIR_EW] = g_time_yellow;
+    halWriteHook = Test_WriteHook;
+
+    // 触发到放行的上限：新开始的黄灯/清空按秒边界计数多1秒
+    boundTicks = (unsigned long)(g_time_yellow + 1 + (PED_CLEAR_TIME > ALL_RED_TIME ? PED_CLEAR_TIME : ALL_RED_TIME) + 1)
+                 * TIMEBASE_SEC_TICKS;
+    cycleTicks = (unsigned long)phaseStart[PHASE_COUNT] * TIMEBASE_SEC_TICKS;
+
+    for (n = 0; n < SCENARIOS; n++) {
+        unsigned long wait = Test_Rand(cycleTicks);
+        unsigned long hold = Test_Rand(8UL * TIMEBASE_SEC_TICKS);
+        unsigned char dir = (unsigned char)Test_Rand(2);
+
+        while (wait--) {
+            Test_Tick();
+        }
+        if (!Test_Scenario(dir, hold, boundTicks, 0)) {
+            ok = 0;
+            break;
+        }
+        served[dir]++;
+        if (hold > maxHold) {
+            maxHold = hold;
+        }
+    }
+
+    // 保存配时途中到来的请求
+    for (n = 0; ok && n < SAVE_SCENARIOS; n++) {
+        unsigned long wait = Test_Rand(cycleTicks);
+
+        while (wait--) {
+            Test_Tick();
+        }
+        if (!Test_Scenario((unsigned char)Test_Rand(2), Test_Rand(4UL * TIMEBASE_SEC_TICKS), boundTicks, 1)) {
+            ok = 0;
+        }
+    }
+    if (saveTriggers < SAVE_SCENARIOS / 2 || iapPendingMax > 1 || serviceErases || eepromFails) {
+        ok = 0;
+    }
+    printf("相位方案 %u 保存配时途中的紧急请求: %lu 次, 响应前最多等待 %lu 次 IAP 操作（上限1）, "
+           "运行中擦除 %lu, 保存失败 %u, 备用扇区用完回复忙 %lu  %s\n",
+           PHASE_PLAN, saveTriggers, iapPendingMax, serviceErases, eepromFails, saveRefused,
+           ok ? "通过" : "失败");
+
+    ok &= Test_SettingMode();
+
+    // 之后相位表照常运行两个周期
+    for (n = 0; n < 2 * cycleTicks; n++) {
+        Test_Tick();
+    }
+
+    if (conflicts || illegal || shortYellow || isrLeftConflict || shortAllRed) {
+        ok = 0;
+    }
+    printf("相位方案 %u 紧急优先: 南北 %u 次 东西 %u 次, 触发到放行最长 %.2fs (上限 %.2fs), "
+           "中断返回后冲突 %lu, 冲突放行 %lu, 非法变化 %lu, 黄灯过短 %lu, 清空过短 %lu  %s\n",
+           PHASE_PLAN, served[DIR_NS], served[DIR_EW],
+           (double)maxToGreen / TIMEBASE_SEC_TICKS, (double)boundTicks / TIMEBASE_SEC_TICKS,
+           isrLeftConflict, conflicts, illegal, shortYellow, shortAllRed, ok ? "通过" : "失败");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+/**************************************************
+ * 文件名:    test_keys.cpp
+ * 作者:
+ * 日期:      2025-10-12
+ * 描述:      按键消抖与长按自动重复测试（主机）
+ *           以0.1ms为步长生成带抖动的按键波形驱动P0，与节拍任务调度相同每 KEY_SAMPLE_TICKS 个节拍调用 Keys_Tick()，
+ *           记录投递的事件及其时刻，检查：
+ *           - 每次按下（含0-20ms随机抖动）恰好产生一个事件，松开不产生事件
+ *           - 从第一次接触到事件的延迟不超过100ms
+ *           - 短于一个采样周期的干扰脉冲不产生事件
+ *           - 长按增加键，从1调到99（98个事件）用时少于2秒
+ **************************************************/
+
+#include <stdio.h>
+
+#include "../keys.c"
+
+#define STEP_US       100                  // 波形时间分辨率
+#define LATENCY_MAX   100000UL             // 按下到动作的最大延迟（us）
+#define LONG_PRESS_MAX 2000000UL           // 1→99 的最长用时（us）
+
+/*-----------------------事件记录-----------------------------*/
+static unsigned long nowUs = 0;            // 当前仿真时间
+static unsigned int eventCount[8];
+static unsigned long lastEventUs = 0;
+
+void Event_Post(unsigned char evt)
+{
+    if (evt < 8) {
+        eventCount[evt]++;
+    }
+    lastEventUs = nowUs;
+}
+
+static void Test_ClearEvents(void)
+{
+    unsigned char i;
+    for (i = 0; i < 8; i++) {
+        eventCount[i] = 0;
+    }
+}
+
+/*-----------------------波形生成-----------------------------*/
+static unsigned long rngState = 12345;
+
+static unsigned int Test_Rand(unsigned int n)
+{
+    rngState = rngState * 1103515245UL + 12345UL;
+    return (unsigned int)((rngState >> 16) % n);
+}
+
+/**
+ * @brief  保持当前引脚电平运行一段时间，每个采样周期调用一次 Keys_Tick()
+ */
+static void Test_Run(unsigned long us)
+{
+    unsigned long end = nowUs + us;
+    while (nowUs < end) {
+        nowUs += STEP_US;
+        if (nowUs % (TICK_US * KEY_SAMPLE_TICKS) == 0) {
+            Keys_Tick();
+        }
+    }
+}
+
+/**
+ * @brief  设置某个键的电平（按下=0）
+ */
+static void Test_SetKey(unsigned char keyBit, int down)
+{
+    if (down) {
+        P0 = (unsigned char)(P0 & ~keyBit);
+    } else {
+        P0 = (unsigned char)(P0 | keyBit);
+    }
+}
+
+/**
+ * @brief  抖动：在 bounceUs 内随机翻转电平，最后停在 finalDown
+ */
+static void Test_Bounce(unsigned char keyBit, unsigned long bounceUs, int finalDown)
+{
+    unsigned long end = nowUs + bounceUs;
+    int down = finalDown;
+    while (nowUs + STEP_US < end) {
+        down = !down;
+        Test_SetKey(keyBit, down);
+        Test_Run((unsigned long)(Test_Rand(10) + 1) * STEP_US);
+    }
+    Test_SetKey(keyBit, finalDown);
+}
+
+/*-----------------------测试项-------------------------------*/
+
+/**
+ * @brief  带抖动的短按：每次恰好一个事件，延迟不超过100ms
+ */
+static int Test_BouncyPresses(unsigned char keyBit, unsigned char evt, unsigned long *maxLatency)
+{
+    int n;
+    int ok = 1;
+
+    for (n = 0; n < 200; n++) {
+        unsigned long pressUs;
+        unsigned long bounce = (unsigned long)Test_Rand(201) * STEP_US;   // 0-20ms
+
+        Test_ClearEvents();
+        Test_Run((unsigned long)Test_Rand(100) * STEP_US);                // 随机相位
+        pressUs = nowUs;
+        Test_Bounce(keyBit, bounce, 1);
+        Test_Run(150000);                                                  // 按住150ms
+        if (eventCount[evt] == 1 && lastEventUs - pressUs > *maxLatency) {
+            *maxLatency = lastEventUs - pressUs;
+        }
+        Test_Bounce(keyBit, (unsigned long)Test_Rand(201) * STEP_US, 0);
+        Test_Run(150000);                                                  // 松开150ms
+
+        if (eventCount[evt] != 1) {
+            printf("第%d次按下（抖动%.1fms）产生 %u 个事件\n", n, bounce / 1000.0, eventCount[evt]);
+            ok = 0;
+        }
+    }
+    return ok && *maxLatency <= LATENCY_MAX;
+}
+
+/**
+ * @brief  干扰脉冲（1-8ms）不产生事件
+ */
+static int Test_Glitches(void)
+{
+    int n;
+
+    Test_ClearEvents();
+    for (n = 0; n < 200; n++) {
+        Test_SetKey(KEY_BIT_SET, 1);
+        Test_Run((unsigned long)(Test_Rand(71) + 10) * STEP_US);
+        Test_SetKey(KEY_BIT_SET, 0);
+        Test_Run(50000);
+    }
+    if (eventCount[EVT_KEY_SET] != 0) {
+        printf("干扰脉冲产生了 %u 个事件\n", eventCount[EVT_KEY_SET]);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief  长按增加键：第98个事件（1→99）出现的时刻
+ */
+static unsigned long Test_LongPress(void)
+{
+    unsigned long pressUs;
+
+    Test_ClearEvents();
+    Test_Run(100000);
+    pressUs = nowUs;
+    Test_Bounce(KEY_BIT_UP, 5000, 1);
+    while (eventCount[EVT_KEY_UP] < 98 && nowUs - pressUs < 10000000UL) {
+        Test_Run(STEP_US);
+    }
+    Test_SetKey(KEY_BIT_UP, 0);
+    Test_Run(200000);
+    return nowUs - pressUs - 200000;
+}
+
+int main(void)
+{
+    unsigned long latencySet = 0;
+    unsigned long latencyUp = 0;
+    unsigned long longPressUs;
+    int ok = 1;
+
+    P0 = 0xFF;      // 全部松开
+    Test_Run(100000);
+
+    ok &= Test_BouncyPresses(KEY_BIT_SET, EVT_KEY_SET, &latencySet);
+    ok &= Test_BouncyPresses(KEY_BIT_UP, EVT_KEY_UP, &latencyUp);
+    ok &= Test_Glitches();
+    longPressUs = Test_LongPress();
+    ok &= longPressUs < LONG_PRESS_MAX;
+
+    printf("按键: 最大延迟 SET %.1fms / UP %.1fms (上限 %.0fms)  长按1→99 %.2fs (上限 %.1fs)  %s\n",
+           latencySet / 1000.0, latencyUp / 1000.0, LATENCY_MAX / 1000.0,
+           longPressUs / 1e6, LONG_PRESS_MAX / 1e6, ok ? "通过" : "失败");
+    return ok ? 0 : 1;
+}
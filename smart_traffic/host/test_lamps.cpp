@@ -0,0 +1,234 @@
+/**************************************************
+ * 文件名:    test_lamps.cpp
+ * 作者:
+ * 日期:      2025-10-11
+ * 描述:      灯输出无毛刺测试（主机）
+ *           通过SFR写钩子记录P2的每一次写入，检查：
+ *           - 初始化完成后任何一次写入都不会让六个灯全灭
+ *           - 每次相位切换只产生一次改变灯位的写入；设置模式保持当前相位的灯色（补回闪烁熄灭的灯）
+ *           - 改变灯位的写入不会同时改变数码管位选P2.6/P2.7
+ *           - 闪烁：放行灯（绿/黄、左转箭头、行人绿）在相位最后 FLASH_START_TIME 秒内
+ *             每秒熄灭半秒，熄灭段恰好 HALF_SECOND_TICKS 个节拍并结束在秒边界上
+ *           覆盖Timer0中断驱动的相位切换（含数码管扫描交错）以及设置模式进出
+ **************************************************/
+
+#include <stdio.h>
+
+#define main firmware_main
+#include "../main.c"
+#undef main
+
+void Timer0_ISR(void);
+
+#define P2_ADDR  0xA0
+#define COM_MASK 0xC0
+
+static unsigned char lastP2;
+static unsigned long allOffCount = 0;     // 六个灯全灭的写入次数
+static unsigned long lampWriteCount = 0;  // 改变灯位的写入次数
+static unsigned long mixedCount = 0;      // 同时改变灯位和位选的写入次数
+
+static void Test_WriteHook(unsigned char addr, unsigned char value)
+{
+    unsigned char changed;
+
+    if (addr != P2_ADDR) {
+        return;
+    }
+    changed = (unsigned char)(value ^ lastP2);
+    if ((value & LAMP_MASK) == 0) {
+        allOffCount++;
+    }
+    if (changed & LAMP_MASK) {
+        lampWriteCount++;
+        if (changed & COM_MASK) {
+            mixedCount++;
+        }
+    }
+    lastP2 = value;
+}
+
+/**
+ * @brief  执行一个Timer0节拍（与 sim.cpp 相同：计数器回到0后进入中断）
+ */
+static void Test_Tick(void)
+{
+    TH0 = 0;
+    TL0 = 0;
+    Timer0_ISR();
+}
+
+#define MOVING_LAMPS (LAMP_NS_GREEN | LAMP_NS_YELLOW | LAMP_EW_GREEN | LAMP_EW_YELLOW)
+#if PHASE_PLAN == PHASE_PLAN_FULL
+#define MOVING_AUX   (AUX_NS_LEFT | AUX_EW_LEFT | AUX_PED_WALK)
+#else
+#define MOVING_AUX   0
+#endif
+
+/**
+ * @brief  闪烁检查：运行两个周期，以每个相位第一个节拍的输出为基准，
+ *         熄灭的位只能是基准中的放行灯，熄灭段长度和个数必须符合要求
+ * @retval 熄灭段总数（出错时返回0）
+ */
+static unsigned int Test_Flash(unsigned long cycleTicks)
+{
+    unsigned long ticks;
+    unsigned char baseLamps = P2 & LAMP_MASK;
+    unsigned char baseAux = P0 & AUX_MASK;
+    unsigned char phase = currentState;
+    unsigned int lastSecond = Get_SystemTime_s();
+    unsigned long offRun = 0;
+    unsigned int pulses = 0;      // 本相位的熄灭段数
+    unsigned int total = 0;
+    int ok = 1;
+
+    for (ticks = 0; ticks < 2 * cycleTicks; ticks++) {
+        unsigned char offLamps;
+        unsigned char offAux;
+        int secondEdge;
+
+        Test_Tick();
+        secondEdge = Get_SystemTime_s() != lastSecond;
+        lastSecond = Get_SystemTime_s();
+
+        if (currentState != phase) {
+            // 上一相位结束（也是秒边界）：最后一个熄灭段到此结束
+            unsigned int expect = 0;
+            if (offRun) {
+                if (offRun != HALF_SECOND_TICKS) {
+                    printf("相位 %u: 最后熄灭 %lu 个节拍\n", phase, offRun);
+                    ok = 0;
+                }
+                pulses++;
+                total++;
+            }
+            // 熄灭段数 = min(FLASH_START_TIME, 相位时长)，没有放行灯的相位为0
+            if ((baseLamps & MOVING_LAMPS) || (baseAux & MOVING_AUX)) {
+                expect = stateTimeTable[phase] < FLASH_START_TIME ? stateTimeTable[phase] : FLASH_START_TIME;
+            }
+            if (pulses != expect) {
+                printf("相位 %u: 熄灭段 %u 个，应为 %u\n", phase, pulses, expect);
+                ok = 0;
+            }
+            phase = currentState;
+            baseLamps = P2 & LAMP_MASK;
+            baseAux = P0 & AUX_MASK;
+            pulses = 0;
+            offRun = 0;
+            continue;
+        }
+
+        offLamps = (unsigned char)((P2 & LAMP_MASK) ^ baseLamps);
+        offAux = (unsigned char)((P0 & AUX_MASK) ^ baseAux);
+        if ((offLamps & ~(baseLamps & MOVING_LAMPS)) || (offAux & ~(baseAux & MOVING_AUX))) {
+            printf("相位 %u: 非放行灯位变化 %02X/%02X\n", phase, offLamps, offAux);
+            ok = 0;
+        }
+        if (offLamps || offAux) {
+            offRun++;
+        } else if (offRun) {
+            // 熄灭段结束：必须正好半秒，并且在秒边界恢复
+            if (offRun != HALF_SECOND_TICKS || !secondEdge) {
+                printf("相位 %u: 熄灭 %lu 个节拍（秒边界 %d）\n", phase, offRun, secondEdge);
+                ok = 0;
+            }
+            pulses++;
+            total++;
+            offRun = 0;
+        }
+    }
+    return ok ? total : 0;
+}
+
+/**
+ * @brief  检查一次操作只产生不超过一次灯位写入
+ */
+static int Test_Expect(const char *what, unsigned long before)
+{
+    if (lampWriteCount - before > 1) {
+        printf("%s 产生了 %lu 次灯位写入\n", what, lampWriteCount - before);
+        return 0;
+    }
+    return 1;
+}
+
+int main(void)
+{
+    unsigned long ticks;
+    unsigned long cycleTicks;
+    unsigned long before;
+    unsigned int transitions = 0;
+    unsigned char lastState;
+    unsigned int flashPulses;
+    unsigned char phaseLamps = 0;
+    unsigned long settingChanges = 0;
+    unsigned long k;
+    unsigned int n;
+    int ok = 1;
+
+    Hal_Reset();
+    System_Init();
+    lastP2 = P2;
+    halWriteHook = Test_WriteHook;
+
+    // 1. 中断驱动的相位切换：运行两个完整周期，每个节拍都伴随数码管扫描
+    cycleTicks = (unsigned long)phaseStart[PHASE_COUNT] * FOSC / TIMEBASE_TICK_CLKS + 1;
+    lastState = currentState;
+    before = lampWriteCount;
+    for (ticks = 0; ticks < 2 * cycleTicks; ticks++) {
+        Test_Tick();
+        if (currentState != lastState) {
+            ok &= Test_Expect("相位切换", before);
+            transitions++;
+            lastState = currentState;
+        }
+        before = lampWriteCount;
+    }
+    if (transitions < 2 * PHASE_COUNT) {
+        printf("相位切换次数不足: %u\n", transitions);
+        ok = 0;
+    }
+
+    // 2. 闪烁：与秒边界锁相，熄灭段只出现在放行灯上
+    flashPulses = Test_Flash(cycleTicks);
+    if (flashPulses == 0) {
+        ok = 0;
+    }
+
+    // 3. 设置模式：颜色只在数码管上指示，逐个颜色切换并运行3秒，灯色保持进入时的相位。
+    //    在闪烁熄灭的半秒进入，熄灭的灯须补回
+    lastState = PHASE_COUNT;
+    for (ticks = 0; ticks < 2 * cycleTicks; ticks++) {
+        Test_Tick();
+        if (currentState != lastState) {
+            lastState = currentState;
+            phaseLamps = P2 & LAMP_MASK;
+        } else if ((P2 & LAMP_MASK) != phaseLamps) {
+            break;
+        }
+    }
+    Keys_Handle(EVT_KEY_SET);
+    for (n = 0; n < 3; n++) {
+        for (k = 0; k < 3UL * TIMEBASE_SEC_TICKS; k++) {
+            Test_Tick();
+            if ((P2 & LAMP_MASK) != phaseLamps) {
+                settingChanges++;
+            }
+        }
+        Keys_Handle(EVT_KEY_SET);
+    }
+    if (ticks == 2 * cycleTicks || g_isSettingMode || currentState != lastState || settingChanges) {
+        printf("设置模式改变了灯色 %lu 次（相位 %u → %u）\n", settingChanges, lastState, currentState);
+        ok = 0;
+    }
+
+    if (allOffCount || mixedCount) {
+        ok = 0;
+    }
+
+    printf("相位方案 %d: 相位切换 %u 次, 灯位写入 %lu 次, 全灭 %lu 次, 灯位与位选同时改变 %lu 次, "
+           "闪烁熄灭段 %u 个  %s\n",
+           PHASE_PLAN, transitions, lampWriteCount, allOffCount, mixedCount, flashPulses,
+           ok ? "通过" : "失败");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,360 @@
+/**************************************************
+ * 文件名:    test_monitor.cpp
+ * 作者:
+ * 日期:      2025-10-16
+ * 描述:      冲突监视与看门狗测试（主机，各相位方案分别构建）
+ *           - 穷举：P2 灯位的全部64种组合（FULL方案再乘以P0.4-P0.7的16种），
+ *             逐个写到端口上运行一个节拍，按本文件独立写出的规则判断是否合法：
+ *             非法组合必须在同一节拍锁定故障并写出全红、行人红灯，合法组合不能误报
+ *           - 相位号越界锁定故障
+ *           - 故障后：红灯以1Hz亮灭、相位不再切换、紧急请求与按键不响应、照常喂狗
+ *           - 正常运行（相位切换、闪烁、设置模式进出）若干周期不误报
+ *           - 看门狗：主循环每次运行后下一节拍喂狗；主循环停住则不再喂狗，
+ *             溢出时间不短于 WDT_MIN_MS
+ **************************************************/
+
+#include <stdio.h>
+
+#define main firmware_main
+#include "../main.c"
+#undef main
+
+void Timer0_ISR(void);
+
+#define P2_ADDR 0xA0
+#define P0_ADDR 0x80
+
+/*-----------------------仿真状态-----------------------------*/
+static unsigned long nowTick = 0;
+static unsigned long wdtFeeds = 0;            // 喂狗次数
+static unsigned long wdtLastFeed = 0;         // 最后一次喂狗的节拍
+static unsigned long wdtMaxGap = 0;           // 两次喂狗的最长间隔（节拍）
+static unsigned char wdtBadValue = 0;         // 写入值不是 WDT_FEED
+
+static void Test_WriteHook(unsigned char addr, unsigned char value)
+{
+#if WDT_ENABLE
+    if (addr == WDT_CONTR_ADDR) {
+        if (value != WDT_FEED) {
+            wdtBadValue = 1;
+        }
+        if (wdtFeeds && nowTick - wdtLastFeed > wdtMaxGap) {
+            wdtMaxGap = nowTick - wdtLastFeed;
+        }
+        wdtFeeds++;
+        wdtLastFeed = nowTick;
+    }
+#else
+    (void)addr;
+    (void)value;
+#endif
+}
+
+/**
+ * @brief  执行一个Timer0节拍，mainRuns=1 时随后运行一次主循环
+ */
+static void Test_Tick(unsigned char mainRuns)
+{
+    nowTick++;
+    TH0 = 0;
+    TL0 = 0;
+    Timer0_ISR();
+    if (mainRuns) {
+        Main_Poll();
+    }
+}
+
+/**
+ * @brief  独立的合法性规则（与固件的兼容表分开实现）
+ * @param  lamps: P2 & LAMP_MASK
+ * @param  aux:   P0 & AUX_MASK（非FULL方案为0）
+ * @retval 1=合法
+ */
+static int Test_Legal(unsigned char lamps, unsigned char aux)
+{
+    unsigned char moving = 0;
+    unsigned char dark = 0;
+    unsigned char d;
+    unsigned char auxMoving = 0;
+
+    for (d = 0; d < 2; d++) {
+        unsigned char bits = (unsigned char)((lamps >> (3 * d)) & 0x07);
+
+        switch (bits) {
+            case 0x00: dark++;   break;     // 闪烁熄灭的半秒
+            case 0x01:           break;     // 红
+            case 0x02:                      // 黄
+            case 0x04: moving++; break;     // 绿
+            default:   return 0;            // 同一方向多灯
+        }
+    }
+    if (moving > 1 || dark > 1) {
+        return 0;
+    }
+    if (aux & AUX_NS_LEFT)  auxMoving++;
+    if (aux & AUX_EW_LEFT)  auxMoving++;
+    if (aux & AUX_PED_WALK) auxMoving++;
+    if (auxMoving > 1) {
+        return 0;                           // 两个左转或左转与行人同时放行
+    }
+    if ((aux & AUX_PED_WALK) && (aux & AUX_PED_STOP)) {
+        return 0;
+    }
+    if (auxMoving && moving) {
+        return 0;                           // 左转/行人放行时机动车必须全红
+    }
+    return 1;
+}
+
+/**
+ * @brief  清除故障并恢复正常运行（仅测试使用：固件中故障锁定到复位）
+ */
+static void Test_Recover(void)
+{
+    monFault = MON_OK;
+    g_isSettingMode = 0;
+    Emergency_Init();
+    SetTrafficLights(currentState);
+}
+
+/**
+ * @brief  故障状态检查：全红闪烁、相位不动、紧急请求和按键不响应
+ * @retval 1=符合要求
+ */
+static int Test_FaultBehaviour(void)
+{
+    unsigned char state = currentState;
+    unsigned char lamps;
+    unsigned char last;
+    unsigned int toggles = 0;
+    unsigned long feeds = wdtFeeds;
+    unsigned int n;
+    int ok = 1;
+
+    Emergency_Resume();
+    IE0 = 1;
+    IE1 = 1;
+    if (Keys_Handle(EVT_KEY_SET) || Keys_Handle(EVT_KEY_UP)) {
+        printf("故障后响应了按键\n");
+        ok = 0;
+    }
+    last = P2 & LAMP_MASK;
+    for (n = 0; n < 4 * TIMEBASE_SEC_TICKS; n++) {
+        Test_Tick(1);
+        lamps = P2 & LAMP_MASK;
+        if (lamps != LAMP_ALL_RED && lamps != 0) {
+            printf("故障后灯输出 %02X\n", lamps);
+            return 0;
+        }
+#if PHASE_PLAN == PHASE_PLAN_FULL
+        if ((P0 & AUX_MASK) != AUX_PED_STOP) {
+            printf("故障后扩展灯输出 %02X\n", P0 & AUX_MASK);
+            return 0;
+        }
+#endif
+        if (lamps != last) {
+            toggles++;
+            last = lamps;
+        }
+    }
+    // 4秒内每个半秒边界切换一次
+    if (toggles < 7 || toggles > 8) {
+        printf("故障后4秒红灯切换 %u 次\n", toggles);
+        ok = 0;
+    }
+    if (currentState != state || EX0 || EX1 || emgRequest || emgStage != EMG_IDLE) {
+        printf("故障后相位或紧急优先仍在运行\n");
+        ok = 0;
+    }
+#if WDT_ENABLE
+    if (wdtFeeds - feeds < 4UL * TIMEBASE_SEC_TICKS - 1) {
+        printf("故障后没有照常喂狗\n");
+        ok = 0;
+    }
+#else
+    (void)feeds;
+#endif
+    IE0 = 0;
+    IE1 = 0;
+    return ok;
+}
+
+/**
+ * @brief  穷举全部灯输出组合
+ * @retval 1=非法组合全部锁定、合法组合全部不误报
+ */
+static int Test_Exhaustive(unsigned int *illegalCount, unsigned int *legalCount)
+{
+#if PHASE_PLAN == PHASE_PLAN_FULL
+    const unsigned int auxCombos = (AUX_MASK >> 4) + 1;
+#else
+    const unsigned int auxCombos = 1;
+#endif
+    unsigned int lamps;
+    unsigned int a;
+    int ok = 1;
+    int behaviourChecked = 0;
+
+    for (a = 0; a < auxCombos; a++) {
+        for (lamps = 0; lamps <= LAMP_MASK; lamps++) {
+            unsigned char aux = (unsigned char)(a << 4);
+            unsigned char port;
+            int legal = Test_Legal((unsigned char)lamps, aux);
+
+            // 设置模式下Timer0不写灯，写到端口上的组合一直保持到节拍末尾的检查
+            g_isSettingMode = 1;
+            port = P2;
+            P2 = (unsigned char)((port & (unsigned char)~LAMP_MASK) | lamps);
+#if PHASE_PLAN == PHASE_PLAN_FULL
+            port = P0;
+            P0 = (unsigned char)((port & (unsigned char)~AUX_MASK) | aux);
+#endif
+            Test_Tick(0);
+
+            if (legal) {
+                (*legalCount)++;
+                if (monFault != MON_OK) {
+                    printf("合法组合 灯%02X 扩展%02X 误报\n", lamps, aux);
+                    ok = 0;
+                }
+            } else {
+                (*illegalCount)++;
+                if (monFault != MON_LAMPS || monFaultLamps != lamps ||
+                    (PHASE_PLAN == PHASE_PLAN_FULL && monFaultAux != aux)) {
+                    printf("非法组合 灯%02X 扩展%02X 没有锁定故障\n", lamps, aux);
+                    ok = 0;
+                } else if ((P2 & LAMP_MASK) != LAMP_ALL_RED || EX0 || EX1 ||
+                           (PHASE_PLAN == PHASE_PLAN_FULL && (P0 & AUX_MASK) != AUX_PED_STOP)) {
+                    printf("非法组合 灯%02X 扩展%02X 锁定后本节拍没有写出全红\n", lamps, aux);
+                    ok = 0;
+                } else if (!behaviourChecked) {
+                    // 故障后的行为只需检查一次
+                    behaviourChecked = 1;
+                    ok &= Test_FaultBehaviour();
+                }
+            }
+            Test_Recover();
+            if (!ok) {
+                return 0;
+            }
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief  相位号越界锁定故障
+ */
+static int Test_BadState(void)
+{
+    static const unsigned char bad[] = {PHASE_COUNT, 0x7F, 0xFF};
+    unsigned char saved = currentState;
+    unsigned char i;
+    int ok = 1;
+
+    for (i = 0; i < sizeof(bad); i++) {
+        g_isSettingMode = 1;        // 不让相位表用越界的相位号查表
+        currentState = bad[i];
+        Test_Tick(0);
+        if (monFault != MON_STATE || (P2 & LAMP_MASK) != LAMP_ALL_RED) {
+            printf("相位号 %u 没有锁定故障\n", bad[i]);
+            ok = 0;
+        }
+        currentState = saved;
+        Test_Recover();
+    }
+    return ok;
+}
+
+/**
+ * @brief  正常运行与设置模式进出不误报；看门狗喂狗间隔
+ */
+static int Test_NoFalseTrip(unsigned long ticks)
+{
+    unsigned long n;
+    unsigned char i;
+
+    wdtMaxGap = 0;
+    for (n = 0; n < ticks; n++) {
+        Test_Tick(1);
+        if (n == ticks / 2) {
+            // 中途进入设置模式逐个颜色指示，再退出
+            for (i = 0; i < 4; i++) {
+                Keys_Handle(EVT_KEY_SET);
+                Test_Tick(1);
+            }
+        }
+        if (monFault != MON_OK) {
+            printf("正常运行误报：相位 %u 灯%02X 扩展%02X\n", currentState, monFaultLamps, monFaultAux);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int main(void)
+{
+    unsigned long cycleTicks;
+    unsigned int illegalCount = 0;
+    unsigned int legalCount = 0;
+    unsigned long wdtTicks = 0;
+    unsigned long stallFeeds;
+    unsigned int n;
+    int ok = 1;
+
+    Hal_Reset();
+    halWriteHook = Test_WriteHook;
+    System_Init();
+    cycleTicks = (unsigned long)phaseStart[PHASE_COUNT] * TIMEBASE_SEC_TICKS;
+
+    // 1. 正常运行3个周期不误报，喂狗间隔1个节拍
+    ok &= Test_NoFalseTrip(3 * cycleTicks);
+#if WDT_ENABLE
+    if (!wdtFeeds || wdtMaxGap != 1 || wdtBadValue) {
+        printf("看门狗: 喂狗 %lu 次, 最长间隔 %lu 节拍, 写入值%s\n",
+               wdtFeeds, wdtMaxGap, wdtBadValue ? "错误" : "正确");
+        ok = 0;
+    }
+
+    // 2. 主循环停住超过溢出时间（12 × 2^(PS+1) × 32768 个时钟，换算成节拍）：
+    //    节拍照常运行，只有停住前最后一次报到对应的那个节拍喂狗
+    wdtTicks = WDT_COUNTS(WDT_PS) * 1000UL / (FOSC / 1000UL) / TICK_US;
+    stallFeeds = wdtFeeds;
+    for (n = 0; n <= wdtTicks + 1; n++) {
+        Test_Tick(0);
+    }
+    if (wdtFeeds - stallFeeds != 1) {
+        printf("主循环停住后喂狗 %lu 次\n", wdtFeeds - stallFeeds);
+        ok = 0;
+    }
+    Test_Tick(1);
+    Test_Tick(1);
+    if (nowTick - wdtLastFeed != 0) {
+        printf("主循环恢复后没有喂狗\n");
+        ok = 0;
+    }
+    // 预分频取满足 WDT_MIN_MS 的最小值：溢出时间在 [WDT_MIN_MS, 2×WDT_MIN_MS) 之内
+    if ((unsigned long)WDT_COUNTS(WDT_PS) < WDT_NEED ||
+        (WDT_PS > 0 && (unsigned long)WDT_COUNTS(WDT_PS - 1) >= WDT_NEED)) {
+        printf("看门狗预分频 %u 不是满足 %ums 的最小值\n", WDT_PS, WDT_MIN_MS);
+        ok = 0;
+    }
+#else
+    (void)stallFeeds;
+#endif
+
+    // 3. 穷举灯输出组合
+    ok &= Test_Exhaustive(&illegalCount, &legalCount);
+
+    // 4. 相位号越界
+    ok &= Test_BadState();
+
+    // 5. 恢复后正常运行不误报
+    ok &= Test_NoFalseTrip(2 * cycleTicks);
+
+    printf("相位方案 %u 冲突监视: 穷举 %u 种组合（非法 %u 全部锁定，合法 %u 无误报），"
+           "相位号越界锁定, 看门狗 PS=%u 溢出约 %lums（%lu 节拍）  %s\n",
+           PHASE_PLAN, illegalCount + legalCount, illegalCount, legalCount,
+           WDT_PS, wdtTicks * TICK_US / 1000UL, wdtTicks, ok ? "通过" : "失败");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+/**************************************************
+ * 文件名:    test_sched.cpp
+ * 作者:
+ * 日期:      2025-10-17
+ * 描述:      节拍任务调度测试（主机，感应控制与串口均启用，全部任务登记）
+ *           任务函数换成桩：记录运行的节拍，并把Timer0计数推进设定的耗时，检查：
+ *           - 每个任务恰好在第 offset+1 个节拍及之后每 period 个节拍运行
+ *           - 按键/检测器/遥测永远不在同一节拍运行
+ *           - 耗时等于预算不计超时，超出预算每次计一次（255封顶），schedMax 为最长耗时
+ **************************************************/
+
+#include <stdio.h>
+
+#include "../sched.c"
+
+#define TICKS 100000UL
+
+/*-----------------------任务桩-------------------------------*/
+static unsigned char ranMask = 0;                  // 本节拍运行过的任务（位 = 任务号）
+static unsigned int taskCost[SCHED_TASKS];         // 各任务耗时（Timer0计数）
+
+static void Test_Spend(unsigned char id)
+{
+    unsigned int t = (((unsigned int)TH0 << 8) | TL0) + taskCost[id];
+
+    ranMask |= (unsigned char)(1 << id);
+    TH0 = t >> 8;
+    TL0 = t;
+}
+
+void Buzzer_Tick(void)    { Test_Spend(SCHED_BUZZER); }
+void Keys_Tick(void)      { Test_Spend(SCHED_KEYS); }
+void Detector_Tick(void)  { Test_Spend(SCHED_DETECTOR); }
+void Telemetry_Tick(void) { Test_Spend(SCHED_TELEMETRY); }
+
+/**
+ * @brief  执行一个节拍：Timer0 计数从重装后的某处开始（中断里已走过一段）
+ * @retval 本节拍运行过的任务
+ */
+static unsigned char Test_Tick(void)
+{
+    unsigned int t = (unsigned int)TIMER0_RELOAD + 200;
+
+    TH0 = t >> 8;
+    TL0 = t;
+    ranMask = 0;
+    Sched_Tick();
+    return ranMask;
+}
+
+/**
+ * @brief  周期与偏移、采样任务互不重叠
+ */
+static int Test_Slots(void)
+{
+    unsigned long runs[SCHED_TASKS] = {0};
+    unsigned long wrong = 0;
+    unsigned long shared = 0;
+    unsigned long n;
+    unsigned char mask;
+    unsigned char i;
+    int ok;
+
+    for (n = 1; n <= TICKS; n++) {
+        mask = Test_Tick();
+        for (i = 0; i < SCHED_TASKS; i++) {
+            unsigned char due = n > schedTable[i].offset &&
+                                (n - 1 - schedTable[i].offset) % schedTable[i].period == 0;
+            if (due != !!(mask & (1 << i))) {
+                wrong++;
+            }
+            if (mask & (1 << i)) {
+                runs[i]++;
+            }
+        }
+        mask &= (unsigned char)~(1 << SCHED_BUZZER);
+        if (mask & (mask - 1)) {
+            shared++;
+        }
+    }
+
+    ok = !wrong && !shared && runs[SCHED_BUZZER] == TICKS;
+    printf("节拍调度: %lu 节拍, 运行次数 蜂鸣器 %lu 按键 %lu 检测器 %lu 遥测 %lu, "
+           "周期/偏移不符 %lu, 采样任务同拍 %lu  %s\n",
+           TICKS, runs[SCHED_BUZZER], runs[SCHED_KEYS], runs[SCHED_DETECTOR], runs[SCHED_TELEMETRY],
+           wrong, shared, ok ? "通过" : "失败");
+    return ok;
+}
+
+/**
+ * @brief  预算与超时计数
+ */
+static int Test_Budget(void)
+{
+    unsigned long n;
+    unsigned char i;
+    int ok = 1;
+
+    // 耗时恰好等于预算：不超时
+    for (i = 0; i < SCHED_TASKS; i++) {
+        taskCost[i] = schedTable[i].budget;
+        schedMax[i] = 0;
+        schedOverruns[i] = 0;
+    }
+    for (n = 0; n < 10UL * TELEMETRY_TICKS; n++) {
+        Test_Tick();
+    }
+    for (i = 0; i < SCHED_TASKS; i++) {
+        if (schedOverruns[i] || schedMax[i] != schedTable[i].budget) {
+            printf("任务 %u 耗时等于预算: 超时 %u 次, 最长 %u\n", i, schedOverruns[i], schedMax[i]);
+            ok = 0;
+        }
+    }
+
+    // 按键超出预算1个计数：每次运行计一次，其他任务不受影响
+    taskCost[SCHED_KEYS] = schedTable[SCHED_KEYS].budget + 1;
+    for (n = 0; n < 10UL * KEY_SAMPLE_TICKS; n++) {
+        Test_Tick();
+    }
+    if (schedOverruns[SCHED_KEYS] != 10 || schedMax[SCHED_KEYS] != taskCost[SCHED_KEYS] ||
+        schedOverruns[SCHED_BUZZER] || schedOverruns[SCHED_DETECTOR] || schedOverruns[SCHED_TELEMETRY]) {
+        printf("按键超出预算10次: 计数 %u, 最长 %u\n", schedOverruns[SCHED_KEYS], schedMax[SCHED_KEYS]);
+        ok = 0;
+    }
+
+    // 计数封顶
+    for (n = 0; n < 300UL * KEY_SAMPLE_TICKS; n++) {
+        Test_Tick();
+    }
+    if (schedOverruns[SCHED_KEYS] != 0xFF) {
+        printf("超时计数没有封顶: %u\n", schedOverruns[SCHED_KEYS]);
+        ok = 0;
+    }
+
+    printf("节拍预算: 预算内不计超时, 超出每次计数（255封顶）, 记录最长耗时  %s\n", ok ? "通过" : "失败");
+    return ok;
+}
+
+int main(void)
+{
+    int ok = 1;
+
+    ok &= Test_Slots();
+    ok &= Test_Budget();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,409 @@
+/**************************************************
+ * 文件名:    test_telemetry.cpp
+ * 作者:
+ * 日期:      2025-10-17
+ * 描述:      串口遥测测试（主机）
+ *           固件照常运行（随机进入设置模式、随机紧急请求），串口按 Timer2 波特率逐字节计时
+ *           （uart_host.cpp），线路另一端用主机解码器（tlm_decode.cpp）解帧，检查：
+ *           - 帧率为 TELEMETRY_HZ，每一份快照都发出，序号连续，发送缓冲区从不溢出
+ *           - 帧内容与Timer0抓取快照时的固件状态一致，快照到最后一个字节发出的延迟小于一个遥测周期
+ *           - 发送器停顿时 Uart_Send() 立即返回并整帧丢弃，恢复后已入队的帧完整发出
+ *           - 固件查表 CRC-8 与逐位参照实现一致（标准校验值 "123456789" → 0xF4）
+ *           - 字节流受干扰（错位翻转、插入杂散字节）时解码器重新同步，未受干扰的帧全部收到
+ **************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#define main firmware_main
+#include "../main.c"
+#undef main
+
+#include "uart_host.h"
+#include "tlm_decode.h"
+
+void Timer0_ISR(void);
+void Emergency_NsISR(void);
+
+#if TLM_SYNC != TLM_DEC_SYNC || TLM_TYPE_STATUS != TLM_DEC_TYPE_STATUS || TLM_STATUS_LEN != TLM_DEC_STATUS_LEN
+#error "主机解码器与固件帧格式不一致"
+#endif
+
+#define RUN_SECONDS 600
+#define TICK_S      ((double)TIMEBASE_TICK_CLKS / (double)FOSC)
+
+/*-----------------------仿真状态-----------------------------*/
+typedef struct {
+    unsigned long tick;         // 抓取快照的节拍
+    TlmStatus_t s;              // 抓取时的固件状态
+} Truth_t;
+
+static unsigned long nowTick = 0;
+static std::vector<Truth_t> truth;          // 每份快照的期望内容
+static size_t truthMatched = 0;             // 已与帧对上的快照数
+static int truthBuilt = 1;                  // 最后一份快照的主循环字段已记录
+static std::vector<unsigned char> line;     // 线路上的全部字节
+static std::vector<TlmStatus_t> sent;       // 解码得到的状态帧
+static TlmDecoder_t dec;
+static unsigned long mismatches = 0;
+static unsigned long missing = 0;
+static unsigned long maxLatency = 0;        // 节拍
+
+/*-----------------------随机数-------------------------------*/
+static unsigned long rngState = 23;
+
+static unsigned long Test_Rand(unsigned long n)
+{
+    rngState = rngState * 1103515245UL + 12345UL;
+    return (rngState >> 16) % n;
+}
+
+/**
+ * @brief  解码器回调：与快照记录比较
+ */
+static void Test_OnFrame(const TlmDecoder_t *d, void *ctx)
+{
+    TlmStatus_t s;
+
+    (void)ctx;
+    if (!Tlm_ParseStatus(d, &s)) {
+        mismatches++;
+        return;
+    }
+    sent.push_back(s);
+    // 按序号向后查找对应的快照，跳过的都是丢失的帧
+    while (truthMatched < truth.size() && truth[truthMatched].s.seq != s.seq) {
+        truthMatched++;
+        missing++;
+    }
+    if (truthMatched == truth.size()) {
+        printf("收到序号 %u 的帧，但没有对应的快照\n", s.seq);
+        mismatches++;
+        return;
+    }
+    if (memcmp(&truth[truthMatched].s, &s, sizeof(s))) {
+        const TlmStatus_t *t = &truth[truthMatched].s;
+        printf("帧 #%u 相位 %u/%u 剩余 %u/%u 方案 %02X/%02X 绿 %u/%u 黄 %u/%u 标志 %02X/%02X 故障 %u/%u（帧/快照）\n",
+               s.seq, s.phase, t->phase, s.left, t->left, s.plan, t->plan, s.green, t->green,
+               s.yellow, t->yellow, s.flags, t->flags, s.fault, t->fault);
+        mismatches++;
+    }
+    if (nowTick - truth[truthMatched].tick > maxLatency) {
+        maxLatency = nowTick - truth[truthMatched].tick;
+    }
+    truthMatched++;
+}
+
+static void Test_Sink(unsigned char b)
+{
+    line.push_back(b);
+    Tlm_Feed(&dec, b, Test_OnFrame, 0);
+}
+
+static void Test_WriteHook(unsigned char addr, unsigned char value)
+{
+    UartHost_Write(addr, value);
+}
+
+/**
+ * @brief  执行一个节拍：Timer0中断（可能抓取快照）→ 主循环（组帧）→ 串口发送一个节拍的时长
+ */
+static void Test_Tick(void)
+{
+    unsigned char seq = tlmSeq;
+
+    nowTick++;
+    TH0 = 0;
+    TL0 = 0;
+    Timer0_ISR();
+    if (tlmSeq != seq) {
+        // 快照与中断内的状态一致
+        Truth_t t;
+
+        memset(&t, 0, sizeof(t));
+        t.tick = nowTick;
+        t.s.seq = tlmSeq;
+        t.s.phase = currentState;
+        t.s.left = timeLeft;
+        t.s.plan = (unsigned char)((PHASE_PLAN << 4) | (planPending ? TLM_PLAN_PENDING : 0) | planActive);
+#if ACTUATED_ENABLE
+        t.s.plan |= TLM_PLAN_ACTUATED;
+#endif
+        t.s.flags = (unsigned char)((emgStage != EMG_IDLE ? TLM_F_EMERGENCY : 0) | (isFlashing ? TLM_F_FLASHING : 0));
+        t.s.fault = monFault;
+        truth.push_back(t);
+        truthBuilt = 0;
+    }
+    Main_Poll();
+    if (!truthBuilt) {
+        // 配时与设置模式在主循环组帧时读取；测试只在节拍开始前改动它们
+        Truth_t *t = &truth.back();
+
+        t->s.green = g_time_green;
+        t->s.yellow = g_time_yellow;
+        if (g_isSettingMode) {
+            t->s.flags |= TLM_F_SETTING;
+        }
+        truthBuilt = 1;
+    }
+    UartHost_Run(TICK_S);
+}
+
+static void Test_Run(unsigned long ticks)
+{
+    while (ticks--) {
+        Test_Tick();
+    }
+}
+
+/**
+ * @brief  固件正常运行，穿插设置模式与紧急请求
+ */
+static int Test_Stream(void)
+{
+    unsigned long end = (unsigned long)(RUN_SECONDS / TICK_S);
+    unsigned long dropped = uartTxDropped;
+    unsigned long expected;
+    double rate;
+    int ok = 1;
+
+    while (nowTick < end) {
+        Test_Run(Test_Rand(20 * TIMEBASE_SEC_TICKS));
+        if (emgStage != EMG_IDLE || emgRequest) {
+            continue;
+        }
+        if (Test_Rand(2)) {
+            // 设置模式：加减几次后退出
+            unsigned char n = (unsigned char)Test_Rand(4);
+            Keys_Handle(EVT_KEY_SET);
+            Test_Run(Test_Rand(2 * TIMEBASE_SEC_TICKS));
+            while (n--) {
+                Keys_Handle(g_time_green < 20 && Test_Rand(2) ? EVT_KEY_UP : EVT_KEY_DOWN);
+                Test_Run(Test_Rand(TIMEBASE_SEC_TICKS));
+            }
+            Keys_Handle(EVT_KEY_SET);
+            Keys_Handle(EVT_KEY_SET);
+            Keys_Handle(EVT_KEY_SET);
+        } else if (EX0 && EA) {
+            // 南北紧急请求：保持请求几秒后撤销
+            EMERGENCY_NS_PIN = 0;
+            Emergency_NsISR();
+            Test_Run(Test_Rand(10 * TIMEBASE_SEC_TICKS));
+            EMERGENCY_NS_PIN = 1;
+        }
+    }
+    // 让最后一帧发完
+    Test_Run(TELEMETRY_TICKS);
+    while (truthMatched < truth.size() && truth.size() - truthMatched > 1) {
+        truthMatched++;
+        missing++;
+    }
+
+    expected = (unsigned long)(nowTick / TELEMETRY_TICKS);
+    rate = sent.size() / (nowTick * TICK_S);
+    if (mismatches || missing || dec.crcErrors || dec.lenErrors || uartTxDropped != dropped || uartHostOverruns ||
+        sent.size() + 1 < expected || maxLatency >= TELEMETRY_TICKS) {
+        ok = 0;
+    }
+    printf("遥测 %d 秒: 帧 %lu（%.2f Hz）, 内容不符 %lu, 丢帧 %lu, CRC错误 %lu, 缓冲区满 %u, "
+           "快照到发完最长 %.1f ms, 串口带宽 %.1f%%, 串口中断 %.0f 次/秒  %s\n",
+           RUN_SECONDS, (unsigned long)sent.size(), rate, mismatches, missing, dec.crcErrors,
+           (unsigned char)(uartTxDropped - dropped), maxLatency * TICK_S * 1000.0,
+           100.0 * uartHostBytes * UartHost_ByteSeconds() / (nowTick * TICK_S),
+           uartHostIsrCalls / (nowTick * TICK_S), ok ? "通过" : "失败");
+    return ok;
+}
+
+/**
+ * @brief  发送器停顿（串口中断被关）：Uart_Send 不等待，整帧丢弃；恢复后已入队的帧完整发出。
+ *         发送途中再入队一帧：不能再次置 TI 启动（否则在移位中改写 SBUF）
+ */
+static int Test_Stall(void)
+{
+    unsigned char frame[TLM_STATUS_FRAME];
+    unsigned char dropped = uartTxDropped;
+    unsigned long bytes;
+    unsigned int accepted = 0;
+    unsigned int i;
+    int ok = 1;
+
+    // 先让发送器空闲
+    halWriteHook = Test_WriteHook;
+    UartHost_Run(1.0);
+    bytes = uartHostBytes;
+
+    for (i = 0; i < sizeof(frame); i++) {
+        frame[i] = (unsigned char)(0x30 + i);
+    }
+    ES = 0;
+    for (i = 0; i < 100; i++) {
+        accepted += Uart_Send(frame, sizeof(frame));
+    }
+    if (accepted != UART_TX_SIZE / TLM_STATUS_FRAME || (unsigned char)(uartTxDropped - dropped) != 100 - accepted) {
+        ok = 0;
+    }
+    ES = 1;
+    UartHost_Run(1.0);
+    if (uartHostBytes - bytes != accepted * sizeof(frame) ||
+        memcmp(&line[line.size() - sizeof(frame)], frame, sizeof(frame))) {
+        ok = 0;
+    }
+    printf("发送器停顿: 连续入队 100 帧, 接受 %u 帧, 丢弃 %u 帧, 恢复后发出 %lu 字节  %s\n",
+           accepted, (unsigned char)(uartTxDropped - dropped), uartHostBytes - bytes, ok ? "通过" : "失败");
+
+    bytes = uartHostBytes;
+    Uart_Send(frame, sizeof(frame));
+    UartHost_Run(2.5 * UartHost_ByteSeconds());
+    Uart_Send(frame, sizeof(frame));
+    UartHost_Run(1.0);
+    if (uartHostOverruns || uartHostBytes - bytes != 2 * sizeof(frame) ||
+        memcmp(&line[line.size() - sizeof(frame)], frame, sizeof(frame))) {
+        ok = 0;
+    }
+    printf("发送途中入队: 发出 %lu 字节, 移位中改写SBUF %lu 次  %s\n",
+           uartHostBytes - bytes, uartHostOverruns, ok ? "通过" : "失败");
+    return ok;
+}
+
+/**
+ * @brief  固件查表CRC与逐位参照实现逐值比较
+ */
+static int Test_Crc(void)
+{
+    const char *check = "123456789";
+    unsigned char a = 0;
+    unsigned char b = 0;
+    unsigned int crc;
+    unsigned int v;
+    unsigned long bad = 0;
+    int ok;
+
+    for (crc = 0; crc < 256; crc++) {
+        for (v = 0; v < 256; v++) {
+            if (Uart_Crc8((unsigned char)crc, (unsigned char)v) != Tlm_Crc8((unsigned char)crc, (unsigned char)v)) {
+                bad++;
+            }
+        }
+    }
+    while (*check) {
+        a = Uart_Crc8(a, (unsigned char)*check);
+        b = Tlm_Crc8(b, (unsigned char)*check);
+        check++;
+    }
+    ok = !bad && a == 0xF4 && b == 0xF4;
+    printf("CRC-8: 查表/逐位不一致 %lu, 校验值 0x%02X/0x%02X  %s\n", bad, a, b, ok ? "通过" : "失败");
+    return ok;
+}
+
+/**
+ * @brief  干扰下的重新同步：按帧边界切开原字节流，随机帧翻转一个字节或插入杂散字节
+ */
+typedef struct {
+    std::vector<TlmStatus_t> got;
+} Noise_t;
+
+static void Test_NoiseFrame(const TlmDecoder_t *d, void *ctx)
+{
+    Noise_t *n = (Noise_t *)ctx;
+    TlmStatus_t s;
+
+    if (Tlm_ParseStatus(d, &s)) {
+        n->got.push_back(s);
+    } else {
+        TlmStatus_t bad;
+        memset(&bad, 0xFF, sizeof(bad));
+        n->got.push_back(bad);
+    }
+}
+
+static int Test_Noise(void)
+{
+    std::vector<unsigned char> noisy;
+    Noise_t n;
+    TlmDecoder_t nd;
+    size_t frames = sent.size();
+    size_t clean = 0;
+    size_t hit = 0;
+    size_t i;
+    size_t k;
+    size_t at = 0;
+    unsigned long falseAccepts = 0;
+    int ok;
+
+    // Test_Stream 的字节流正好由 frames 个完整帧组成
+    for (i = 0; i < frames; i++) {
+        const unsigned char *f = &line[i * TLM_STATUS_FRAME];
+        unsigned long r = Test_Rand(8);
+
+        if (r == 0) {
+            // 一个字节任意翻转若干位（≤8位的突发错误，CRC-8必然检出）
+            k = noisy.size() + Test_Rand(TLM_STATUS_FRAME);
+            noisy.insert(noisy.end(), f, f + TLM_STATUS_FRAME);
+            noisy[k] ^= (unsigned char)(1 + Test_Rand(255));
+        } else if (r == 1) {
+            // 帧内插入一个杂散字节（有时恰好是同步字节）
+            k = Test_Rand(TLM_STATUS_FRAME);
+            noisy.insert(noisy.end(), f, f + k);
+            noisy.push_back(Test_Rand(4) ? (unsigned char)Test_Rand(256) : (unsigned char)TLM_SYNC);
+            noisy.insert(noisy.end(), f + k, f + TLM_STATUS_FRAME);
+        } else {
+            noisy.insert(noisy.end(), f, f + TLM_STATUS_FRAME);
+            clean++;
+            continue;
+        }
+        hit++;
+        // 帧间插入的杂散字节不影响任何帧
+        if (Test_Rand(4) == 0) {
+            noisy.push_back((unsigned char)Test_Rand(256));
+        }
+    }
+
+    Tlm_Init(&nd);
+    for (i = 0; i < noisy.size(); i++) {
+        Tlm_Feed(&nd, noisy[i], Test_NoiseFrame, &n);
+    }
+
+    // 收到的帧必须按顺序是原帧的子序列（错误内容的帧即漏检）
+    for (i = 0; i < n.got.size(); i++) {
+        while (at < frames && memcmp(&sent[at], &n.got[i], sizeof(TlmStatus_t))) {
+            at++;
+        }
+        if (at == frames) {
+            falseAccepts++;
+            at = 0;
+            continue;
+        }
+        at++;
+    }
+
+    // CRC-8 对插入错误的漏检率约1/256
+    ok = n.got.size() >= clean && falseAccepts * 64 <= hit;
+    printf("干扰解码: 原帧 %lu（受干扰 %lu）, 收到 %lu, 错误接受 %lu, CRC错误 %lu, 长度错误 %lu  %s\n",
+           (unsigned long)frames, (unsigned long)hit, (unsigned long)n.got.size(), falseAccepts,
+           nd.crcErrors, nd.lenErrors, ok ? "通过" : "失败");
+    return ok;
+}
+
+int main(void)
+{
+    int ok = 1;
+
+    Hal_Reset();
+    UartHost_Init(Test_Sink);
+    Tlm_Init(&dec);
+    halWriteHook = Test_WriteHook;
+    System_Init();
+    if (!UartHost_ByteSeconds()) {
+        printf("串口未按方式1/Timer2波特率初始化\n");
+        return 1;
+    }
+
+    ok &= Test_Crc();
+    ok &= Test_Stream();
+    ok &= Test_Noise();
+    ok &= Test_Stall();
+
+    printf("串口遥测 %s\n", ok ? "通过" : "失败");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+/**************************************************
+ * 文件名:    test_timebase.cpp
+ * 作者:
+ * 日期:      2025-10-10
+ * 描述:      时间基准精度测试（主机）
+ *           按 -DFOSC=... 指定的晶振编译 timer.c，逐节拍调用 Timebase_Tick()，
+ *           在每个秒节拍处与按节拍计数值精确换算的真实时间比较：
+ *           - 1小时内误差必须小于1秒（指标：±1s/小时）
+ *           - 连续运行7天误差同样不超过一个节拍（长期无漂移）
+ **************************************************/
+
+#include <stdio.h>
+#include <math.h>
+
+#include "../timer.c"
+
+// timer.c 的 Test_DelayAccuracy() 引用了显示函数，测试中不需要
+void Display_ShowTime(unsigned char, unsigned char) {}
+
+/**
+ * @brief  运行指定秒数，返回各秒节拍处的最大绝对误差（秒）
+ */
+static double Run(double seconds)
+{
+    const double tickSeconds = (double)TIMEBASE_TICK_CLKS / (double)FOSC;
+    const unsigned long long ticks = (unsigned long long)(seconds / tickSeconds);
+    unsigned long long n;
+    unsigned long counted = 0;
+    double maxErr = 0.0;
+
+    Reset_SystemTime();
+    for (n = 1; n <= ticks; n++) {
+        if (Timebase_Tick()) {
+            double err;
+            counted++;
+            err = fabs(n * tickSeconds - (double)counted);
+            if (err > maxErr) {
+                maxErr = err;
+            }
+        }
+    }
+    if (systemTime_s != (unsigned int)counted) {
+        printf("systemTime_s 与秒节拍数不一致\n");
+        return 1e9;
+    }
+    return maxErr;
+}
+
+int main(void)
+{
+    const double tickSeconds = (double)TIMEBASE_TICK_CLKS / (double)FOSC;
+    const double hourErr = Run(3600.0);
+    const double weekErr = Run(7 * 86400.0);
+    const int ok = hourErr < 1.0 && weekErr <= tickSeconds * 1.000001;
+
+    printf("FOSC=%-9lu 节拍=%.6fms  1小时最大误差 %.6fs  7天最大误差 %.6fs  %s\n",
+           (unsigned long)FOSC, tickSeconds * 1000.0,
+           hourErr, weekErr, ok ? "通过" : "失败");
+    return ok ? 0 : 1;
+}
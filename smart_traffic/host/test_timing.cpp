@@ -0,0 +1,212 @@
+/**************************************************
+ * 文件名:    test_timing.cpp
+ * 作者:
+ * 日期:      2025-10-16
+ * 描述:      配时方案双缓冲切换测试（主机，各相位方案分别构建）
+ *           相位表照常运行，随机时刻通过按键进入设置模式、随机调整红/黄/绿时间后退出，检查：
+ *           - 同一周期内所有相位都取自同一份方案：周期开始前最后一次退出设置时写好的那一份
+ *             （没有一半旧、一半新的周期）
+ *           - 正在运行的相位不被截断：剩余时间只在秒边界减1，相位在剩余1秒时才结束，
+ *             退出设置模式后剩余时间与进入前相同
+ *           - 两个方向的倒计时在方案切换的周期边界处连续（每秒减1，只在本方向放行/等待开始时重装）
+ *           - 主循环写影子方案之前Timer0恰好完成切换时，生效中的方案不被改写
+ **************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#define main firmware_main
+#include "../main.c"
+#undef main
+
+void Timer0_ISR(void);
+
+#define SESSIONS  500
+#define GREEN_CAP 30    // 随机调整时绿灯上限（秒），控制仿真时长
+
+/*-----------------------仿真状态-----------------------------*/
+static unsigned long nowTick = 0;
+static unsigned char committed[PHASE_COUNT];  // 最近一次退出设置时写好的影子方案
+static unsigned char cyclePlan[PHASE_COUNT];  // 本周期应使用的方案
+static unsigned char lastState;
+static unsigned char lastLeft;
+static unsigned int lastCd[2];
+static unsigned long cycles = 0;              // 观察到的周期数
+static unsigned long swaps = 0;               // 方案实际改变的周期边界
+static unsigned long torn = 0;                // 相位时长与本周期方案不符
+static unsigned long shortened = 0;           // 相位被截断或剩余时间跳变
+static unsigned long jumps = 0;               // 倒计时跳变
+
+/*-----------------------随机数-------------------------------*/
+static unsigned long rngState = 19;
+
+static unsigned long Test_Rand(unsigned long n)
+{
+    rngState = rngState * 1103515245UL + 12345UL;
+    return (rngState >> 16) % n;
+}
+
+/**
+ * @brief  记录当前状态作为下一次比较的基准
+ */
+static void Test_Sync(void)
+{
+    unsigned char d;
+
+    lastState = currentState;
+    lastLeft = timeLeft;
+    for (d = 0; d < 2; d++) {
+        lastCd[d] = Phase_Countdown(currentState, d, timeLeft);
+    }
+}
+
+/**
+ * @brief  执行一个节拍并检查相位时长与倒计时（设置模式下只运行不检查）
+ */
+static void Test_Tick(void)
+{
+    unsigned char d;
+
+    nowTick++;
+    TH0 = 0;
+    TL0 = 0;
+    Timer0_ISR();
+    Main_Poll();
+    if (g_isSettingMode) {
+        return;
+    }
+
+    if (currentState != lastState) {
+        if (currentState <= lastState) {
+            // 周期边界：本周期使用边界前写好的方案
+            cycles++;
+            if (memcmp(cyclePlan, committed, sizeof(cyclePlan))) {
+                swaps++;
+            }
+            memcpy(cyclePlan, committed, sizeof(cyclePlan));
+        }
+        if (timeLeft != cyclePlan[currentState]) {
+            printf("周期 %lu 相位 %u 时长 %u，方案为 %u\n", cycles, currentState, timeLeft, cyclePlan[currentState]);
+            torn++;
+        }
+        if (lastLeft != 1) {
+            printf("相位 %u 剩余 %u 秒时被结束\n", lastState, lastLeft);
+            shortened++;
+        }
+    } else if (timeLeft != lastLeft && timeLeft + 1 != lastLeft) {
+        printf("相位 %u 剩余时间 %u → %u\n", currentState, lastLeft, timeLeft);
+        shortened++;
+    }
+
+    for (d = 0; d < 2; d++) {
+        unsigned int cd = Phase_Countdown(currentState, d, timeLeft);
+
+        if (cd != lastCd[d] && cd + 1 != lastCd[d] && lastCd[d] != 1) {
+            printf("方向 %u 倒计时 %u → %u（相位 %u → %u）\n", d, lastCd[d], cd, lastState, currentState);
+            jumps++;
+        }
+    }
+    Test_Sync();
+}
+
+static void Test_Run(unsigned long ticks)
+{
+    while (ticks--) {
+        Test_Tick();
+    }
+}
+
+/**
+ * @brief  一次设置：进入后依次在红/黄/绿下随机加减，然后退出
+ */
+static void Test_Settings(void)
+{
+    unsigned char left = timeLeft;
+    unsigned char state = currentState;
+    unsigned char sel;
+    unsigned char n;
+
+    Keys_Handle(EVT_KEY_SET);
+    for (sel = 0; sel < 3; sel++) {
+        n = (unsigned char)Test_Rand(6);
+        while (n--) {
+            if (Test_Rand(2) && g_time_green < GREEN_CAP && g_time_yellow < 9) {
+                Keys_Handle(EVT_KEY_UP);
+            } else {
+                Keys_Handle(EVT_KEY_DOWN);
+            }
+            Test_Run(Test_Rand(TIMEBASE_SEC_TICKS));
+        }
+        Keys_Handle(EVT_KEY_SET);   // 下一个颜色；绿灯之后退出
+    }
+
+    // 退出时写好影子方案，等待周期边界
+    if (g_isSettingMode || !planPending) {
+        printf("退出设置模式后没有待切换的方案\n");
+        torn++;
+    }
+    memcpy(committed, planTime[planActive ^ 1], sizeof(committed));
+    if (currentState != state || timeLeft != left) {
+        printf("退出设置模式后相位 %u 剩余 %u（进入前 %u 剩余 %u）\n", currentState, timeLeft, state, left);
+        shortened++;
+    }
+    Test_Sync();
+}
+
+/**
+ * @brief  Timer0恰好在主循环撤销旧的待切换之前完成切换：新方案只写入换下的那一份
+ */
+static int Test_Interleave(void)
+{
+    unsigned char live[PHASE_COUNT];
+    unsigned char active;
+
+    g_time_green = 7;
+    UpdateStateTimeTable();             // 旧的待切换
+    Plan_Swap();                        // Timer0 在周期边界完成切换
+    active = planActive;
+    memcpy(live, planTime[active], sizeof(live));
+    g_time_green = 9;
+    UpdateStateTimeTable();             // 主循环：撤销（已无待切换）→ 写影子
+    if (planActive != active || memcmp(live, planTime[active], sizeof(live)) || !planPending ||
+        !memcmp(planTime[active], planTime[active ^ 1], sizeof(live))) {
+        printf("切换与写影子交错时改写了生效中的方案\n");
+        return 0;
+    }
+    return 1;
+}
+
+int main(void)
+{
+    unsigned long cycleTicks;
+    unsigned int n;
+    int ok = 1;
+
+    Hal_Reset();
+    System_Init();
+    memcpy(committed, stateTimeTable, sizeof(committed));
+    memcpy(cyclePlan, stateTimeTable, sizeof(cyclePlan));
+    Test_Sync();
+
+    for (n = 0; n < SESSIONS; n++) {
+        cycleTicks = (unsigned long)phaseStart[PHASE_COUNT] * TIMEBASE_SEC_TICKS;
+        Test_Run(Test_Rand(2 * cycleTicks));
+        Test_Settings();
+    }
+    // 最后一次修改也要生效
+    Test_Run(2 * (unsigned long)phaseStart[PHASE_COUNT] * TIMEBASE_SEC_TICKS + 2 * TIMEBASE_SEC_TICKS);
+    if (planPending || memcmp(stateTimeTable, committed, sizeof(committed))) {
+        printf("两个周期后方案仍未切换\n");
+        ok = 0;
+    }
+
+    ok &= Test_Interleave();
+
+    if (torn || shortened || jumps || swaps == 0) {
+        ok = 0;
+    }
+    printf("相位方案 %u 配时切换: 设置 %u 次, 周期 %lu 个（换方案 %lu 次）, "
+           "方案不一致 %lu, 相位截断 %lu, 倒计时跳变 %lu  %s\n",
+           PHASE_PLAN, SESSIONS, cycles, swaps, torn, shortened, jumps, ok ? "通过" : "失败");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+/**************************************************
+ * 文件名:    tlm_decode.cpp
+ * 作者:
+ * 日期:      2025-10-17
+ * 描述:      遥测帧解码与命令帧编码实现
+ **************************************************/
+
+#include <string.h>
+
+#include "tlm_decode.h"
+
+unsigned char Tlm_Crc8(unsigned char crc, unsigned char b)
+{
+    int i;
+
+    crc ^= b;
+    for (i = 0; i < 8; i++) {
+        crc = (crc & 0x80) ? (unsigned char)((crc << 1) ^ 0x07) : (unsigned char)(crc << 1);
+    }
+    return crc;
+}
+
+void Tlm_Init(TlmDecoder_t *d)
+{
+    memset(d, 0, sizeof(*d));
+}
+
+/**
+ * @brief  丢弃当前帧的同步字节，把其后已收到的字节重新输入（其中可能有真正的帧头）
+ */
+static int Tlm_Resync(TlmDecoder_t *d, void (*onFrame)(const TlmDecoder_t *d, void *ctx), void *ctx)
+{
+    unsigned char again[sizeof(d->raw)];
+    unsigned int n = d->n;
+    unsigned int i;
+    int done = 0;
+
+    memcpy(again, d->raw, n);
+    d->n = 0;
+    d->skipped++;
+    for (i = 1; i < n; i++) {
+        done += Tlm_Feed(d, again[i], onFrame, ctx);
+    }
+    return done;
+}
+
+int Tlm_Feed(TlmDecoder_t *d, unsigned char b, void (*onFrame)(const TlmDecoder_t *d, void *ctx), void *ctx)
+{
+    unsigned char crc;
+    unsigned int i;
+
+    if (d->n == 0) {
+        if (b != TLM_DEC_SYNC) {
+            d->skipped++;
+            return 0;
+        }
+        d->raw[d->n++] = b;
+        return 0;
+    }
+    d->raw[d->n++] = b;
+    if (d->n == 3 && d->raw[2] > TLM_DEC_MAX_LEN) {
+        d->lenErrors++;
+        return Tlm_Resync(d, onFrame, ctx);
+    }
+    if (d->n < 4 || d->n < (unsigned int)d->raw[2] + 4) {
+        return 0;
+    }
+
+    // 帧收齐：校验 TYPE..负载
+    crc = 0;
+    for (i = 1; i < d->n - 1; i++) {
+        crc = Tlm_Crc8(crc, d->raw[i]);
+    }
+    if (crc != d->raw[d->n - 1]) {
+        d->crcErrors++;
+        return Tlm_Resync(d, onFrame, ctx);
+    }
+    d->type = d->raw[1];
+    d->len = d->raw[2];
+    memcpy(d->payload, d->raw + 3, d->len);
+    d->frames++;
+    d->n = 0;
+    if (onFrame) {
+        onFrame(d, ctx);
+    }
+    return 1;
+}
+
+int Tlm_ParseStatus(const TlmDecoder_t *d, TlmStatus_t *s)
+{
+    if (d->type != TLM_DEC_TYPE_STATUS || d->len != TLM_DEC_STATUS_LEN) {
+        return 0;
+    }
+    s->seq = d->payload[0];
+    s->phase = d->payload[1];
+    s->left = d->payload[2];
+    s->plan = d->payload[3];
+    s->green = d->payload[4];
+    s->yellow = d->payload[5];
+    s->flags = d->payload[6];
+    s->fault = d->payload[7];
+    return 1;
+}
+
+unsigned int Tlm_Encode(unsigned char type, const unsigned char *payload, unsigned char len, unsigned char *out)
+{
+    unsigned char crc;
+    unsigned int i;
+
+    out[0] = TLM_DEC_SYNC;
+    out[1] = type;
+    out[2] = len;
+    if (len) {
+        memcpy(out + 3, payload, len);
+    }
+    crc = 0;
+    for (i = 1; i < (unsigned int)len + 3; i++) {
+        crc = Tlm_Crc8(crc, out[i]);
+    }
+    out[len + 3] = crc;
+    return len + 4u;
+}
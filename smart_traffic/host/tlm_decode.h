@@ -0,0 +1,77 @@
+/**************************************************
+ * 文件名:    tlm_decode.h
+ * 作者:
+ * 日期:      2025-10-17
+ * 描述:      遥测帧解码与命令帧编码（主机端，不依赖固件头文件，可直接用于路口机柜的上位机）
+ *           帧格式见 ../telemetry.h：0xA5 | TYPE | LEN | 负载 | CRC-8；命令与应答见 ../command.h
+ *           逐字节输入；长度或CRC错误时从错误帧同步字节之后重新查找 0xA5，
+ *           线路上的干扰最多损失与其重叠的帧
+ **************************************************/
+
+#ifndef __TLM_DECODE_H__
+#define __TLM_DECODE_H__
+
+#define TLM_DEC_SYNC        0xA5
+#define TLM_DEC_MAX_LEN     32      // 负载长度上限，超过视为错误同步
+#define TLM_DEC_TYPE_STATUS 0x01
+#define TLM_DEC_STATUS_LEN  8
+#define TLM_DEC_TYPE_PLAN   0x02    // 配时应答：[绿, 黄, 待切换, 各相位时长...]
+#define TLM_DEC_TYPE_ACK    0x03    // 命令应答：[命令TYPE, 结果]
+
+// 命令（上位机 → 控制器）
+#define TLM_CMD_GET_PLAN    0x10
+#define TLM_CMD_SET_PLAN    0x11
+#define TLM_CMD_FORCE_PHASE 0x12
+#define TLM_CMD_FLASH       0x13
+
+typedef struct {
+    unsigned char seq;
+    unsigned char phase;
+    unsigned char left;
+    unsigned char plan;
+    unsigned char green;
+    unsigned char yellow;
+    unsigned char flags;
+    unsigned char fault;
+} TlmStatus_t;
+
+typedef struct {
+    unsigned char raw[TLM_DEC_MAX_LEN + 4]; // 当前帧已收到的字节（从同步字节开始）
+    unsigned int n;
+    unsigned char type;                     // 最近一帧（Tlm_Feed 返回1时有效）
+    unsigned char len;
+    unsigned char payload[TLM_DEC_MAX_LEN];
+    unsigned long frames;                   // 校验通过的帧数
+    unsigned long crcErrors;                // CRC 错误帧数
+    unsigned long lenErrors;                // 长度越界
+    unsigned long skipped;                  // 查找同步时丢弃的字节数
+} TlmDecoder_t;
+
+/**
+ * @brief  CRC-8（多项式0x07）逐位计算，作为固件查表实现的参照
+ */
+unsigned char Tlm_Crc8(unsigned char crc, unsigned char b);
+
+void Tlm_Init(TlmDecoder_t *d);
+
+/**
+ * @brief  输入一个字节
+ * @retval 本次输入完成的有效帧数（重新同步时可能多于1）
+ * @note   每完成一帧调用一次 onFrame（可为0），回调中用 Tlm_ParseStatus() 取出内容
+ */
+int Tlm_Feed(TlmDecoder_t *d, unsigned char b, void (*onFrame)(const TlmDecoder_t *d, void *ctx), void *ctx);
+
+/**
+ * @brief  把最近一帧解析为状态帧
+ * @retval 1=是状态帧，0=类型或长度不符
+ */
+int Tlm_ParseStatus(const TlmDecoder_t *d, TlmStatus_t *s);
+
+/**
+ * @brief  组一帧（上位机发命令用）
+ * @param  out: 输出缓冲区，至少 len+4 字节
+ * @retval 帧长度
+ */
+unsigned int Tlm_Encode(unsigned char type, const unsigned char *payload, unsigned char len, unsigned char *out);
+
+#endif /* __TLM_DECODE_H__ */
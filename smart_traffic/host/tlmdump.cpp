@@ -0,0 +1,93 @@
+/**************************************************
+ * 文件名:    tlmdump.cpp
+ * 作者:
+ * 日期:      2025-10-17
+ * 描述:      遥测数据解码工具：从标准输入读取串口原始字节流，逐帧打印状态和命令应答
+ *
+ *           用法: ./tlmdump [-q] < 字节流
+ *             -q  只打印统计
+ *           例:   ./sim -s 60 -u tlm.bin && ./tlmdump < tlm.bin
+ *                 stty -F /dev/ttyUSB0 9600 raw && ./tlmdump < /dev/ttyUSB0
+ **************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tlm_decode.h"
+
+typedef struct {
+    int quiet;
+    int haveSeq;
+    unsigned char lastSeq;
+    unsigned long lost;         // 按序号推算丢失的帧数
+    unsigned long other;        // 非状态帧
+} Dump_t;
+
+static void Dump_Frame(const TlmDecoder_t *d, void *ctx)
+{
+    Dump_t *dump = (Dump_t *)ctx;
+    TlmStatus_t s;
+
+    if (!Tlm_ParseStatus(d, &s)) {
+        dump->other++;
+        if (dump->quiet) {
+            return;
+        }
+        if (d->type == TLM_DEC_TYPE_ACK && d->len == 2) {
+            printf("应答 命令 0x%02X 结果 %u\n", d->payload[0], d->payload[1]);
+        } else if (d->type == TLM_DEC_TYPE_PLAN && d->len >= 3) {
+            unsigned int i;
+
+            printf("配时 绿 %u 黄 %u%s 相位时长", d->payload[0], d->payload[1], d->payload[2] ? " 待切换" : "");
+            for (i = 3; i < d->len; i++) {
+                printf(" %u", d->payload[i]);
+            }
+            printf("\n");
+        } else {
+            printf("类型 0x%02X 长度 %u\n", d->type, d->len);
+        }
+        return;
+    }
+    if (dump->haveSeq) {
+        dump->lost += (unsigned char)(s.seq - dump->lastSeq - 1);
+    }
+    dump->haveSeq = 1;
+    dump->lastSeq = s.seq;
+    if (!dump->quiet) {
+        printf("#%3u 相位 %u 剩余 %2us 方案 %u%s%s 绿 %2u 黄 %u%s%s%s%s%s%s\n",
+               s.seq, s.phase, s.left, s.plan >> 4,
+               (s.plan & 0x08) ? " 感应" : "",
+               (s.plan & 0x02) ? " 待切换" : "",
+               s.green, s.yellow,
+               (s.flags & 0x01) ? " 设置" : "",
+               (s.flags & 0x02) ? " 紧急" : "",
+               (s.flags & 0x04) ? " 闪烁" : "",
+               (s.flags & 0x08) ? " 闪光运行" : "",
+               (s.flags & 0x10) ? " 强制相位" : "",
+               s.fault ? " 故障" : "");
+    }
+}
+
+int main(int argc, char **argv)
+{
+    TlmDecoder_t dec;
+    Dump_t dump;
+    int c;
+
+    memset(&dump, 0, sizeof(dump));
+    if (argc == 2 && strcmp(argv[1], "-q") == 0) {
+        dump.quiet = 1;
+    } else if (argc != 1) {
+        fprintf(stderr, "用法: %s [-q] < 字节流\n", argv[0]);
+        return 2;
+    }
+
+    Tlm_Init(&dec);
+    while ((c = getchar()) != EOF) {
+        Tlm_Feed(&dec, (unsigned char)c, Dump_Frame, &dump);
+    }
+
+    printf("帧 %lu（其他类型 %lu）, 序号缺失 %lu, CRC错误 %lu, 长度错误 %lu, 丢弃字节 %lu\n",
+           dec.frames, dump.other, dump.lost, dec.crcErrors, dec.lenErrors, dec.skipped);
+    return (dec.crcErrors || dec.lenErrors) ? 1 : 0;
+}
@@ -0,0 +1,160 @@
+/**************************************************
+ * 文件名:    uart_host.cpp
+ * 作者:
+ * 日期:      2025-10-17
+ * 描述:      主机仿真用串口收发模型实现
+ *           中断只在 UartHost_Run() 中分派：主循环软件置 TI 后，
+ *           第一个字节最多推迟到本节拍结束才开始发送（硬件上是下一条指令）；
+ *           收到的字节在停止位结束时刻立即分派，与硬件相同。
+ *           主机上 SBUF 只有一个存储单元：收到字节时直接写入（不经写钩子），
+ *           固件中断先处理 RI 读出接收字节，再处理 TI 写发送字节
+ **************************************************/
+
+#include "config.h"
+#include "uart_host.h"
+
+void Uart_ISR(void);
+
+/*==============================================
+ *                全局变量
+ *==============================================*/
+unsigned long uartHostBytes = 0;
+unsigned long uartHostIsrCalls = 0;
+unsigned long uartHostOverruns = 0;
+unsigned long uartHostRxBytes = 0;
+unsigned long uartHostRxOverruns = 0;
+unsigned long uartHostRxLost = 0;
+
+static UartHostSink_t uartHostSink = 0;
+static int uartHostShifting = 0;        // 1=正在移出 uartHostByte
+static unsigned char uartHostByte = 0;
+static double uartHostLeft = 0.0;       // 本字节剩余时长（秒）
+static unsigned char uartHostRxQueue[UART_HOST_RX_QUEUE];   // 线路另一端待发的字节（环形）
+static unsigned int uartHostRxHead = 0;
+static unsigned int uartHostRxCount = 0;
+static double uartHostRxLeft = 0.0;     // 队首字节剩余时长（秒）
+
+void UartHost_Init(UartHostSink_t sink)
+{
+    uartHostSink = sink;
+    uartHostShifting = 0;
+    uartHostLeft = 0.0;
+    uartHostBytes = 0;
+    uartHostIsrCalls = 0;
+    uartHostOverruns = 0;
+    uartHostRxHead = 0;
+    uartHostRxCount = 0;
+    uartHostRxLeft = 0.0;
+    uartHostRxBytes = 0;
+    uartHostRxOverruns = 0;
+    uartHostRxLost = 0;
+}
+
+void UartHost_Receive(const unsigned char *buf, unsigned int len)
+{
+    while (len--) {
+        if (uartHostRxCount >= UART_HOST_RX_QUEUE) {
+            uartHostRxLost++;
+            continue;
+        }
+        if (uartHostRxCount == 0) {
+            uartHostRxLeft = UartHost_ByteSeconds();
+        }
+        uartHostRxQueue[(uartHostRxHead + uartHostRxCount) % UART_HOST_RX_QUEUE] = *buf++;
+        uartHostRxCount++;
+    }
+}
+
+unsigned int UartHost_RxPending(void)
+{
+    return uartHostRxCount;
+}
+
+double UartHost_ByteSeconds(void)
+{
+    unsigned int reload = ((unsigned int)RCAP2H << 8) | RCAP2L;
+
+    // 方式1、Timer2 作发送波特率发生器（TCLK）且在运行
+    if ((SCON & 0xC0) != 0x40 || !TCLK || !TR2) {
+        return 0.0;
+    }
+    return 10.0 * UART_T2_CLKS * (65536.0 - reload) / (double)FOSC;
+}
+
+void UartHost_Write(unsigned char addr, unsigned char value)
+{
+    if (addr != 0x99) {
+        return;
+    }
+    if (uartHostShifting) {
+        uartHostOverruns++;
+        return;
+    }
+    uartHostByte = value;
+    uartHostLeft = UartHost_ByteSeconds();
+    uartHostShifting = uartHostLeft > 0.0;
+}
+
+void UartHost_Run(double seconds)
+{
+    double step;
+    int done;       // 本步完成的字节：0=无，1=发送，2=接收
+
+    for (;;) {
+        if ((TI || RI) && ES && EA) {
+            uartHostIsrCalls++;
+            Uart_ISR();
+            if (TI || RI) {
+                break;              // 中断没有清标志：固件错误，避免死循环
+            }
+        }
+
+        // 推进到下一个字节完成的时刻（同时到期时先完成发送，接收在下一轮以0步长完成）
+        step = seconds;
+        done = 0;
+        if (uartHostShifting && uartHostLeft <= step) {
+            step = uartHostLeft;
+            done = 1;
+        }
+        if (uartHostRxCount && uartHostRxLeft < step) {
+            step = uartHostRxLeft;
+            done = 2;
+        } else if (uartHostRxCount && uartHostRxLeft <= step && !done) {
+            done = 2;
+        }
+        if (uartHostShifting) {
+            uartHostLeft -= step;
+        }
+        if (uartHostRxCount) {
+            uartHostRxLeft -= step;
+        }
+        seconds -= step;
+
+        if (done == 1) {
+            // 本字节移完（停止位结束）：交给线路另一端，置 TI 后继续分派中断
+            uartHostShifting = 0;
+            uartHostBytes++;
+            if (uartHostSink) {
+                uartHostSink(uartHostByte);
+            }
+            TI = 1;
+        } else if (done == 2) {
+            // 收到一个字节：REN=1 时写入接收寄存器并置 RI
+            if (!REN) {
+                uartHostRxLost++;
+            } else {
+                if (RI) {
+                    uartHostRxOverruns++;
+                }
+                halSfrMem[0x99 - 0x80] = uartHostRxQueue[uartHostRxHead];
+                uartHostRxBytes++;
+                RI = 1;
+            }
+            uartHostRxHead = (uartHostRxHead + 1) % UART_HOST_RX_QUEUE;
+            uartHostRxCount--;
+            uartHostRxLeft = UartHost_ByteSeconds();
+        } else {
+            break;
+        }
+    }
+}
@@ -0,0 +1,60 @@
+/**************************************************
+ * 文件名:    uart_host.h
+ * 作者:
+ * 日期:      2025-10-17
+ * 描述:      主机仿真用串口收发模型（全双工）
+ *           按 Timer2 重装值换算的波特率计时：写 SBUF 开始移出一个字节（10位），
+ *           移完后交给接收回调并置 TI；线路另一端发来的字节按同样的波特率逐个移入，
+ *           REN=1 时写入接收寄存器（SBUF）并置 RI；(TI 或 RI)、ES、EA 均置位时调用固件的 Uart_ISR()
+ *           仿真程序在 SFR 写钩子中转发 UartHost_Write()，每个节拍调用 UartHost_Run()
+ **************************************************/
+
+#ifndef __UART_HOST_H__
+#define __UART_HOST_H__
+
+// 每移出一个字节调用一次（线路另一端收到的字节）
+typedef void (*UartHostSink_t)(unsigned char b);
+
+/**
+ * @brief  复位模型（发送器空闲），设置接收回调（可为0）
+ */
+void UartHost_Init(UartHostSink_t sink);
+
+/**
+ * @brief  SFR写钩子转发：写 SBUF 时开始发送
+ */
+void UartHost_Write(unsigned char addr, unsigned char value);
+
+/**
+ * @brief  线路另一端发来字节：排在已发来的字节之后，连续移入（字节之间没有空闲）
+ * @param  buf: 字节
+ * @param  len: 字节数（排队总数不超过 UART_HOST_RX_QUEUE，多出的计入 uartHostRxLost）
+ */
+void UartHost_Receive(const unsigned char *buf, unsigned int len);
+
+/**
+ * @brief  线路另一端还没移入完的字节数
+ */
+unsigned int UartHost_RxPending(void);
+
+/**
+ * @brief  推进仿真时间：依次完成到期的发送/接收字节、置 TI/RI 并执行串口中断
+ * @param  seconds: 推进的时长（秒）
+ */
+void UartHost_Run(double seconds);
+
+/**
+ * @brief  当前 Timer2 配置下一个字节（起始位+8数据位+停止位）的时长（秒），未启动时返回0
+ */
+double UartHost_ByteSeconds(void);
+
+extern unsigned long uartHostBytes;     // 已移出的字节数
+extern unsigned long uartHostIsrCalls;  // 串口中断执行次数
+extern unsigned long uartHostOverruns;  // 发送中再写 SBUF 的次数（硬件上会破坏正在发送的字节）
+extern unsigned long uartHostRxBytes;   // 已移入接收寄存器的字节数
+extern unsigned long uartHostRxOverruns; // 上一个字节的 RI 还没被中断清除又收到新字节（前一个丢失）
+extern unsigned long uartHostRxLost;    // REN=0 或队列满丢弃的字节数
+
+#define UART_HOST_RX_QUEUE 256
+
+#endif /* __UART_HOST_H__ */
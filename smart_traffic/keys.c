@@ -0,0 +1,71 @@
+/**************************************************
+ * 文件名:    keys.c
+ * 作者:
+ * 日期:      2025-10-12
+ * 描述:      按键采样与消抖模块实现
+ *           垂直计数器：每个按键的2位计数器按位分布在 keyCnt0/keyCnt1 两个字节中，
+ *           一次按位运算同时处理全部按键；采样值与消抖状态不同则计数，
+ *           相同则清零，连续4次不同才翻转状态。与按键个数无关，每键只占2位
+ **************************************************/
+
+#include "keys.h"
+#include "event.h"
+
+/*-----------------------全局变量定义-------------------------*/
+volatile unsigned char keyState = 0;           // 消抖后的状态（1=按下）
+static unsigned char keyCnt0 = 0xFF;           // 垂直计数器第0位
+static unsigned char keyCnt1 = 0xFF;           // 垂直计数器第1位
+static unsigned char keyRepeatDown = KEY_REPEAT_START;  // 距下次自动重复的采样数
+static unsigned char keyRepeatStep = 0;        // 已重复次数（加速表下标）
+
+// 自动重复间隔（采样周期）：100ms×4 → 40ms×5 → 之后每10ms一次
+// 从1调到99共98步约1.8秒（含消抖和 KEY_REPEAT_START 延时）
+static const unsigned char code repeatInterval[] = {
+    10, 10, 10, 10, 4, 4, 4, 4, 4, 1
+};
+#define REPEAT_STEPS (sizeof(repeatInterval) / sizeof(repeatInterval[0]))
+
+/**
+ * @brief  按键对应的事件
+ */
+static void Keys_Post(unsigned char keys)
+{
+    if (keys & KEY_BIT_UP)   Event_Post(EVT_KEY_UP);
+    if (keys & KEY_BIT_DOWN) Event_Post(EVT_KEY_DOWN);
+    if (keys & KEY_BIT_SET)  Event_Post(EVT_KEY_SET);
+}
+
+/**
+ * @brief  按键节拍处理（Timer0中断上下文）
+ */
+void Keys_Tick(void)
+{
+    unsigned char changed;
+    unsigned char pressed;
+
+    // 整字节采样（低电平=按下），与消抖状态不同的位计数，相同的位清零
+    changed = keyState ^ (~P0 & KEY_MASK);
+    keyCnt0 = ~(keyCnt0 & changed);
+    keyCnt1 = keyCnt0 ^ (keyCnt1 & changed);
+    changed &= keyCnt0 & keyCnt1;       // 计满4次的位
+    keyState ^= changed;
+    pressed = keyState & changed;       // 本次确认按下的键
+
+    // 长按自动重复：只对 KEY_REPEAT_MASK 中的键，松开后重新从起始延时计
+    if (pressed & KEY_REPEAT_MASK) {
+        keyRepeatDown = KEY_REPEAT_START;
+        keyRepeatStep = 0;
+    } else if (keyState & KEY_REPEAT_MASK) {
+        if (--keyRepeatDown == 0) {
+            keyRepeatDown = repeatInterval[keyRepeatStep];
+            if (keyRepeatStep < REPEAT_STEPS - 1) {
+                keyRepeatStep++;
+            }
+            pressed |= keyState & KEY_REPEAT_MASK;
+        }
+    }
+
+    if (pressed) {
+        Keys_Post(pressed);
+    }
+}
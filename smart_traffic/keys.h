@@ -0,0 +1,28 @@
+/**************************************************
+ * 文件名:    keys.h
+ * 作者:
+ * 日期:      2025-10-12
+ * 描述:      按键采样与消抖模块头文件
+ *           在Timer0节拍中整字节采样P0，用垂直计数器同时消抖全部按键，
+ *           按下和长按自动重复以事件（EVT_KEY_*）投递给主循环
+ **************************************************/
+
+#ifndef __KEYS_H__
+#define __KEYS_H__
+
+#include "config.h"
+
+/**
+ * @brief  按键节拍处理（只能在Timer0中断中调用）
+ * @param  无
+ * @retval 无
+ * @note   每次调用采样一次，由节拍任务调度（sched.c）每 KEY_SAMPLE_TICKS 个节拍调用
+ */
+void Keys_Tick(void);
+
+/**
+ * @brief  已消抖的按键状态（KEY_BIT_*，1=按下）
+ */
+extern volatile unsigned char keyState;
+
+#endif /* __KEYS_H__ */
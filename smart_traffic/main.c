@@ -3,7 +3,7 @@
  * 作者:        
  * 日期:      2025-10-08
  * 描述:      智能交通灯系统 - 正式版本
- *           使用2个数码管显示南北和东西方向剩余时间
+ *           使用4位数码管显示南北和东西方向剩余时间（00-99）
  *           基于74HC139译码器和共阳极数码管
  * 
  * 【新增功能说明 - 三个按键设置颜色时间】
@@ -13,39 +13,53 @@
  *   - KEY_DOWN: 在当前选中颜色下减少时间
  *  显示：
  *   - 设置模式暂停倒计时与状态切换
- *   - 两位数码管显示当前选中颜色的时间：左=十位 右=个位
- *   - 选中颜色对应的两个方向同色灯常亮指示（红/黄/绿）
+ *   - 数码管以1Hz闪烁
+ *   - 灯输出保持进入时的相位，不用于指示：南北数码管显示选中颜色的字母（r/y/G），东西数码管显示时间
  *  规则：
  *   - 红灯时间 = 绿灯时间 + 黄灯时间 （保持对称路口逻辑）
  *   - 调整“红”时实际操作的是绿灯时间（简化硬件按键数量）
  *   - 范围：MIN_LIGHT_TIME..MAX_LIGHT_TIME
- *   - 退出后立即应用新配时间表，若当前状态剩余时间超过新设定则截断
+ *   - 退出后新配时写入影子方案，从下一个周期开始生效（正在运行的相位不截断）
  *  假设：
  *   - 按键为上拉输入，按下=0
- *   - 消抖使用简单计数法满足实验板需求
+ *   - Timer0节拍中用垂直计数器并行消抖（keys.c），长按增减键自动重复并加速
+ *  紧急优先：
+ *   - INT0/INT1（P3.2/P3.3）下降沿立即转换灯色，经黄灯、全红清空后请求方向放行（traffic_light.c）
+ *  感应控制（ACTUATED_ENABLE=1）：
+ *   - P3.4/P3.5 车辆检测器在Timer0节拍中采样，绿灯按来车延长、提前结束或停留等待（traffic_light.c）
+ *  冲突监视：
+ *   - Timer0每个节拍查表检查实际灯输出，违例时锁定四面红灯闪烁；主循环运行过才喂看门狗（traffic_light.c）
+ *  遥测：
+ *   - Timer0每100ms抓取状态快照，主循环组成二进制帧放入串口发送队列，串口中断逐字节送出（telemetry.c / uart.c）
+ *  远程命令：
+ *   - 串口接收中断逐字节解析命令帧，主循环执行读取/修改配时、强制相位、闪光运行并回复应答（command.c）
+ *   - 闪光运行期间（含等待进入）与冲突监视故障一样不响应按键
+ *  配时存储：
+ *   - 退出设置模式或远程修改配时后追加写入片内 EEPROM，上电恢复最新的有效记录（eeprom.c）
+ *  提示音：
+ *   - 秒边界按相位投递蜂鸣器音型（buzzer.c），Timer1 硬件产生音调，主循环不等待
+ *  快速启动：
+ *   - 启动代码第一条指令写出全红；初始化不延时，8888 自检显示到第一个秒边界为止
+ *   - 热复位（看门狗、复位键）接回复位前的相位和剩余时间，无法接回时全红清空后从相位0开始（traffic_light.c）
  **************************************************/
 
 #include "config.h"
 #include "traffic_light.h"
 #include "display.h"
 #include "timer.h"
-
-extern unsigned char currentState;
-extern unsigned char timeLeft;
-extern unsigned char isFlashing;
-extern unsigned char stateTimeTable[4];
-
+#include "event.h"
+#include "buzzer.h"
+#include "uart.h"
+#include "telemetry.h"
+#include "command.h"
+#include "eeprom.h"
 
 /*==============================================
  *                全局变量定义
  *==============================================*/
 
-// 显示刷新变量（供Timer0中断使用，必须是全局变量）
-volatile unsigned char nsTime = 0;  // 南北方向显示时间
-volatile unsigned char ewTime = 0;  // 东西方向显示时间
-
 // ===================== 设置模式相关全局变量 =====================
-volatile unsigned char g_isSettingMode = 0;      // 1=进入设置暂停倒计时
+volatile bit g_isSettingMode = 0;                // 1=进入设置暂停倒计时
 volatile unsigned char g_selectedColor = 0;      // 0=红 1=黄 2=绿
 volatile unsigned char g_time_red = DEFAULT_RED_TIME;      // 红灯=绿+黄（显示/修改时单独存便于显示）
 volatile unsigned char g_time_yellow = DEFAULT_YELLOW_TIME;
@@ -53,25 +67,39 @@ volatile unsigned char g_time_green = DEFAULT_GREEN_TIME;
 
 // 函数原型（在 traffic_light.c 中实现）
 void UpdateStateTimeTable(void);
-void ShowSettingColorLights(void);
 
-// 按键扫描函数原型
-static void Keys_Scan(void);
+// 按键事件处理函数原型
+static unsigned char Keys_Handle(unsigned char evt);
+static void Main_RefreshDisplay(void);
+static void Main_Poll(void);
+static void Main_Idle(void);
+static void Main_Boot(void);
+
+#if FAST_BOOT_ENABLE
+static bit mainSelfTest = 1;                     // 1=8888 自检显示中（第一个秒边界结束）
+#endif
+
+#if IDLE_STATS_ENABLE
+// 空闲统计（主循环独占，不与中断共享）
+static unsigned long idleCounts = 0;              // 本秒累计休眠时长（Timer0计数）
+volatile unsigned long idleCountsLastSecond = 0;  // 上一秒休眠时长，供调试器/遥测读取
+#endif
 
 /*==============================================
  *                系统初始化
  *==============================================*/
 /**
- * @brief  系统初始化
+ * @brief  复位到灯输出：恢复配时、选择起始相位并写出灯色
  * @param  无
  * @retval 无
+ * @note   单独成函数，便于基准测试测量启动时间（见 bench/bench.c）；不使用Timer1
  */
-void System_Init(void)
+static void Main_Boot(void)
 {
-    // 初始化所有引脚为低电平
+    // 初始化调试引脚为低电平；复位时P2=0xFF（灯全亮），STARTUP.A51 第一条指令已写成全红，
+    // 这里再经相位表写一次，同时装好紧急入口灯色
     DEBUG_1S_PIN = 0;    DEBUG_STATE_PIN = 0;
-    NS_RED_PIN = 0;      NS_YELLOW_PIN = 0;    NS_GREEN_PIN = 0;
-    EW_RED_PIN = 0;      EW_YELLOW_PIN = 0;    EW_GREEN_PIN = 0;
+    SetTrafficLights(PHASE_COUNT);
     
     // 初始化显示模块（先初始化，用于延时测试）
     Display_Init();
@@ -105,112 +133,315 @@ void System_Init(void)
     // EW_RED_PIN = 0;      EW_YELLOW_PIN = 0;    EW_GREEN_PIN = 0;
     // DEBUG_1S_PIN = 0;    DEBUG_STATE_PIN = 0;
     
+#if EEPROM_ENABLE
+    // 恢复上次保存的配时（没有有效记录时保持默认值），再由它生成相位表
+    Eeprom_LoadPlan();
+#endif
+
     // 初始化系统状态
-    currentState = STATE_NS_GREEN_EW_RED;
-    timeLeft = stateTimeTable[currentState];
+    UpdateStateTimeTable();
+    Plan_Swap();
     isFlashing = 0;
-    
-    // 设置初始交通灯状态
-    SetTrafficLights(currentState);
-    
+
+    // 紧急优先（INT0/INT1，EA 由 Timer0_Init() 打开）
+    Emergency_Init();
+
+    // 起始相位：上电从相位0开始；热复位接回保留记录中的相位，无效时保持全红清空
+    Boot_Start();
+}
+
+/**
+ * @brief  系统初始化
+ * @param  无
+ * @retval 无
+ */
+void System_Init(void)
+{
+    Main_Boot();
+
+    // 蜂鸣器（Timer1，先配置好再启动Timer0节拍）
+    Buzzer_Init();
+
+#if UART_ENABLE
+    // 串口遥测与远程命令（Timer2 波特率），第一帧在Timer0启动后100ms发出
+    Uart_Init();
+#endif
+
     // 初始化定时器（这将启动整个系统）
     Timer0_Init();
     
-    // 延时测试完成，显示 "88" 表示系统准备就绪
-    Display_ShowTime(8, 8);
+    // 显示 "8888"（全部段点亮）自检；快速启动时不等待，交通灯已在运行，第一个秒边界换成倒计时
+    Display_ShowTime(88, 88);
+#if !FAST_BOOT_ENABLE
     Delay_ms(1000);
+#endif
 }
 
 /*==============================================
- *             按键扫描与设置逻辑
+ *             按键事件与设置逻辑
  *  硬件假设：
  *  - KEY_SET_MODE: 循环进入设置/切换颜色/退出
  *    流程：正常→按一次进入(选红)→再按(选黄)→再按(选绿)→再按退出保存
- *  - KEY_UP: 当前颜色时间+1 (限制 MIN_LIGHT_TIME..MAX_LIGHT_TIME)
- *  - KEY_DOWN: 当前颜色时间-1
- *  - 设置时倒计时暂停，数码管显示当前颜色时间（十位=高位，个位=低位）
+ *  - KEY_UP: 当前颜色时间+1 (限制 MIN_LIGHT_TIME..MAX_LIGHT_TIME)，长按自动重复
+ *  - KEY_DOWN: 当前颜色时间-1，长按自动重复
+ *  - 设置时倒计时暂停、灯色保持，南北数码管显示颜色字母，东西数码管显示时间（十位=高位，个位=低位）
  *  - 红灯时间 = 绿 + 黄 自动更新，不单独可调（显示时仍可在红模式显示组合结果）
  */
 
 
 
 
-#define ReadKey(key)   (key)
-
-static void Keys_Scan(void)
+/**
+ * @brief  按键事件处理
+ * @param  evt: EVT_KEY_SET / EVT_KEY_UP / EVT_KEY_DOWN（已在Timer0节拍中消抖，
+ *              长按增减键时会以加速的间隔重复投递）
+ * @retval 1=设置值或模式有变化，需要刷新显示，0=无
+ */
+static unsigned char Keys_Handle(unsigned char evt)
 {
-    static unsigned char lastSet = 1, lastUp = 1, lastDown = 1;
-    // 为每个按键使用独立的消抖计数器，避免互相干扰
-    static unsigned int debounceSet = 0, debounceUp = 0, debounceDown = 0;
-    unsigned char curSet = ReadKey(KEY_SET_MODE);
-    unsigned char curUp = ReadKey(KEY_UP);
-    unsigned char curDown = ReadKey(KEY_DOWN);
-
-    // 简单消抖：每次调用间隔>~0.5ms（主循环很快），通过计数限制处理频率
-    if(debounceSet < 200) debounceSet++;
-    if(debounceUp < 200) debounceUp++;
-    if(debounceDown < 200) debounceDown++;
-
-    // SET 键：下降沿
-    if(lastSet == 1 && curSet == 0 && debounceSet > 5) {
-        debounceSet = 0;
+    // 冲突监视故障后灯输出锁定为红灯闪烁，闪光运行时灯输出归远程命令控制，都不再响应按键
+    if(monFault || flashReq || flashStage != FLASH_OFF) {
+        return 0;
+    }
+
+    // SET 键：进入设置 / 切换颜色 / 退出
+    if(evt == EVT_KEY_SET) {
         if(!g_isSettingMode) {
+            // 紧急优先进行中不能进入设置；设置期间相位暂停，不响应紧急请求
+            if(!Emergency_Suspend()) {
+                return 0;
+            }
             g_isSettingMode = 1; // 进入设置
+            BOOT_FORGET();       // 相位暂停，此后复位不能接回相位（Timer0 已不再记下）
+            // 灯色保持当前相位，不经任何过渡；只补回闪烁熄灭的半秒（设置期间不闪烁）
+            SetTrafficLights(currentState);
             g_selectedColor = 0; // 先红
             // 红=绿+黄
             g_time_red = g_time_green + g_time_yellow;
-            ShowSettingColorLights();
         } else {
             // 在设置模式中循环：红->黄->绿->退出
             g_selectedColor++;
             if(g_selectedColor >= 3) {
-                // 退出，保存：更新状态时间表，重新计算当前状态剩余时间（保持不变，只更新后续）
-                g_isSettingMode = 0;
+                // 退出，保存：新配时写入影子方案，Timer0在下一个周期边界切换，
+                // 正在运行的相位和本周期其余相位按原时长走完（不截断）
                 UpdateStateTimeTable();
-                SetTrafficLights(currentState); // 恢复当前状态灯
-                // 如果当前状态剩余时间大于新时间，截断为新时间
-                if(timeLeft > stateTimeTable[currentState]) timeLeft = stateTimeTable[currentState];
-            } else {
-                ShowSettingColorLights();
+                // 灯色一直是当前相位，不重写：Timer0 从暂停处继续，下一秒重新装载闪烁
+                // 跨周期的等待倒计时按新方案重新计算
+                Countdown_Reload();
+#if EEPROM_ENABLE
+                // 掉电保存（与上次保存的配时相同时不写）：紧急请求中断仍被屏蔽，
+                // 需要时在这里擦除扇区，恢复响应紧急请求之后的保存不必擦除
+                Eeprom_SavePlan();
+#endif
+                // 最后才清除设置标志：此前中断不会切换相位
+                g_isSettingMode = 0;
+                Emergency_Resume();
             }
         }
+        return 1;
     }
 
     // 仅在设置模式且未准备退出时处理加减
-    if(g_isSettingMode && g_selectedColor < 3) {
-        if(lastUp == 1 && curUp == 0 && debounceUp > 5) {
-            debounceUp = 0;
-            if(g_selectedColor == 0) {
-                // 红灯=绿+黄，不直接加，提示：通过加绿实现
-                // 这里选择加绿
-                if(g_time_green < MAX_LIGHT_TIME) g_time_green++;
-            } else if(g_selectedColor == 1) {
-                if(g_time_yellow < MAX_LIGHT_TIME) g_time_yellow++;
-            } else if(g_selectedColor == 2) {
-                if(g_time_green < MAX_LIGHT_TIME) g_time_green++; // 绿模式下直接调绿
-            }
-            g_time_red = g_time_green + g_time_yellow;
+    if(!g_isSettingMode || g_selectedColor >= 3) {
+        return 0;
+    }
+    if(evt == EVT_KEY_UP) {
+        if(g_selectedColor == 1) {
+            if(g_time_yellow < MAX_LIGHT_TIME) g_time_yellow++;
+        } else {
+            // 红灯=绿+黄，不直接加：红/绿模式下都通过加绿实现
+            if(g_time_green < MAX_LIGHT_TIME) g_time_green++;
+        }
+    } else if(evt == EVT_KEY_DOWN) {
+        if(g_selectedColor == 1) {
+            // 黄灯模式：直接减黄灯时间
+            if(g_time_yellow > MIN_LIGHT_TIME) g_time_yellow--;
+        } else {
+            // 红灯模式通过减绿灯时间来减少红灯时间；绿灯模式直接减绿灯时间
+            if(g_time_green > MIN_LIGHT_TIME) g_time_green--;
         }
-        if(lastDown == 1 && curDown == 0 && debounceDown > 5) {
-            debounceDown = 0;  // 重置消抖计数器
-            if(g_selectedColor == 0) {
-                // 红灯模式：通过减绿灯时间来减少红灯时间
-                if(g_time_green > MIN_LIGHT_TIME) g_time_green--;
-            } else if(g_selectedColor == 1) {
-                // 黄灯模式：直接减黄灯时间
-                if(g_time_yellow > MIN_LIGHT_TIME) g_time_yellow--;
-            } else if(g_selectedColor == 2) {
-                // 绿灯模式：直接减绿灯时间
-                if(g_time_green > MIN_LIGHT_TIME) g_time_green--;
+    } else {
+        return 0;
+    }
+    // 更新红灯时间（红=绿+黄）
+    g_time_red = g_time_green + g_time_yellow;
+    return 1;
+}
+
+/*==============================================
+ *                主循环
+ *==============================================*/
+
+/**
+ * @brief  根据当前状态计算显示数值并写入帧缓冲
+ * @param  无
+ * @retval 无
+ * @note   只在有事件或按键时调用。读取 countdownBcd[] 不关中断：
+ *         每个寄存器都是单字节，中断每次修改它们之后都会投递事件，
+ *         若两次读取之间被中断改写，随后的事件会触发再次刷新，显示最终总是一致的
+ */
+static void Main_RefreshDisplay(void)
+{
+    unsigned char pos;
+
+#if FAST_BOOT_ENABLE
+    // 自检显示保持到第一个秒边界
+    if (mainSelfTest) {
+        return;
+    }
+#endif
+
+    // 设置模式下四位数码管闪烁，正常运行时常亮（状态不变时 Display_Blink 不重建时隙表）
+    for (pos = 0; pos < DISPLAY_DIGITS; pos++) {
+        Display_Blink((DisplayPos_t)pos, g_isSettingMode);
+    }
+
+    if(g_isSettingMode) {
+        // 设置模式：南北数码管显示颜色字母（r/y/G），东西数码管显示该颜色的时间（0-99，转BCD无除法）；
+        // 颜色不再用灯指示，灯输出始终是当前相位
+        static const unsigned char code settingTag[3] = {
+            (DISPLAY_BCD_R << 4) | DISPLAY_BCD_BLANK,
+            (DISPLAY_BCD_Y << 4) | DISPLAY_BCD_BLANK,
+            (DISPLAY_BCD_G << 4) | DISPLAY_BCD_BLANK
+        };
+        unsigned char showValue;
+        if(g_selectedColor == 0) showValue = g_time_red;
+        else if(g_selectedColor == 1) showValue = g_time_yellow;
+        else showValue = g_time_green;
+        showValue = Display_ToBcd(showValue);
+        Display_ShowBcd(settingTag[(g_selectedColor < 3) ? g_selectedColor : 0], showValue);
+        // 跳过正常倒计时显示更新
+        return;
+    }
+    // ==========================================
+    // 计算显示数值（由主循环计算，Timer0中断显示）
+    // ==========================================
+    // 两个方向的倒计时由Timer0中断以压缩BCD维护（相位切换时装载，每秒递减），
+    // 这里只按半字节查表写入帧缓冲，无除法和逐相位计算
+    Display_ShowBcd(countdownBcd[0], countdownBcd[1]);
+}
+
+/**
+ * @brief  主循环单次执行（处理中断投递的秒/相位/按键事件）
+ * @param  无
+ * @retval 无
+ * @note   单独成函数，便于主机仿真程序逐次调用（见 host/sim.cpp）
+ *         没有按键和事件时不做任何计算，也不会关中断
+ */
+static void Main_Poll(void)
+{
+    unsigned char refresh = 0;
+    unsigned char evt;
+
+#if WDT_ENABLE
+    // 向节拍报到：节拍只在主循环运行过之后喂狗
+    wdtMainAlive = 1;
+#endif
+
+    // 取空事件队列（多个事件合并为一次刷新）
+    while ((evt = Event_Get()) != EVT_NONE) {
+        if (evt >= EVT_KEY_UP) {
+            // 按键已由Timer0节拍采样消抖；调整后立即显示新值，到下个半秒边界再继续闪烁
+            if (Keys_Handle(evt)) {
+                Display_BlinkPhase(1);
+                refresh = 1;
             }
-            // 更新红灯时间（红=绿+黄）
-            g_time_red = g_time_green + g_time_yellow;
+            continue;
+        }
+        if (evt == EVT_HALF_SECOND) {
+            Display_BlinkPhase(0);
+            continue;
         }
+        // EVT_SECOND / EVT_PHASE：秒边界
+#if FAST_BOOT_ENABLE
+        mainSelfTest = 0;
+#endif
+        Display_BlinkPhase(1);
+        refresh = 1;
+        if (!g_isSettingMode) {
+            // 队列满时丢弃，不等待
+            Buzzer_Play(Phase_BuzzerPattern());
+        }
+#if IDLE_STATS_ENABLE
+        // 每秒结算一次空闲统计
+        idleCountsLastSecond = idleCounts;
+        idleCounts = 0;
+#endif
+    }
+
+    if (refresh) {
+        Main_RefreshDisplay();
     }
 
-    lastSet = curSet;
-    lastUp = curUp;
-    lastDown = curDown;
+#if UART_ENABLE
+    // 遥测：有新快照时组帧入队，不等待发送
+    Telemetry_Poll();
+    // 远程命令：执行串口中断交来的命令，应答入队
+    Command_Poll();
+#endif
+    
+    // ==========================================
+    // 未来扩展功能
+    // ==========================================
+    // - 故障检测与报警
+    // - 温度监控（DS18B20）
+    // - 红外遥控接收
+}
+
+#if IDLE_STATS_ENABLE
+/**
+ * @brief  读取Timer0当前计数（运行中读取，防止TL0进位造成高低字节不一致）
+ */
+static unsigned int Main_Timer0Now(void)
+{
+    unsigned char h;
+    unsigned char l;
+
+    do {
+        h = TH0;
+        l = TL0;
+    } while (h != TH0);
+    return ((unsigned int)h << 8) | l;
+}
+#endif
+
+/**
+ * @brief  进入空闲模式，等待下一个中断
+ * @param  无
+ * @retval 无
+ * @note   置 PCON.IDL 后CPU停止取指，定时器和中断继续工作，数码管扫描不受影响；
+ *         任一中断（目前是每2ms的Timer0节拍）唤醒后先执行中断，返回后从这里继续。
+ *         若事件恰好在 Event_Get() 之后、休眠之前投递，最多推迟一个节拍处理。
+ *         空闲统计：休眠前后各读一次Timer0计数；期间节拍计数变化说明一直睡到溢出，
+ *         否则是被其他中断提前唤醒。节拍计数是中断维护的16位量，主循环读它不是原子的，
+ *         这里只比较低字节；入口计数读完后再确认节拍未变，剩下的窗口只有置 IDL 前的一条比较，
+ *         落在其中的节拍最多让该次休眠少记一个周期
+ */
+static void Main_Idle(void)
+{
+#if IDLE_ENABLE
+#if IDLE_STATS_ENABLE
+    unsigned int entry;
+    unsigned char tick;
+
+    // 只取节拍计数低字节（单字节读取是原子的，休眠期间最多走一个节拍）；
+    // 读取入口计数的过程中若来了节拍，入口属于上一周期，重读
+    do {
+        tick = (unsigned char)timer0Count;
+        entry = Main_Timer0Now();
+    } while ((unsigned char)timer0Count != tick);
+#endif
+
+    PCON |= PCON_IDL;
+
+#if IDLE_STATS_ENABLE
+    if ((unsigned char)timer0Count != tick) {
+        idleCounts += 0x10000UL - entry;
+    } else {
+        idleCounts += Main_Timer0Now() - entry;
+    }
+#endif
+#endif
 }
 
 /*==============================================
@@ -221,105 +452,21 @@ static void Keys_Scan(void)
  * @param  无
  * @retval 无
  */
-unsigned char tens = 0;
-unsigned char ones = 0;
 void main(void)
 {
+#if defined(__SDCC) && FAST_BOOT_ENABLE
+    // SDCC 的 crt0 清零了全部 idata：取回启动钩子暂存的热复位保留记录
+    Boot_Reclaim();
+#endif
     // 系统初始化
     System_Init();
+    Main_RefreshDisplay();
 
     
     // 主循环：定时器中断处理交通灯逻辑和显示刷新
-    // 主循环只负责计算显示数值，实际显示由Timer0中断处理
+    // 每个节拍唤醒一次：扫描按键、处理事件，然后进入空闲模式等待下一个中断
     while(1) {
-        // 扫描按键
-        Keys_Scan();
-        
-        if(g_isSettingMode) {
-            // 设置模式：数码管显示当前选颜色的时间（限制 0-99 -> 仅显示个位：显示秒数的最后一位，另一位显示高位）
-            unsigned char showValue;
-            if(g_selectedColor == 0) showValue = g_time_red;
-            else if(g_selectedColor == 1) showValue = g_time_yellow;
-            else showValue = g_time_green;
-            // 取十位和个位（但硬件现在仅两位，把十位放在南北，个位放东西）
-            tens = showValue / 10;
-            ones = showValue % 10;
-            if(tens > 9) tens = 9; // 安全限制
-            EA = 0;
-            nsTime = tens;
-            ewTime = ones;
-            EA = 1;
-            // 跳过正常倒计时显示更新
-            continue;
-        }
-        // ==========================================
-        // 计算显示数值（由主循环计算，Timer0中断显示）
-        // ==========================================
-        {
-            unsigned char tempState;
-            unsigned char tempTimeLeft;
-            unsigned char newNsTime, newEwTime;
-            
-            // 快速读取当前状态（关中断保护）
-            EA = 0;  // 关中断
-            tempState = currentState;
-            tempTimeLeft = timeLeft;
-            EA = 1;  // 开中断
-            
-            // 根据当前交通灯状态计算两个方向的剩余时间
-            // 【关键】：红灯方向显示需要等待的总时间
-            //          绿灯/黄灯方向显示当前剩余时间
-            switch(tempState) {
-                case STATE_NS_GREEN_EW_RED:     // 状态0: 南北绿灯，东西红灯
-                    newNsTime = tempTimeLeft;      // 南北：绿灯剩余时间（3→2→1）
-                    // 东西红灯需要等：当前绿灯剩余 + 后续黄灯时间
-                    newEwTime = tempTimeLeft + stateTimeTable[STATE_NS_YELLOW_EW_RED];
-                    break;
-                    
-                case STATE_NS_YELLOW_EW_RED:    // 状态1: 南北黄灯，东西红灯
-                    newNsTime = tempTimeLeft;      // 南北：黄灯剩余时间（3→2→1）
-                    newEwTime = tempTimeLeft;      // 东西：红灯即将结束（3→2→1）
-                    break;
-                    
-                case STATE_NS_RED_EW_GREEN:     // 状态2: 南北红灯，东西绿灯
-                    // 南北红灯需要等：当前东西绿灯剩余 + 后续东西黄灯时间
-                    newNsTime = tempTimeLeft + stateTimeTable[STATE_NS_RED_EW_YELLOW];
-                    newEwTime = tempTimeLeft;      // 东西：绿灯剩余时间（3→2→1）
-                    break;
-                    
-                case STATE_NS_RED_EW_YELLOW:    // 状态3: 南北红灯，东西黄灯
-                    newNsTime = tempTimeLeft;      // 南北：红灯即将结束（3→2→1）
-                    newEwTime = tempTimeLeft;      // 东西：黄灯剩余时间（3→2→1）
-                    break;
-                    
-                default:
-                    newNsTime = 0;
-                    newEwTime = 0;
-                    break;
-            }
-            
-            // 限制显示范围 (0-9)，因为只使用2个数码管
-            if (newNsTime > 9) newNsTime = 9;
-            if (newEwTime > 9) newEwTime = 9;
-            
-            // 更新全局显示变量（供Timer0中断使用）
-            EA = 0;  // 关中断
-            nsTime = newNsTime;
-            ewTime = newEwTime;
-            EA = 1;  // 开中断
-        }
-        
-        // ==========================================
-        // 未来扩展功能
-        // ==========================================
-        // - 按键扫描处理
-        // - 蓝牙通信处理
-        // - 故障检测与报警
-        // - 温度监控（DS18B20）
-        // - 红外遥控接收
-        
-        // 主循环延时，降低CPU占用
-        // 注意：不能延时太长，否则显示数值更新不及时
-        // Delay_ms(10);  // 可选：如果CPU占用过高可以加
+        Main_Poll();
+        Main_Idle();
     }
 }
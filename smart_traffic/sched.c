@@ -0,0 +1,128 @@
+/**************************************************
+ * 文件名:    sched.c
+ * 作者:
+ * 日期:      2025-10-17
+ * 描述:      节拍任务调度模块实现
+ *           任务表在 code 区，每个任务在 RAM 中只占一个减计数器；
+ *           按任务号 switch 直接调用任务函数而不经函数指针：Keil C51 的覆盖分析
+ *           看不到经指针的调用，中断与主循环的局部变量可能被分配到同一地址
+ **************************************************/
+
+#include "sched.h"
+#include "buzzer.h"
+#include "keys.h"
+#include "detector.h"
+#include "telemetry.h"
+
+/**
+ * 任务表项：
+ *   period : 运行周期（节拍）
+ *   offset : 第一次运行前空过的节拍数（错开同周期的任务）
+ *   budget : 单次运行的预算（Timer0计数）
+ */
+typedef struct {
+    unsigned char period;
+    unsigned char offset;
+    unsigned int budget;
+} SchedTask_t;
+
+static const SchedTask_t code schedTable[SCHED_TASKS] = {
+    /* SCHED_BUZZER    */ { 1,                     0,                      SCHED_COUNTS(SCHED_BUDGET_BUZZER) },
+    /* SCHED_KEYS      */ { KEY_SAMPLE_TICKS,      SCHED_KEYS_OFFSET,      SCHED_COUNTS(SCHED_BUDGET_KEYS) },
+#if ACTUATED_ENABLE
+    /* SCHED_DETECTOR  */ { DETECTOR_SAMPLE_TICKS, SCHED_DETECTOR_OFFSET,  SCHED_COUNTS(SCHED_BUDGET_DETECTOR) },
+#endif
+#if UART_ENABLE
+    /* SCHED_TELEMETRY */ { TELEMETRY_TICKS,       SCHED_TELEMETRY_OFFSET, SCHED_COUNTS(SCHED_BUDGET_TELEMETRY) },
+#endif
+};
+
+/*-----------------------全局变量定义-------------------------*/
+// 距下次运行的节拍数（初值 offset+1，与任务表的登记顺序一致）
+static unsigned char schedDown[SCHED_TASKS] = {
+    1,
+    SCHED_KEYS_OFFSET + 1,
+#if ACTUATED_ENABLE
+    SCHED_DETECTOR_OFFSET + 1,
+#endif
+#if UART_ENABLE
+    SCHED_TELEMETRY_OFFSET + 1,
+#endif
+};
+unsigned int schedMax[SCHED_TASKS];
+unsigned char schedOverruns[SCHED_TASKS];
+
+#if SCHED_BUDGET_ENABLE
+/**
+ * @brief  读取Timer0当前计数（运行中读取：高字节前后一致才采用）
+ */
+static unsigned int Sched_Now(void)
+{
+    unsigned char h;
+    unsigned char l;
+
+    do {
+        h = TH0;
+        l = TL0;
+    } while (h != TH0);
+    return ((unsigned int)h << 8) | l;
+}
+#endif
+
+/**
+ * @brief  运行一个任务
+ */
+static void Sched_Run(unsigned char id)
+{
+    switch (id) {
+        case SCHED_BUZZER:
+            Buzzer_Tick();
+            break;
+        case SCHED_KEYS:
+            Keys_Tick();
+            break;
+#if ACTUATED_ENABLE
+        case SCHED_DETECTOR:
+            Detector_Tick();
+            break;
+#endif
+#if UART_ENABLE
+        case SCHED_TELEMETRY:
+            Telemetry_Tick();
+            break;
+#endif
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief  节拍任务分派（Timer0中断上下文）
+ */
+void Sched_Tick(void)
+{
+    unsigned char i;
+#if SCHED_BUDGET_ENABLE
+    unsigned int t;
+#endif
+
+    for (i = 0; i < SCHED_TASKS; i++) {
+        if (--schedDown[i]) {
+            continue;
+        }
+        schedDown[i] = schedTable[i].period;
+#if SCHED_BUDGET_ENABLE
+        t = Sched_Now();
+        Sched_Run(i);
+        t = Sched_Now() - t;
+        if (t > schedMax[i]) {
+            schedMax[i] = t;
+        }
+        if (t > schedTable[i].budget && schedOverruns[i] != 0xFF) {
+            schedOverruns[i]++;
+        }
+#else
+        Sched_Run(i);
+#endif
+    }
+}
@@ -0,0 +1,49 @@
+/**************************************************
+ * 文件名:    sched.h
+ * 作者:
+ * 日期:      2025-10-17
+ * 描述:      节拍任务调度模块头文件
+ *           周期性的节拍任务（蜂鸣器、按键、检测器、遥测）登记在 code 区任务表中（周期、偏移、预算），
+ *           Timer0 中断每个节拍调用一次 Sched_Tick() 按表分派；偏移把各采样任务错开到不同节拍，
+ *           同一节拍最多运行一个非每拍任务，中断最坏耗时 = 固定部分 + 最长的一个任务，而不是全部任务之和。
+ *           每次运行按 Timer0 计数计时，超出预算计入 schedOverruns[]，最长耗时记在 schedMax[]
+ **************************************************/
+
+#ifndef __SCHED_H__
+#define __SCHED_H__
+
+#include "config.h"
+
+/*-----------------------任务号-------------------------------*/
+// 任务表下标；未启用的任务与前一个任务号相同、不登记，SCHED_TASKS 只计启用的任务
+#define SCHED_BUZZER    0
+#define SCHED_KEYS      1
+#define SCHED_DETECTOR  (SCHED_KEYS + ACTUATED_ENABLE)
+#define SCHED_TELEMETRY (SCHED_DETECTOR + UART_ENABLE)
+#define SCHED_TASKS     (SCHED_TELEMETRY + 1)
+
+/*-----------------------函数声明-----------------------------*/
+
+/**
+ * @brief  节拍任务分派（只能在Timer0中断中调用，每个节拍一次）
+ * @param  无
+ * @retval 无
+ * @note   每个任务只做一次减1和判0；到期的任务按任务号顺序运行，
+ *         任务在第 offset+1 个节拍第一次运行，之后每 period 个节拍一次
+ *         须放在本节拍的相位切换和冲突监视之后（遥测快照要取到本节拍的结果）
+ */
+void Sched_Tick(void);
+
+/*-----------------------外部变量声明-------------------------*/
+
+/**
+ * @brief  各任务单次运行的最长耗时（Timer0计数，SCHED_BUDGET_ENABLE=1 时记录）
+ */
+extern unsigned int schedMax[SCHED_TASKS];
+
+/**
+ * @brief  各任务超出预算的次数（255封顶）
+ */
+extern unsigned char schedOverruns[SCHED_TASKS];
+
+#endif /* __SCHED_H__ */
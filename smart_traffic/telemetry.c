@@ -0,0 +1,82 @@
+/**************************************************
+ * 文件名:    telemetry.c
+ * 作者:
+ * 日期:      2025-10-17
+ * 描述:      串口遥测模块实现
+ *           快照交接：tlmReady 为0时只由中断写快照并置1，为1时只由主循环读取并清0，
+ *           与事件队列（event.c）相同，位标志交接不需要关中断（SETB/CLR 是原子的）
+ **************************************************/
+
+#include "telemetry.h"
+#include "traffic_light.h"
+#include "uart.h"
+
+/*-----------------------全局变量定义-------------------------*/
+volatile unsigned char tlmSeq = 0;                      // 快照序号
+static volatile bit tlmReady = 0;                       // 1=快照待主循环取走
+static unsigned char idata tlmSnap[5];                  // 快照：SEQ PHASE LEFT PLAN FLAGS（FAULT另存）
+static unsigned char tlmFault = MON_OK;
+
+/**
+ * @brief  遥测节拍处理（Timer0中断上下文）
+ */
+void Telemetry_Tick(void)
+{
+    tlmSeq++;
+    if (tlmReady) {
+        return;                 // 主循环还没取走上一份：本次不抓取，接收端看到序号跳变
+    }
+
+    tlmSnap[0] = tlmSeq;
+    tlmSnap[1] = currentState;
+    tlmSnap[2] = timeLeft;
+    tlmSnap[3] = (PHASE_PLAN << 4) | (planPending ? TLM_PLAN_PENDING : 0) | planActive
+#if ACTUATED_ENABLE
+                 | TLM_PLAN_ACTUATED
+#endif
+                 ;
+    tlmSnap[4] = (emgStage != EMG_IDLE ? TLM_F_EMERGENCY : 0) | (isFlashing ? TLM_F_FLASHING : 0) |
+                 (flashStage != FLASH_OFF ? TLM_F_FLASHMODE : 0) | (forcePhase != PHASE_NONE ? TLM_F_FORCE : 0);
+    tlmFault = monFault;
+    tlmReady = 1;               // 最后置位：快照对主循环可见
+}
+
+/**
+ * @brief  组帧发送（主循环上下文）
+ */
+void Telemetry_Poll(void)
+{
+    unsigned char frame[TLM_STATUS_FRAME];
+    unsigned char crc;
+    unsigned char i;
+
+    if (!tlmReady) {
+        return;
+    }
+    frame[0] = TLM_SYNC;
+    frame[1] = TLM_TYPE_STATUS;
+    frame[2] = TLM_STATUS_LEN;
+    frame[3] = tlmSnap[0];
+    frame[4] = tlmSnap[1];
+    frame[5] = tlmSnap[2];
+    frame[6] = tlmSnap[3];
+    frame[9] = tlmSnap[4];
+    frame[10] = tlmFault;
+    tlmReady = 0;               // 快照已复制，中断可以写下一份
+
+    // 配时与设置模式由主循环维护，这里直接读取
+    frame[7] = g_time_green;
+    frame[8] = g_time_yellow;
+    if (g_isSettingMode) {
+        frame[9] |= TLM_F_SETTING;
+    }
+
+    crc = 0;
+    for (i = 1; i < TLM_STATUS_FRAME - 1; i++) {
+        crc = Uart_Crc8(crc, frame[i]);
+    }
+    frame[TLM_STATUS_FRAME - 1] = crc;
+
+    // 发送缓冲区满时丢弃本帧（计入 uartTxDropped），接收端看到序号跳变
+    Uart_Send(frame, TLM_STATUS_FRAME);
+}
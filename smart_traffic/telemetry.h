@@ -0,0 +1,79 @@
+/**************************************************
+ * 文件名:    telemetry.h
+ * 作者:
+ * 日期:      2025-10-17
+ * 描述:      串口遥测模块头文件
+ *           Timer0 节拍每 TELEMETRY_TICKS 抓取一次状态快照（同一次中断内读取，相位/剩余时间一致），
+ *           主循环取走快照、组成二进制帧交给串口发送队列，不等待发送完成
+ *
+ *           帧格式（字段均为单字节）：
+ *             0xA5 | TYPE | LEN | 负载（LEN字节） | CRC-8（TYPE..负载，多项式0x07，初值0）
+ *           状态帧 TYPE=0x01，LEN=8：
+ *             [0] SEQ     快照序号（8位回绕；接收端据此发现丢帧）
+ *             [1] PHASE   当前相位（相位表下标）
+ *             [2] LEFT    当前相位剩余秒数
+ *             [3] PLAN    高4位相位方案 PHASE_PLAN；bit3 感应控制；bit1 有待切换的配时；bit0 生效方案
+ *             [4] GREEN   配置的绿灯时间（秒）
+ *             [5] YELLOW  配置的黄灯时间（秒）
+ *             [6] FLAGS   TLM_F_*
+ *             [7] FAULT   冲突监视故障（MON_*，0=正常）
+ *           命令与应答帧见 command.h；主机端编解码见 host/tlm_decode.cpp
+ **************************************************/
+
+#ifndef __TELEMETRY_H__
+#define __TELEMETRY_H__
+
+#include "config.h"
+
+/*-----------------------帧格式-------------------------------*/
+#define TLM_SYNC         0xA5
+#define TLM_TYPE_STATUS  0x01
+#define TLM_STATUS_LEN   8
+#define TLM_OVERHEAD     4      // 同步、类型、长度、CRC
+#define TLM_STATUS_FRAME (TLM_STATUS_LEN + TLM_OVERHEAD)
+
+// PLAN 字节
+#define TLM_PLAN_ACTUATED 0x08
+#define TLM_PLAN_PENDING  0x02
+#define TLM_PLAN_ACTIVE   0x01
+
+// FLAGS 字节
+#define TLM_F_SETTING     0x01  // 设置模式
+#define TLM_F_EMERGENCY   0x02  // 紧急优先进行中
+#define TLM_F_FLASHING    0x04  // 本秒有灯在后半秒熄灭
+#define TLM_F_FLASHMODE   0x08  // 闪光运行（含退出前的全红）
+#define TLM_F_FORCE       0x10  // 有待执行的强制相位
+
+#if TLM_STATUS_FRAME > UART_TX_SIZE
+#error "UART_TX_SIZE 放不下一帧遥测"
+#endif
+// 每字节10位；遥测最多占用串口带宽的一半，留给命令应答
+#if TELEMETRY_HZ * TLM_STATUS_FRAME * 10 > UART_BAUD / 2
+#error "遥测帧率超过串口带宽的一半，请降低 TELEMETRY_HZ 或提高 UART_BAUD"
+#endif
+
+/*-----------------------函数声明-----------------------------*/
+
+/**
+ * @brief  遥测节拍处理（只能在Timer0中断中调用）
+ * @param  无
+ * @retval 无
+ * @note   由节拍任务调度（sched.c）每 TELEMETRY_TICKS 个节拍调用一次；
+ *         主循环若还没取走上一份快照则跳过本次（序号照常加1）
+ */
+void Telemetry_Tick(void);
+
+/**
+ * @brief  组帧发送（只能在主循环中调用）
+ * @param  无
+ * @retval 无
+ * @note   没有新快照时只判断一次标志；发送缓冲区满时整帧丢弃，不等待
+ */
+void Telemetry_Poll(void);
+
+/**
+ * @brief  快照序号（Timer0每个遥测周期加1，8位回绕）
+ */
+extern volatile unsigned char tlmSeq;
+
+#endif /* __TELEMETRY_H__ */
@@ -14,17 +14,19 @@
 unsigned char countdown = 9;
 
 /**
- * @brief  Timer0中断服务函数 - 1秒定时
+ * @brief  Timer0中断服务函数 - 2ms扫描 + 1秒定时
  */
 void Timer0_ISR(void) interrupt 1
 {
-    static unsigned char count = 0;
+    static unsigned int count = 0;
     
-    TH0 = (65536 - 50000) / 256;  // 重装载
-    TL0 = (65536 - 50000) % 256;
+    TH0 = (65536 - 2000) / 256;   // 重装载
+    TL0 = (65536 - 2000) % 256;
+    
+    Display_Scan();               // 每2ms点亮一位数码管
     
     count++;
-    if (count >= 20)  // 20次 × 50ms = 1秒
+    if (count >= 500)  // 500次 × 2ms = 1秒
     {
         count = 0;
         
@@ -37,13 +39,13 @@ void Timer0_ISR(void) interrupt 1
 }
 
 /**
- * @brief  Timer0初始化：1秒定时
+ * @brief  Timer0初始化：2ms定时
  */
 void Timer0_Init(void)
 {
     TMOD = 0x01;  // Timer0模式1（16位定时器）
-    TH0 = (65536 - 50000) / 256;
-    TL0 = (65536 - 50000) % 256;
+    TH0 = (65536 - 2000) / 256;
+    TL0 = (65536 - 2000) % 256;
     TR0 = 1;      // 启动Timer0
     ET0 = 1;      // 使能Timer0中断
 }
@@ -62,7 +64,7 @@ void main(void)
     EA = 1;  // 开启总中断
     
     // 测试说明：通过Delay_s延时查看效果
-    // 方式1：使用阻塞式刷新（推荐）
+    // 显示刷新完全由Timer0中断完成，主循环只写帧缓冲
     Delay_s(2);  // 等待2秒
     
     while(1)
@@ -106,15 +108,13 @@ void main(void)
  * ✅ 每秒数字准确变化一次
  * 
  * 【如果出现闪烁】
- * 1. 检查 Display_ShowTime_1s() 中的刷新次数（当前200次）
- * 2. 增加刷新次数到300或400
- * 3. 检查每次刷新的延时时间（当前30×10循环）
+ * 1. 检查Timer0是否按2ms产生中断（ET0/EA是否打开）
+ * 2. 检查 Display_Scan() 是否在中断中被调用
  * 
  * 【性能说明】
- * - 单次刷新：约5ms（两个数码管各2ms）
- * - 1秒刷新次数：200次
- * - 刷新频率：200Hz（远超人眼50Hz临界值）
- * - CPU占用：较高（因为主循环一直在刷新）
+ * - 每次中断只点亮一位：消隐 → 位选 → 段码，约20个机器周期
+ * - 每位刷新频率：250Hz（远超人眼50Hz临界值）
+ * - CPU占用：极低（主循环不参与扫描）
  * 
  * ============================================================
  */
@@ -6,36 +6,34 @@
  *           提供标准的精确延时函数
  **************************************************/
 
-#include "timer.h"
-#include <intrins.h>  // 包含 _nop_() 函数
+#include "timer.h"   // config.h → hal.h 已包含 _nop_()
 
 /*==============================================
  *                全局变量
  *==============================================*/
 volatile unsigned int systemTime_s = 0;  // 系统运行时间（秒）
+static unsigned int secondDown = TIMEBASE_SEC_TICKS; // 本秒剩余节拍数（减计数）
+static unsigned long timebaseAcc = 0;    // 时间基准余数累加器（振荡周期，每秒更新一次）
 
 /*==============================================
  *                延时函数实现
  *==============================================*/
 
 /**
- * @brief  延时1毫秒（使用软件延时，简化实现）
+ * @brief  延时1毫秒（软件延时）
  * @param  无
  * @retval 无
- * @note   11.0592MHz晶振
- *         经过实测调整，确保1ms延时准确
+ * @note   循环次数由 config.h 按 FOSC / CPU_CLK_DIV / CPU_DJNZ_CLKS 在编译期推导
+ *         内循环 while(--j) 编译为 DJNZ Rn，总次数 = (i-1)×256 + j
  */
 static void Delay_1ms(void)
 {
     unsigned char i, j;
     
-    // 11.0592MHz晶振，经验值调整
-    // 外层循环2次，内层循环184次
-    // 2 × 184 × 约2.7us ≈ 1ms
     _nop_();
     _nop_();
-    i = 2;
-    j = 199;
+    i = DELAY_1MS_OUTER;
+    j = DELAY_1MS_INNER;
     do {
         while (--j);
     } while (--i);
@@ -58,11 +56,12 @@ void Delay_ms(unsigned int ms)
  * @brief  延时指定微秒数（软件延时）
  * @param  us: 延时时间（微秒）
  * @retval 无
- * @note   基于11.0592MHz晶振，软件延时
- *         机器周期约1.085us，每次循环约2个机器周期
+ * @note   每次循环约 DELAY_US_LOOP_CLKS 个振荡周期，循环次数 = us × DELAY_US_SCALE / 256
+ *         换算本身约需几十个机器周期，短延时（12T下<50us）会偏长
  */
 void Delay_us(unsigned int us)
 {
+    us = (unsigned int)(((unsigned long)us * DELAY_US_SCALE) >> 8);
     while(us--) {
         _nop_();  // 内部函数，1个机器周期
         _nop_();  // 内部函数，1个机器周期
@@ -96,6 +95,48 @@ unsigned int Get_SystemTime_s(void)
     return systemTime_s;
 }
 
+/**
+ * @brief  开始新的一秒：装载本秒节拍数
+ * @note   每秒把余数 TIMEBASE_FRAC_CLKS 累加一次，满一个节拍则本秒多计一拍，
+ *         第k秒结束于 k×整节拍数 + floor(k×余数/节拍长度) 个节拍处，误差始终小于一个节拍
+ */
+static void Timebase_StartSecond(void)
+{
+    secondDown = TIMEBASE_SEC_TICKS;
+    timebaseAcc += TIMEBASE_FRAC_CLKS;
+    if (timebaseAcc >= TIMEBASE_TICK_CLKS) {
+        timebaseAcc -= TIMEBASE_TICK_CLKS;
+        secondDown++;
+    }
+}
+
+/**
+ * @brief  时间基准节拍（减计数）
+ * @param  无
+ * @retval 1=跨过整秒边界，0=未到
+ * @note   每节拍只做一次16位减1和判零，无乘除法；
+ *         32位余数累加每秒才执行一次（Timebase_StartSecond）
+ */
+unsigned char Timebase_Tick(void)
+{
+    if (--secondDown == 0) {
+        Timebase_StartSecond();
+        systemTime_s++;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief  当前节拍是否为半秒边界
+ * @retval 1=距下一秒还剩 HALF_SECOND_TICKS 个节拍，0=否
+ * @note   与 Timebase_Tick() 共用本秒剩余节拍数，半秒边界与秒边界锁相
+ */
+unsigned char Timebase_IsHalfSecond(void)
+{
+    return secondDown == HALF_SECOND_TICKS;
+}
+
 /**
  * @brief  重置系统运行时间计数器
  * @param  无
@@ -104,6 +145,8 @@ unsigned int Get_SystemTime_s(void)
 void Reset_SystemTime(void)
 {
     systemTime_s = 0;
+    timebaseAcc = 0;
+    Timebase_StartSecond();
 }
 
 /*==============================================
@@ -112,7 +155,7 @@ void Reset_SystemTime(void)
 
 /**
  * @brief  测试延时精度（在数码管上显示倒计时）
- * @param  testSeconds: 测试秒数（0-9）
+ * @param  testSeconds: 测试秒数（0-99）
  * @retval 无
  * @note   通过数码管显示倒计时来验证延时是否准确
  *         每秒数字递减，用于观察1秒延时是否准确
@@ -123,7 +166,7 @@ void Test_DelayAccuracy(unsigned char testSeconds)
     extern void Display_ShowTime(unsigned char nsTime, unsigned char ewTime);
     
     // 限制测试范围
-    if (testSeconds > 9) testSeconds = 9;
+    if (testSeconds > 99) testSeconds = 99;
     
     // 倒计时显示
     for(count = testSeconds; count > 0; count--) {
@@ -16,10 +16,10 @@
  *==============================================*/
 
 /**
- * @brief  延时指定毫秒数（使用Timer1实现精确延时）
+ * @brief  延时指定毫秒数（软件延时）
  * @param  ms: 延时时间，单位毫秒（建议范围: 1-65535ms）
  * @retval 无
- * @note   基于11.0592MHz晶振，使用Timer1模式1
+ * @note   循环次数由 config.h 按晶振和内核分频在编译期推导
  */
 void Delay_ms(unsigned int ms);
 
@@ -27,7 +27,7 @@ void Delay_ms(unsigned int ms);
  * @brief  延时指定微秒数（使用软件延时）
  * @param  us: 延时时间，单位微秒（建议范围: 1-65535us）
  * @retval 无
- * @note   基于11.0592MHz晶振，软件延时，精度约±5%
+ * @note   软件延时，循环次数按晶振和内核分频换算，精度约±5%
  */
 void Delay_us(unsigned int us);
 
@@ -47,7 +47,24 @@ void Delay_s(unsigned char sec);
 unsigned int Get_SystemTime_s(void);
 
 /**
- * @brief  重置系统运行时间计数器
+ * @brief  时间基准节拍（减计数 + 每秒一次的余数累加，Bresenham方式）
+ * @param  无
+ * @retval 1=本节拍跨过一个整秒边界，0=未到
+ * @note   在Timer0中断中每个节拍调用一次
+ *         每节拍只对本秒剩余节拍数减1；每秒累加 FOSC 除以节拍长度的余数，
+ *         满一个节拍时该秒多计一拍，因此任意晶振下长期累计误差为0
+ */
+unsigned char Timebase_Tick(void);
+
+/**
+ * @brief  当前节拍是否为半秒边界（紧接 Timebase_Tick() 之后调用）
+ * @param  无
+ * @retval 1=本秒刚过去一半（距下一秒 HALF_SECOND_TICKS 个节拍），0=否
+ */
+unsigned char Timebase_IsHalfSecond(void);
+
+/**
+ * @brief  重置系统运行时间计数器（同时清零时间基准累加器）
  * @param  无
  * @retval 无
  */
@@ -55,7 +72,7 @@ void Reset_SystemTime(void);
 
 /**
  * @brief  测试延时精度（在数码管上显示倒计时）
- * @param  testSeconds: 测试秒数（0-9）
+ * @param  testSeconds: 测试秒数（0-99）
  * @retval 无
  * @note   通过数码管显示倒计时来验证延时是否准确
  */
@@ -7,127 +7,790 @@
  **************************************************/
 
 #include "traffic_light.h"
-#include "display.h"  // 用于在中断中调用 Display_ShowTime()
+#include "display.h"  // 用于在中断中调用 Display_Scan()
+#include "timer.h"    // 时间基准 Timebase_Tick()
+#include "event.h"    // 向主循环投递事件
+#include "buzzer.h"   // 相位的蜂鸣器音型（BUZZER_PAT_*）
+#include "sched.h"    // 节拍任务分派（按键、蜂鸣器、检测器、遥测）
+#include "detector.h" // 车辆检测器到达记录（感应控制）
 
 
 /*-----------------------全局变量定义-------------------------*/
 // 简化版本的全局状态变量（供main.c使用）
-volatile unsigned char currentState = STATE_NS_GREEN_EW_RED;    // 当前交通灯状态
+volatile unsigned char currentState = 0;                        // 当前相位（相位表下标）
 volatile unsigned char timeLeft = GREEN_LIGHT_TIME;             // 当前状态剩余时间
-volatile unsigned char isFlashing = 0;                          // 闪烁标志
+volatile bit isFlashing = 0;                                    // 闪烁标志
 volatile unsigned int timer0Count = 0;                          // Timer0中断计数器
-volatile unsigned int flashCount = 0;                           // 闪烁计数器
-
-// 外部变量声明（来自main.c的显示变量）
-extern volatile unsigned char nsTime;
-extern volatile unsigned char ewTime;
-
-// 状态时间配置表（各状态持续时间）
-unsigned char stateTimeTable[4] = {
-    GREEN_LIGHT_TIME,   // STATE_NS_GREEN_EW_RED
-    YELLOW_LIGHT_TIME,  // STATE_NS_YELLOW_EW_RED
-    GREEN_LIGHT_TIME,   // STATE_NS_RED_EW_GREEN
-    YELLOW_LIGHT_TIME   // STATE_NS_RED_EW_YELLOW
+volatile unsigned char countdownBcd[2] = {0, 0};                // 两个方向倒计时（压缩BCD，中断每秒递减）
+static unsigned int countdownHigh[2] = {0, 0};                  // 倒计时超出99的部分（秒）
+static unsigned char flashLamps = 0;                            // 本秒后半秒熄灭的灯位（P2，0=不闪）
+#if PHASE_PLAN == PHASE_PLAN_FULL
+static unsigned char flashAux = 0;                              // 本秒后半秒熄灭的扩展灯位（P0）
+#endif
+volatile unsigned char emgRequest = 0;                          // 紧急请求（EMG_REQ_*，INT0/INT1中断置位，Timer0接管时清除）
+volatile unsigned char emgStage = EMG_IDLE;                     // 紧急优先阶段（EMG_*）
+static unsigned char emgDir = 0;                                // 正在服务的方向（PT_NS/PT_EW）
+static unsigned char emgLeft = 0;                               // 本阶段剩余秒数
+static unsigned char emgHold = 0;                               // 紧急绿灯已保持的秒数
+static unsigned char emgIeMask = 0;                             // 临界区结束时恢复的IE位（设置模式下为0）
+static unsigned char emgEntryNs = LAMP_ALL_RED;                 // 南北请求到来时中断立即写出的灯
+static unsigned char emgEntryEw = LAMP_ALL_RED;                 // 东西请求到来时中断立即写出的灯
+static unsigned char lampNow = LAMP_ALL_RED;                    // 当前灯输出（不含闪烁熄灭）
+#if ACTUATED_ENABLE
+static unsigned char actCall = 0;                               // 等待放行的方向（DET_BIT_*，有车时登记，该方向绿灯开始时清除）
+static unsigned char actPhase = 0xFF;                           // 上一秒的相位（改变即新绿灯开始计时）
+static unsigned char actRun = 0;                                // 本绿灯已放行秒数
+static unsigned char actGap = 0;                                // 本绿灯方向距上一辆车的秒数
+#endif
+volatile unsigned char monFault = MON_OK;                       // 冲突监视故障（MON_*，锁定到复位）
+volatile unsigned char monFaultLamps = 0;                       // 故障时读到的灯输出（P2 & LAMP_MASK）
+volatile unsigned char monFaultAux = 0;                         // 故障时读到的扩展灯输出（P0 & AUX_MASK）
+static unsigned char monLamps = LAMP_ALL_RED;                   // 故障后每节拍重写的灯输出（红灯闪烁）
+volatile unsigned char forcePhase = PHASE_NONE;                 // 待执行的强制相位（主循环写，Timer0跳转后清除）
+volatile bit flashReq = 0;                                      // 1=请求闪光运行（主循环写）
+volatile unsigned char flashStage = FLASH_OFF;                  // 闪光运行阶段（FLASH_*）
+static unsigned char flashLeft = 0;                             // 退出闪光的全红剩余秒数
+volatile bit countdownStale = 0;                                // 主循环改写配时后置1，Timer0重算倒计时后清0
+#if WDT_ENABLE
+volatile bit wdtMainAlive = 0;                                  // 主循环报到（主循环置1，节拍喂狗后清0）
+#endif
+#if ISR_PROFILE_ENABLE
+volatile unsigned int isrMaxCycles = 0;                         // Timer0中断实测最坏耗时（机器周期）
+#endif
+#if FAST_BOOT_ENABLE
+HAL_IDATA_AT(volatile unsigned char, bootKeep[BOOT_KEEP_SIZE], BOOT_KEEP_ADDR); // 热复位保留记录（不初始化）
+#endif
+unsigned char bootMode = BOOT_COLD;                             // 本次启动方式（BOOT_*）
+
+/*-----------------------相位方案表---------------------------*/
+// 时长来源：可调绿灯 / 可调黄灯 / 表内固定值
+#define PHASE_TIME_GREEN  0
+#define PHASE_TIME_YELLOW 1
+#define PHASE_TIME_FIXED  2
+
+// greenAt[] 取值：该方向在本相位正在放行（显示本相位剩余时间）
+#define PHASE_MOVING      0xFF
+
+#define PT_NS 0    // greenAt 下标：南北
+#define PT_EW 1    // greenAt 下标：东西
+
+/**
+ * 相位表项（整表位于 code 区，不占RAM）
+ *   lamps    : P2灯输出字节（LAMP_*）
+ *   aux      : P0.4-P0.7扩展灯字节（AUX_*）
+ *   timeSel  : 时长来源（PHASE_TIME_*）
+ *   duration : 固定时长（timeSel==PHASE_TIME_FIXED时使用）
+ *   minTime  : 最短时长，可调时长低于此值时取此值
+ *   maxTime  : 最长时长
+ *   next     : 下一相位
+ *   greenAt  : 各方向下一次开始放行的相位；PHASE_MOVING=正在放行
+ *   flash    : 最后 FLASH_START_TIME 秒内闪烁的灯位（LAMP_*，须是 lamps 的子集）
+ *   auxFlash : 同上，扩展灯位（AUX_*，须是 aux 的子集）
+ * 相位必须按周期顺序排列（next 一般为下标+1，末项回到0），红灯倒计时依赖这一点
+ */
+typedef struct {
+    unsigned char lamps;
+    unsigned char aux;
+    unsigned char timeSel;
+    unsigned char duration;
+    unsigned char minTime;
+    unsigned char maxTime;
+    unsigned char next;
+    unsigned char greenAt[2];
+    unsigned char flash;
+    unsigned char auxFlash;
+} Phase_t;
+
+#define M PHASE_MOVING
+#define G PHASE_TIME_GREEN
+#define Y PHASE_TIME_YELLOW
+#define F PHASE_TIME_FIXED
+#define NSG (LAMP_NS_GREEN | LAMP_EW_RED)
+#define NSY (LAMP_NS_YELLOW | LAMP_EW_RED)
+#define EWG (LAMP_NS_RED | LAMP_EW_GREEN)
+#define EWY (LAMP_NS_RED | LAMP_EW_YELLOW)
+#define ARD LAMP_ALL_RED
+#define LT  MIN_LIGHT_TIME
+#define MT  MAX_LIGHT_TIME
+#define FNG LAMP_NS_GREEN
+#define FNY LAMP_NS_YELLOW
+#define FEG LAMP_EW_GREEN
+#define FEY LAMP_EW_YELLOW
+
+static const Phase_t code phasePlan[PHASE_COUNT] = {
+#if PHASE_PLAN == PHASE_PLAN_BASIC
+    /* lamps aux           sel dur              min max next greenAt   flash auxFlash */
+    {  NSG,  0,            G,  0,               LT, MT, 1,  { M, 2 },  FNG,  0 },  // 0 南北绿
+    {  NSY,  0,            Y,  0,               LT, MT, 2,  { M, 2 },  FNY,  0 },  // 1 南北黄
+    {  EWG,  0,            G,  0,               LT, MT, 3,  { 0, M },  FEG,  0 },  // 2 东西绿
+    {  EWY,  0,            Y,  0,               LT, MT, 0,  { 0, M },  FEY,  0 },  // 3 东西黄
+#elif PHASE_PLAN == PHASE_PLAN_ALLRED
+    {  NSG,  0,            G,  0,               LT, MT, 1,  { M, 3 },  FNG,  0 },  // 0 南北绿
+    {  NSY,  0,            Y,  0,               LT, MT, 2,  { M, 3 },  FNY,  0 },  // 1 南北黄
+    {  ARD,  0,            F,  ALL_RED_TIME,    1,  5,  3,  { 0, 3 },  0,    0 },  // 2 全红清空
+    {  EWG,  0,            G,  0,               LT, MT, 4,  { 0, M },  FEG,  0 },  // 3 东西绿
+    {  EWY,  0,            Y,  0,               LT, MT, 5,  { 0, M },  FEY,  0 },  // 4 东西黄
+    {  ARD,  0,            F,  ALL_RED_TIME,    1,  5,  0,  { 0, 3 },  0,    0 },  // 5 全红清空
+#elif PHASE_PLAN == PHASE_PLAN_FULL
+    {  ARD,  AUX_NS_LEFT | AUX_PED_STOP,
+                           F,  LEFT_TURN_TIME,  5,  30, 1,  { 2, 7 },  0,    AUX_NS_LEFT },  // 0 南北保护左转
+    {  ARD,  AUX_PED_STOP, F,  ALL_RED_TIME,    1,  5,  2,  { 2, 7 },  0,    0 },  // 1 左转清空
+    {  NSG,  AUX_PED_STOP, G,  0,               LT, MT, 3,  { M, 7 },  FNG,  0 },  // 2 南北直行绿
+    {  NSY,  AUX_PED_STOP, Y,  0,               LT, MT, 4,  { M, 7 },  FNY,  0 },  // 3 南北黄
+    {  ARD,  AUX_PED_STOP, F,  ALL_RED_TIME,    1,  5,  5,  { 2, 7 },  0,    0 },  // 4 全红清空
+    {  ARD,  AUX_EW_LEFT | AUX_PED_STOP,
+                           F,  LEFT_TURN_TIME,  5,  30, 6,  { 2, 7 },  0,    AUX_EW_LEFT },  // 5 东西保护左转
+    {  ARD,  AUX_PED_STOP, F,  ALL_RED_TIME,    1,  5,  7,  { 2, 7 },  0,    0 },  // 6 左转清空
+    {  EWG,  AUX_PED_STOP, G,  0,               LT, MT, 8,  { 2, M },  FEG,  0 },  // 7 东西直行绿
+    {  EWY,  AUX_PED_STOP, Y,  0,               LT, MT, 9,  { 2, M },  FEY,  0 },  // 8 东西黄
+    {  ARD,  AUX_PED_STOP, F,  ALL_RED_TIME,    1,  5,  10, { 2, 7 },  0,    0 },  // 9 全红清空
+    {  ARD,  AUX_PED_WALK, F,  PED_WALK_TIME,   5,  30, 11, { 2, 7 },  0,    AUX_PED_WALK },  // 10 行人通行
+    {  ARD,  AUX_PED_STOP, F,  PED_CLEAR_TIME,  1,  10, 0,  { 2, 7 },  0,    0 },  // 11 行人清空
+#endif
+};
+
+#undef M
+#undef G
+#undef Y
+#undef F
+#undef NSG
+#undef NSY
+#undef EWG
+#undef EWY
+#undef ARD
+#undef LT
+#undef MT
+#undef FNG
+#undef FNY
+#undef FEG
+#undef FEY
+
+// 紧急优先结束后回到相位表的位置：请求方向放行相位之后的黄灯相位（下标 = PT_NS/PT_EW）
+// 紧急绿灯与该方向的放行相位灯色相同，从其黄灯接回周期不会出现非法的灯色跳变
+static const unsigned char code emgExitPhase[2] = {
+#if PHASE_PLAN == PHASE_PLAN_BASIC
+    1, 3
+#elif PHASE_PLAN == PHASE_PLAN_ALLRED
+    1, 4
+#elif PHASE_PLAN == PHASE_PLAN_FULL
+    3, 8
+#endif
 };
 
-// 原有的方向状态变量（保留用于扩展功能）
-unsigned char nsCurrentState = LIGHT_GREEN;     // 南北方向当前状态
-unsigned char ewCurrentState = LIGHT_RED;       // 东西方向当前状态
-unsigned char nsTimeLeft = DEFAULT_GREEN_TIME;  // 南北方向剩余时间
-unsigned char ewTimeLeft = DEFAULT_RED_TIME;    // 东西方向剩余时间
+// 配时方案（由 UpdateStateTimeTable() 按相位表和可调时间生成）双缓冲：
+// planActive 指向Timer0正在使用的一份（stateTimeTable/phaseStart），主循环只写另一份（影子），
+// 写完置 planPending，Timer0在周期边界翻转 planActive 生效，两边都不需要关中断
+unsigned char idata planTime[2][PHASE_COUNT];       // 相位时长
+// 相位起始时刻前缀和：planStart[k][p] = 相位0..p-1时长之和，planStart[k][PHASE_COUNT] = 周期
+// 红灯方向倒计时 = 本相位剩余 + (phaseStart[greenAt] - phaseStart[p+1])，无需逐状态计算
+unsigned int idata planStart[2][PHASE_COUNT + 1];
+volatile bit planActive = 0;                        // 生效中的一份（0/1，只由Timer0翻转）
+volatile bit planPending = 0;                       // 影子已写好，等待周期边界切换
+
+/**
+ * @brief  一次写出六个灯（P2.0-P2.5），不改变数码管位选P2.6/P2.7
+ * @param  lamps: 灯输出字节（LAMP_*）
+ * @retval 无
+ * @note   P2 ^= 编译为单条 XRL P2,A：读-改-写锁存器一次完成，
+ *         新旧灯色之间没有全灭或冲突的中间状态；掩码不含P2.6/P2.7，
+ *         中断里 Display_Scan() 用位操作切换译码器输入，二者互不覆盖。
+ *         正常运行时由Timer0中断切换相位，进入设置模式（中断不切换相位）时主循环重写一次当前相位；
+ *         紧急请求中断（INT0/INT1，高优先级）可以在任何时刻改写，
+ *         因此读取P2到写回之间必须处于 LAMP_LOCK() 临界区内
+ */
+static void Lamp_Write(unsigned char lamps)
+{
+    unsigned char port = P2;
+    P2 ^= (port ^ lamps) & LAMP_MASK;
+}
+
+#if PHASE_PLAN == PHASE_PLAN_FULL
+/**
+ * @brief  一次写出左转箭头与行人灯（P0.4-P0.7），不改变按键/蜂鸣器所在的P0.0-P0.3
+ */
+static void Aux_Write(unsigned char aux)
+{
+    unsigned char port = P0;
+    P0 ^= (port ^ aux) & AUX_MASK;
+}
+#endif
+
+/*-----------------------紧急优先（INT0/INT1）-----------------*/
+// 灯输出临界区：只屏蔽INT0/INT1（各一条 ANL/ORL IE 指令），区内只有直线代码和有限分支，没有循环；
+// 紧急请求的最坏响应 = 中断响应 + 最长临界区 + 中断入口到写P2，见 config.h
+#define EMG_IE_BITS    0x05    // IE 中的 EX0 | EX1
+#define LAMP_LOCK()    (IE &= (unsigned char)~EMG_IE_BITS)
+#define LAMP_UNLOCK()  (IE |= emgIeMask)
 
-// 时间设置变量
-static unsigned char nsGreenTime = DEFAULT_GREEN_TIME;
-static unsigned char nsYellowTime = DEFAULT_YELLOW_TIME;
-static unsigned char nsRedTime = DEFAULT_RED_TIME;
-static unsigned char ewGreenTime = DEFAULT_GREEN_TIME;
-static unsigned char ewYellowTime = DEFAULT_YELLOW_TIME;
-static unsigned char ewRedTime = DEFAULT_RED_TIME;
+/**
+ * @brief  某方向的紧急请求到来时应立即写出的灯色
+ * @param  lamps: 当前灯输出
+ * @param  dir:   请求方向（PT_NS/PT_EW）
+ * @retval 对向绿灯转为同方向黄灯，其余不变（请求方向的绿/黄灯继续，红灯方向保持红灯）
+ * @note   黄灯位 = 绿灯位 >> 1（LAMP_*）；扩展灯一律写成行人红灯、左转箭头熄灭，
+ *         左转与行人相位本身机动车全红，不需要黄灯过渡
+ */
+static unsigned char Emergency_EntryLamps(unsigned char lamps, unsigned char dir)
+{
+    unsigned char green = (dir == PT_NS) ? LAMP_EW_GREEN : LAMP_NS_GREEN;
 
-// 内部状态变量
-static unsigned char manualMode = 0;       // 手动控制模式标志
-static unsigned int blinkCounter = 0;      // 闪烁计数器
+    if (lamps & green) {
+        lamps ^= green | (green >> 1);
+    }
+    return lamps;
+}
 
-// 简化的状态机变量
-static unsigned char globalState = 0;      // 全局状态：0=NS绿EW红, 1=NS黄EW红, 2=NS红EW绿, 3=NS红EW黄
-static unsigned char globalTimeLeft = DEFAULT_GREEN_TIME;
+/**
+ * @brief  写出灯输出并更新紧急入口灯色（灯输出临界区）
+ * @param  lamps:  灯输出字节（LAMP_*）
+ * @param  aux:    扩展灯字节（AUX_*，仅 PHASE_PLAN_FULL）
+ * @param  byPlan: 1=相位表写入：已有紧急请求时放弃写入（灯输出归紧急优先控制）；
+ *                 0=紧急优先写入：期间再来的请求不改变灯色（入口灯色即当前灯色）
+ * @note   整体写入后没有被闪烁熄灭的灯，本秒不再闪烁（新相位由 Flash_Arm() 重新装载）
+ */
+static void Lamp_Apply(unsigned char lamps, unsigned char aux, unsigned char byPlan)
+{
+    unsigned char ns = lamps;
+    unsigned char ew = lamps;
+
+    if (byPlan) {
+        ns = Emergency_EntryLamps(lamps, PT_NS);
+        ew = Emergency_EntryLamps(lamps, PT_EW);
+    }
+
+    LAMP_LOCK();
+    if (!(byPlan && emgRequest)) {
+        Lamp_Write(lamps);
+        lampNow = lamps;
+        emgEntryNs = ns;
+        emgEntryEw = ew;
+        flashLamps = 0;
+        isFlashing = 0;
+#if PHASE_PLAN == PHASE_PLAN_FULL
+        // 左转箭头与行人灯（其余方案不驱动P0.4-P0.7）
+        Aux_Write(aux);
+        flashAux = 0;
+#endif
+    }
+    LAMP_UNLOCK();
+}
 
 /**
  * @brief  设置交通灯状态
- * @param  state: 交通灯状态(0-3)
+ * @param  state: 相位号(0 ~ PHASE_COUNT-1)，越界时全红（安全状态）
  * @retval 无
  */
 void SetTrafficLights(unsigned char state)
 {
-    // 先关闭所有交通灯
-    NS_RED_PIN = 0;    NS_YELLOW_PIN = 0;    NS_GREEN_PIN = 0;
-    EW_RED_PIN = 0;    EW_YELLOW_PIN = 0;    EW_GREEN_PIN = 0;
-    
-    // 根据状态设置对应的交通灯
-    switch(state) {
-        case STATE_NS_GREEN_EW_RED:     // 南北绿灯，东西红灯
-            NS_GREEN_PIN = 1;
-            EW_RED_PIN = 1;
-            break;
-            
-        case STATE_NS_YELLOW_EW_RED:    // 南北黄灯，东西红灯
-            NS_YELLOW_PIN = 1;
-            EW_RED_PIN = 1;
-            break;
-            
-        case STATE_NS_RED_EW_GREEN:     // 南北红灯，东西绿灯
-            NS_RED_PIN = 1;
-            EW_GREEN_PIN = 1;
-            break;
-            
-        case STATE_NS_RED_EW_YELLOW:    // 南北红灯，东西黄灯
-            NS_RED_PIN = 1;
-            EW_YELLOW_PIN = 1;
-            break;
-            
-        default:
-            // 异常状态：所有红灯亮起（安全状态）
-            NS_RED_PIN = 1;
-            EW_RED_PIN = 1;
-            break;
-    }
-}
-
-
-/**
- * @brief  处理交通灯闪烁逻辑
+    // 越界相位：全红（安全状态）
+    if (state < PHASE_COUNT) {
+        Lamp_Apply(phasePlan[state].lamps, phasePlan[state].aux, 1);
+    } else {
+        Lamp_Apply(LAMP_ALL_RED, AUX_PED_STOP, 1);
+    }
+}
+
+/**
+ * @brief  计算某方向的倒计时
+ * @param  phase: 当前相位
+ * @param  dir:   0=南北，1=东西
+ * @param  left:  当前相位剩余时间
+ * @retval 放行方向为本相位剩余时间；等待方向为到其下一次放行的总时间
+ */
+unsigned int Phase_Countdown(unsigned char phase, unsigned char dir, unsigned char left)
+{
+    unsigned char target;
+    unsigned int wait;
+
+    if (phase >= PHASE_COUNT) {
+        return 0;
+    }
+    target = phasePlan[phase].greenAt[dir];
+    if (target == PHASE_MOVING) {
+        return left;
+    }
+
+    // 本相位之后、放行相位之前各相位的时长之和（前缀和之差，跨周期时加一个周期）；
+    // 下一个周期按周期边界将要生效的方案计算，切换方案时倒计时不跳变
+    if (target > phase) {
+        wait = phaseStart[target] - phaseStart[phase + 1];
+    } else {
+        wait = phaseStart[PHASE_COUNT] - phaseStart[phase + 1] + planStart[planActive ^ planPending][target];
+    }
+    return wait + left;
+}
+
+/**
+ * @brief  按当前相位和剩余时间重新装载两个方向的BCD倒计时
+ * @note   相位切换（中断）和退出设置模式（主循环，此时中断不递减倒计时）时调用；
+ *         二进制转BCD每相位只做一次，每秒的递减直接在BCD上进行
+ */
+void Countdown_Reload(void)
+{
+    unsigned char d;
+    unsigned int v;
+
+    for (d = 0; d < 2; d++) {
+        v = Phase_Countdown(currentState, d, timeLeft);
+        if (v > 99) {
+            countdownHigh[d] = v - 99;
+            countdownBcd[d] = 0x99;
+        } else {
+            countdownHigh[d] = 0;
+            countdownBcd[d] = Display_ToBcd((unsigned char)v);
+        }
+    }
+}
+
+/**
+ * @brief  某方向倒计时减1秒（压缩BCD直接递减，无除法）
+ * @note   个位为0时减0x07：0x10→0x09，0x40→0x39；超出99的部分先递减
+ */
+static void Countdown_Dec(unsigned char d)
+{
+    unsigned char v;
+
+    if (countdownHigh[d]) {
+        countdownHigh[d]--;
+        return;
+    }
+    v = countdownBcd[d];
+    if (v == 0) {
+        return;
+    }
+    if ((v & 0x0F) == 0) {
+        v -= 0x07;
+    } else {
+        v--;
+    }
+    countdownBcd[d] = v;
+}
+
+/**
+ * @brief  两个方向的倒计时清零（冲突监视故障、闪光运行期间显示00）
+ */
+static void Countdown_Clear(void)
+{
+    countdownHigh[0] = 0;
+    countdownHigh[1] = 0;
+    countdownBcd[0] = 0;
+    countdownBcd[1] = 0;
+}
+
+/**
+ * @brief  按当前相位剩余时间装载本秒的闪烁掩码（须在 LAMP_LOCK() 临界区内调用）
+ * @note   剩余时间不超过 FLASH_START_TIME 时取相位表的 flash/auxFlash，否则为0；
+ *         有紧急请求时灯输出已归紧急优先控制，不再装载
+ */
+static void Flash_Arm(void)
+{
+    isFlashing = 0;
+    if (timeLeft <= FLASH_START_TIME && !emgRequest) {
+        flashLamps = phasePlan[currentState].flash;
+#if PHASE_PLAN == PHASE_PLAN_FULL
+        flashAux = phasePlan[currentState].auxFlash;
+        isFlashing = (flashLamps | flashAux) != 0;
+#else
+        isFlashing = flashLamps != 0;
+#endif
+    }
+}
+
+/**
+ * @brief  半秒边界：熄灭本秒闪烁的灯
+ * @note   掩码是当前灯位的子集，P2 ^= 编译为单条 XRL，不触及位选；
+ *         掩码为0时等于什么都不做，不需要判断。
+ *         紧急请求中断会清除掩码，读掩码到异或之间不能被它打断
+ */
+static void Flash_HalfSecond(void)
+{
+    LAMP_LOCK();
+    P2 ^= flashLamps;
+#if PHASE_PLAN == PHASE_PLAN_FULL
+    P0 ^= flashAux;
+#endif
+    LAMP_UNLOCK();
+}
+
+/**
+ * @brief  处理交通灯闪烁逻辑（秒边界，本秒不切换相位时调用）
  * @param  无
  * @retval 无
+ * @note   再异或一次同一掩码，恢复上半秒熄灭的灯，然后按新的剩余时间装载掩码。
+ *         亮/灭的切换都落在时间基准的秒/半秒边界上，与倒计时同相位；
+ *         每个节拍最多一次异或，没有单独的闪烁计数器和取模运算。
+ *         切换相位的秒边界不调用：SetTrafficLights() 整体写入新灯色并清除掩码
  */
 void HandleTrafficLightFlash(void)
 {
-    // 只在最后几秒进行闪烁
-    if (timeLeft <= FLASH_START_TIME && timeLeft > 0) {
-        isFlashing = 1;
-        
-        // 控制闪烁频率（约每500ms切换一次）
-        if ((flashCount % 250) == 0) {
-            // switch(currentState) {
-            //     case STATE_NS_GREEN_EW_RED:     // 南北绿灯闪烁
-            //         NS_GREEN_PIN = !NS_GREEN_PIN;
-            //         break;
-                    
-            //     case STATE_NS_YELLOW_EW_RED:    // 南北黄灯闪烁
-            //         NS_YELLOW_PIN = !NS_YELLOW_PIN;
-            //         break;
-                    
-            //     case STATE_NS_RED_EW_GREEN:     // 东西绿灯闪烁
-            //         EW_GREEN_PIN = !EW_GREEN_PIN;
-            //         break;
-                    
-            //     case STATE_NS_RED_EW_YELLOW:    // 东西黄灯闪烁
-            //         EW_YELLOW_PIN = !EW_YELLOW_PIN;
-            //         break;
-            // }
+    LAMP_LOCK();
+    P2 ^= flashLamps;
+#if PHASE_PLAN == PHASE_PLAN_FULL
+    P0 ^= flashAux;
+    flashAux = 0;
+#endif
+    flashLamps = 0;
+    Flash_Arm();
+    LAMP_UNLOCK();
+}
+
+/**
+ * @brief  当前秒应播放的蜂鸣器音型
+ * @note   冲突监视故障后每秒一次警告音；闪光运行期间不提示；行人绿灯期间每秒一次高音啾声（FULL方案）；紧急优先期间每秒一声；
+ *         有闪烁灯的相位在最后 BUZZER_THRESHOLD 秒每秒一次警告音
+ */
+unsigned char Phase_BuzzerPattern(void)
+{
+    if (monFault) {
+        return BUZZER_PAT_WARN;
+    }
+    if (flashStage != FLASH_OFF) {
+        return BUZZER_PAT_NONE;
+    }
+#if PHASE_PLAN == PHASE_PLAN_FULL
+    if (phasePlan[currentState].aux & AUX_PED_WALK) {
+        return BUZZER_PAT_CHIRP;
+    }
+#endif
+    if (emgStage != EMG_IDLE) {
+        return BUZZER_PAT_BEEP;
+    }
+    if (timeLeft <= BUZZER_THRESHOLD && phasePlan[currentState].flash) {
+        return BUZZER_PAT_WARN;
+    }
+    return BUZZER_PAT_NONE;
+}
+
+/*==============================================
+ *                感应控制
+ *==============================================*/
+#if ACTUATED_ENABLE
+// 保护左转、行人相位没有检测器，按固定请求处理：有这些相位的方案中绿灯不停留等待
+#define ACT_RECALL (PHASE_PLAN == PHASE_PLAN_FULL)
+
+/**
+ * @brief  相位的感应放行方向
+ * @retval PT_NS/PT_EW：可调绿灯时长的放行相位；0xFF：其余相位（黄灯、清空、左转、行人）
+ */
+static unsigned char Actuated_GreenDir(unsigned char phase)
+{
+    if (phasePlan[phase].timeSel != PHASE_TIME_GREEN) {
+        return 0xFF;
+    }
+    return (phasePlan[phase].greenAt[PT_NS] == PHASE_MOVING) ? PT_NS : PT_EW;
+}
+
+/**
+ * @brief  感应控制秒处理（Timer0中断，正常运行的秒边界、倒计时递减之前调用）
+ * @retval 1=本秒照常递减 timeLeft；0=绿灯停留，本秒不递减（倒计时暂停）
+ * @note   其他方向的车辆登记为请求；放行方向每有车辆就重新计算车头时距：
+ *         - 已过 ACT_MIN_GREEN 且连续 ACT_PASSAGE_TIME 秒无车：剩余时间截为 FLASH_START_TIME+1（gap-out）
+ *         - 一直有车：走完可调绿灯时间（max-out）
+ *         - 冲突方向没有请求：停在 ACT_REST_TIME 等待，来车后再按上面两条结束
+ */
+static unsigned char Actuated_Second(void)
+{
+    unsigned char seen = Detector_Take();
+    unsigned char d = Actuated_GreenDir(currentState);
+    unsigned char own;
+
+    if (actPhase != currentState) {
+        actPhase = currentState;
+        actRun = 0;
+        actGap = 0;
+    }
+    if (d > PT_EW) {
+        actCall |= seen;
+        return 1;
+    }
+
+    // 放行方向的车辆直接通过，不登记请求（DET_BIT_EW = DET_BIT_NS << 1）
+    own = (unsigned char)(DET_BIT_NS << d);
+    actCall = (actCall | seen) & (unsigned char)~own;
+    if (actRun < 0xFF) {
+        actRun++;
+    }
+    if (seen & own) {
+        actGap = 0;
+    } else if (actGap < 0xFF) {
+        actGap++;
+    }
+
+    if (!(actCall & (own ^ DET_MASK)) && !ACT_RECALL) {
+        return timeLeft != ACT_REST_TIME;
+    }
+    if (actRun >= ACT_MIN_GREEN && actGap >= ACT_PASSAGE_TIME && timeLeft > FLASH_START_TIME + 1) {
+        timeLeft = FLASH_START_TIME + 1;
+        Countdown_Reload();
+    }
+    return 1;
+}
+
+/**
+ * @brief  感应控制下的下一相位
+ * @note   下一相位是没有请求的方向的放行相位，且它与其后的黄灯夹在两个全红相位之间时，
+ *         连同黄灯一起跳过（全红接全红，没有非法的灯色跳变）；
+ *         两相位方案没有这样的位置，由绿灯停留代替跳过
+ */
+static unsigned char Actuated_Next(unsigned char phase)
+{
+    unsigned char next = phasePlan[phase].next;
+    unsigned char d = Actuated_GreenDir(next);
+    unsigned char yellow;
+    unsigned char after;
+
+    if (d > PT_EW || (actCall & (DET_BIT_NS << d)) || phasePlan[phase].lamps != LAMP_ALL_RED) {
+        return next;
+    }
+    yellow = phasePlan[next].next;
+    after = phasePlan[yellow].next;
+    if (phasePlan[yellow].timeSel != PHASE_TIME_YELLOW || phasePlan[after].lamps != LAMP_ALL_RED) {
+        return next;
+    }
+    return after;
+}
+#else
+#define Actuated_Second()     1
+#define Actuated_Next(phase)  (phasePlan[phase].next)
+#endif
+
+/*==============================================
+ *                远程命令：强制相位与闪光运行
+ *==============================================*/
+// 相位放行判断：机动车绿灯，或左转箭头/行人绿灯
+#define PHASE_GO_LAMPS  (LAMP_NS_GREEN | LAMP_EW_GREEN)
+#define PHASE_GO_AUX    (AUX_NS_LEFT | AUX_EW_LEFT | AUX_PED_WALK)
+#define Phase_Moving(p) ((phasePlan[p].lamps & PHASE_GO_LAMPS) || (phasePlan[p].aux & PHASE_GO_AUX))
+
+/**
+ * @brief  相位能否作为强制相位的目标（串口中断 Command_Check() 调用）
+ * @param  phase: 相位号（须小于 PHASE_COUNT）
+ * @retval 1=可调绿灯相位或保护放行相位（左转箭头/行人绿灯）；0=黄灯、清空相位
+ * @note   黄灯只能由相位表从绿灯进入，跳到黄灯相位就是红灯直接变黄灯
+ */
+unsigned char Phase_Forcible(unsigned char phase)
+{
+    return phasePlan[phase].timeSel == PHASE_TIME_GREEN || (phasePlan[phase].aux & PHASE_GO_AUX);
+}
+
+/**
+ * @brief  相位 from 结束时能否不按相位表、直接进入灯色 toLamps
+ * @param  from:    正在结束的相位
+ * @param  toLamps: 跳转目标的灯输出（LAMP_*）
+ * @retval 1=可以跳转；0=继续按相位表运行，到下一个相位边界再判断
+ * @note   与感应控制只在全红之间跳过相位同理，跳转不能省掉任何过渡：
+ *         - from 本身没有放行（绿灯、左转箭头、行人绿灯都已结束）
+ *         - from 是黄灯且相位表在其后安排了全红清空时，等清空走完
+ *         - 黄灯方向不能直接回到绿灯（黄灯位 << 1 = 绿灯位）
+ *         - 目标不能亮黄灯（红灯不能直接变黄灯；Command_Check() 已拒绝这样的目标，此处兜底）
+ */
+static unsigned char Force_Allowed(unsigned char from, unsigned char toLamps)
+{
+    unsigned char yellow = phasePlan[from].lamps & (LAMP_NS_YELLOW | LAMP_EW_YELLOW);
+
+    if (Phase_Moving(from) || (toLamps & (LAMP_NS_YELLOW | LAMP_EW_YELLOW))) {
+        return 0;
+    }
+    if (yellow && phasePlan[phasePlan[from].next].lamps == LAMP_ALL_RED) {
+        return 0;
+    }
+    return !((unsigned char)(yellow << 1) & toLamps);
+}
+
+/**
+ * @brief  强制相位/闪光请求的秒处理（Timer0中断，有请求时代替 Actuated_Second() 调用）
+ * @retval 1=本秒照常递减 timeLeft（有请求时放行相位不停留等待）
+ * @note   当前相位就是目标时直接完成请求；否则有放行的相位剩余时间截为 FLASH_START_TIME+1，
+ *         与感应控制的 gap-out 相同，照常闪烁、黄灯、清空，到允许的相位边界再跳转
+ */
+static unsigned char Force_Second(void)
+{
+    if (currentState == forcePhase && !flashReq) {
+        forcePhase = PHASE_NONE;
+        return Actuated_Second();
+    }
+    if (Phase_Moving(currentState) && timeLeft > FLASH_START_TIME + 1) {
+        timeLeft = FLASH_START_TIME + 1;
+        Countdown_Reload();
+    }
+    return 1;
+}
+
+/**
+ * @brief  进入闪光运行（Timer0中断，允许跳转的相位边界调用）
+ * @note   闪光期间不响应紧急请求（与设置模式相同，灯输出归闪光控制），退出时恢复；
+ *         本节拍已锁存的请求一并丢弃。南北红灯先亮，闪烁掩码为两个方向的红灯，
+ *         半秒/秒边界各异或一次：南北红 ↔ 东西红，任何时刻都有一个方向亮红灯
+ */
+static void Flash_Enter(void)
+{
+    BOOT_FORGET();
+    emgIeMask = 0;
+    LAMP_LOCK();
+    emgRequest = 0;
+    LAMP_UNLOCK();
+    Lamp_Apply(LAMP_NS_RED, AUX_PED_STOP, 0);
+    LAMP_LOCK();
+    flashLamps = LAMP_ALL_RED;
+    isFlashing = 1;
+    LAMP_UNLOCK();
+    flashStage = FLASH_ON;
+    forcePhase = PHASE_NONE;
+    Countdown_Clear();
+}
+
+/**
+ * @brief  闪光运行秒处理（Timer0中断，闪光运行期间的秒边界调用）
+ * @retval 1=阶段改变（灯色改变），0=只切换了闪烁
+ * @note   撤销请求后全红 ALL_RED_TIME 秒，再从相位0开始新周期（同时切换待生效的配时方案），
+ *         丢弃闪光期间锁存的紧急请求边沿后恢复响应
+ */
+static unsigned char Flash_Second(void)
+{
+    if (flashStage == FLASH_ON) {
+        if (flashReq) {
+            LAMP_LOCK();
+            P2 ^= flashLamps;
+            LAMP_UNLOCK();
+            return 0;
         }
-    } else {
-        isFlashing = 0;
+        Lamp_Apply(LAMP_ALL_RED, AUX_PED_STOP, 0);
+        flashStage = FLASH_EXIT;
+        flashLeft = ALL_RED_TIME;
+        return 1;
+    }
+    if (--flashLeft) {
+        return 0;
     }
+    flashStage = FLASH_OFF;
+    Plan_Swap();
+    currentState = 0;
+    timeLeft = stateTimeTable[0];
+    SetTrafficLights(0);
+    Countdown_Reload();
+    LAMP_LOCK();
+    Flash_Arm();
+    LAMP_UNLOCK();
+    IE0 = 0;
+    IE1 = 0;
+    emgIeMask = EMG_IE_BITS;
+    IE |= EMG_IE_BITS;
+    return 1;
+}
+
+/*==============================================
+ *                快速启动
+ *==============================================*/
+#if FAST_BOOT_ENABLE
+/**
+ * @brief  记下当前相位和剩余时间（Timer0中断，按相位表运行的秒边界调用）
+ * @note   先写内容后写反码，写到一半复位时记录无效。在灯输出临界区内写：
+ *         紧急请求中断作废的记录不会被随后的写入恢复；本秒进入了闪光运行时不写
+ */
+static void Boot_Keep(void)
+{
+    LAMP_LOCK();
+    if (flashStage == FLASH_OFF && !emgRequest) {
+        bootKeep[BOOT_KEEP_PHASE] = currentState;
+        bootKeep[BOOT_KEEP_LEFT] = timeLeft;
+        bootKeep[BOOT_KEEP_NPHASE] = ~currentState;
+        bootKeep[BOOT_KEEP_NLEFT] = ~timeLeft;
+    }
+    LAMP_UNLOCK();
+}
+
+/**
+ * @brief  检查保留记录（热复位时调用）
+ * @retval 1=记录有效，已装入 currentState/timeLeft（剩余时间不超过当前方案的相位时长）
+ */
+static unsigned char Boot_Resume(void)
+{
+    unsigned char phase = bootKeep[BOOT_KEEP_PHASE];
+    unsigned char left = bootKeep[BOOT_KEEP_LEFT];
+    unsigned char valid = (unsigned char)~phase == bootKeep[BOOT_KEEP_NPHASE] &&
+                          (unsigned char)~left == bootKeep[BOOT_KEEP_NLEFT] &&
+                          phase < PHASE_COUNT && left != 0;
+
+    if (!valid) {
+        return 0;
+    }
+    currentState = phase;
+    timeLeft = (left < stateTimeTable[phase]) ? left : stateTimeTable[phase];
+    return 1;
+}
+
+#if defined(__SDCC)
+// SDCC 4.2 起启动钩子改名为 __sdcc_external_startup
+#if __SDCC_VERSION_MAJOR > 4 || (__SDCC_VERSION_MAJOR == 4 && __SDCC_VERSION_MINOR >= 2)
+#define BOOT_SDCC_STARTUP __sdcc_external_startup
+#else
+#define BOOT_SDCC_STARTUP _sdcc_external_startup
+#endif
+
+/**
+ * @brief  SDCC 启动钩子：crt0 设置好栈后、清零 RAM 和初始化全局变量之前调用
+ * @retval 0=照常清零并初始化全局变量
+ * @note   与 STARTUP.A51 相同，最先把端口写成全红（复位值0xFF会点亮全部灯）；
+ *         crt0 随后清零全部 idata，保留记录先暂存到 TL1/TH1/RCAP2L/RCAP2H（此时都未使用），
+ *         由 Boot_Reclaim() 在 main() 开头取回
+ */
+unsigned char BOOT_SDCC_STARTUP(void)
+{
+    P2 = BOOT_P2_SAFE;
+    P0 = BOOT_P0_SAFE;
+    TL1 = bootKeep[BOOT_KEEP_PHASE];
+    TH1 = bootKeep[BOOT_KEEP_LEFT];
+    RCAP2L = bootKeep[BOOT_KEEP_NPHASE];
+    RCAP2H = bootKeep[BOOT_KEEP_NLEFT];
+    return 0;
+}
+
+/**
+ * @brief  取回启动钩子暂存的保留记录
+ */
+void Boot_Reclaim(void)
+{
+    bootKeep[BOOT_KEEP_PHASE] = TL1;
+    bootKeep[BOOT_KEEP_LEFT] = TH1;
+    bootKeep[BOOT_KEEP_NPHASE] = RCAP2L;
+    bootKeep[BOOT_KEEP_NLEFT] = RCAP2H;
+}
+#endif
+#else
+#define Boot_Keep()
+#endif
+
+/**
+ * @brief  选择起始相位并写出灯色（System_Init() 调用，Timer0 尚未启动）
+ * @note   上电标志在这里清除，之后的复位（看门狗、复位键）都是热复位
+ */
+void Boot_Start(void)
+{
+    bootMode = BOOT_COLD;
+    currentState = 0;
+    timeLeft = stateTimeTable[0];
+#if FAST_BOOT_ENABLE
+    if (!(PCON & PCON_POF)) {
+        bootMode = Boot_Resume() ? BOOT_RESUME : BOOT_CLEAR;
+    }
+    // 记录只用一次（上电时是上次断电前的残留）：Timer0 第一个秒边界重新记下
+    BOOT_FORGET();
+    PCON &= (unsigned char)~PCON_POF;
+    if (bootMode == BOOT_CLEAR) {
+        // 复位前的灯色未知：保持初始化写出的全红，由 Flash_Second() 的退出阶段计时
+        emgIeMask = 0;
+        IE &= (unsigned char)~EMG_IE_BITS;
+        flashStage = FLASH_EXIT;
+        flashLeft = ALL_RED_TIME;
+        Countdown_Clear();
+        return;
+    }
+#endif
+    SetTrafficLights(currentState);
+    Countdown_Reload();
+    LAMP_LOCK();
+    Flash_Arm();
+    LAMP_UNLOCK();
 }
 
 /**
@@ -137,23 +800,339 @@ void HandleTrafficLightFlash(void)
  */
 void SwitchToNextState(void)
 {
-    // 循环切换到下一个状态
-    currentState = (currentState + 1) % 4;
+    // 按相位表切换到下一相位（感应控制时跳过没有车辆的放行相位）；
+    // 回绕或强制跳回前面的相位都按周期边界处理
+    unsigned char next = Actuated_Next(currentState);
+
+    // 远程命令：结束的相位允许直接跳转时进入闪光运行，或改为跳到强制相位
+    if (flashReq && Force_Allowed(currentState, LAMP_NS_RED)) {
+        Flash_Enter();
+        return;
+    }
+    if (forcePhase < PHASE_COUNT && Force_Allowed(currentState, phasePlan[forcePhase].lamps)) {
+        next = forcePhase;
+    }
+    if (next == forcePhase) {
+        forcePhase = PHASE_NONE;    // 跳转或按相位表到达目标相位，请求完成
+    }
+
+    // 相位序号回绕即新周期开始：先切换到主循环写好的配时方案，再装载新相位的时长
+    if (next <= currentState) {
+        Plan_Swap();
+    }
+    currentState = next;
     
-    // 设置新状态的时间
+    // 设置新相位的时间
     timeLeft = stateTimeTable[currentState];
     
-    // 设置交通灯硬件状态
+    // 设置交通灯硬件状态，装载新相位的倒计时和闪烁掩码（相位不长于 FLASH_START_TIME 时从第一秒起闪烁）
     SetTrafficLights(currentState);
-    
-    // 重置闪烁标志
-    isFlashing = 0;
+    Countdown_Reload();
+    LAMP_LOCK();
+    Flash_Arm();
+    LAMP_UNLOCK();
     
     // 状态切换指示：DEBUG_STATE_PIN闪烁一次
     DEBUG_STATE_PIN = 1;
     DEBUG_STATE_PIN = 0;
 }
 
+/*==============================================
+ *                紧急优先
+ *==============================================*/
+/**
+ * @brief  紧急优先期间两个方向的倒计时都显示本阶段剩余秒数
+ */
+static void Emergency_Countdown(void)
+{
+    countdownHigh[0] = 0;
+    countdownHigh[1] = 0;
+    countdownBcd[0] = Display_ToBcd(emgLeft);
+    countdownBcd[1] = countdownBcd[0];
+}
+
+/**
+ * @brief  紧急优先接管（Timer0中断，有未接管的请求时每个节拍调用）
+ * @note   请求中断已写出入口灯色；这里按实际灯输出决定清空时序：
+ *         - 请求方向已是绿灯：直接保持紧急绿灯
+ *         - 有黄灯：相位表自己的黄灯走完剩余时间，中断刚转成的黄灯走满对向黄灯相位的时长
+ *         - 机动车全红：相位表的清空相位走完剩余时间，被截断的左转/行人放行走满清空时间
+ *         中断发生在两个秒边界之间，刚开始的过渡按秒边界计数时多加1秒，保证不短于设定值
+ */
+static void Emergency_Enter(void)
+{
+    unsigned char cur;
+    unsigned char planLamps = phasePlan[currentState].lamps;
+    unsigned char planAux = phasePlan[currentState].aux;
+
+    emgDir = (emgRequest & EMG_REQ_NS) ? PT_NS : PT_EW;
+    emgRequest &= (unsigned char)~(EMG_REQ_NS << emgDir);
+    emgHold = 0;
+
+    // Timer0在中断之后、临界区之前已算好的新相位被放弃，当前灯输出仍是入口灯色；
+    // 再按请求方向转换一次并写出（同样的灯色不会产生可见变化）
+    Lamp_Apply(Emergency_EntryLamps(lampNow, emgDir), AUX_PED_STOP, 0);
+    cur = lampNow;
+
+    if (cur & ((emgDir == PT_NS) ? LAMP_NS_GREEN : LAMP_EW_GREEN)) {
+        emgStage = EMG_GREEN;
+        emgLeft = EMERGENCY_EXTEND_TIME;
+    } else if (cur & (LAMP_NS_YELLOW | LAMP_EW_YELLOW)) {
+        emgStage = EMG_YELLOW;
+        emgLeft = (cur == planLamps) ? timeLeft : (unsigned char)(stateTimeTable[emgExitPhase[emgDir ^ 1]] + 1);
+    } else {
+        emgStage = EMG_ALLRED;
+        if (cur == planLamps && !(planAux & (AUX_NS_LEFT | AUX_EW_LEFT | AUX_PED_WALK))) {
+            emgLeft = timeLeft;
+        } else if (planAux & AUX_PED_WALK) {
+            emgLeft = PED_CLEAR_TIME + 1;
+        } else {
+            emgLeft = ALL_RED_TIME + 1;
+        }
+    }
+    Emergency_Countdown();
+}
+
+/**
+ * @brief  结束紧急优先，从请求方向放行之后的黄灯相位接回相位表
+ * @note   结束时又有请求（另一方向或同方向新的边沿）则回到空闲，由下一个节拍重新接管
+ */
+static void Emergency_Exit(void)
+{
+    emgStage = EMG_IDLE;
+    if (emgRequest) {
+        return;
+    }
+    currentState = emgExitPhase[emgDir];
+    timeLeft = stateTimeTable[currentState];
+    SetTrafficLights(currentState);
+    Countdown_Reload();
+    LAMP_LOCK();
+    Flash_Arm();
+    LAMP_UNLOCK();
+}
+
+/**
+ * @brief  紧急优先秒处理（Timer0中断，紧急优先期间的秒边界调用）
+ * @retval 1=阶段改变（灯色改变），0=只更新了倒计时
+ * @note   黄灯 → 全红 ALL_RED_TIME → 请求方向绿灯；请求线仍为低电平或又有同方向请求时
+ *         绿灯保持，撤销后再保持 EMERGENCY_EXTEND_TIME，总保持不超过 EMERGENCY_MAX_TIME
+ */
+static unsigned char Emergency_Second(void)
+{
+    unsigned char req = (unsigned char)(EMG_REQ_NS << emgDir);
+    unsigned char active;
+
+    switch (emgStage) {
+        case EMG_YELLOW:
+            if (--emgLeft) {
+                break;
+            }
+            Lamp_Apply(LAMP_ALL_RED, AUX_PED_STOP, 0);
+            emgStage = EMG_ALLRED;
+            emgLeft = ALL_RED_TIME;
+            Emergency_Countdown();
+            return 1;
+
+        case EMG_ALLRED:
+            if (--emgLeft) {
+                break;
+            }
+            Lamp_Apply((emgDir == PT_NS) ? (LAMP_NS_GREEN | LAMP_EW_RED) : (LAMP_NS_RED | LAMP_EW_GREEN),
+                       AUX_PED_STOP, 0);
+            emgStage = EMG_GREEN;
+            emgLeft = EMERGENCY_EXTEND_TIME;
+            Emergency_Countdown();
+            return 1;
+
+        default:    // EMG_GREEN
+            active = (emgDir == PT_NS) ? !EMERGENCY_NS_PIN : !EMERGENCY_EW_PIN;
+            if (emgHold < EMERGENCY_MAX_TIME) {
+                emgHold++;
+                if (active || (emgRequest & req)) {
+                    emgRequest &= (unsigned char)~req;
+                    emgLeft = EMERGENCY_EXTEND_TIME;
+                    break;
+                }
+            }
+            if (--emgLeft) {
+                break;
+            }
+            Emergency_Exit();
+            return 1;
+    }
+    Emergency_Countdown();
+    return 0;
+}
+
+/**
+ * @brief  紧急优先初始化
+ */
+void Emergency_Init(void)
+{
+    IT0 = 1;            // 下降沿触发
+    IT1 = 1;
+    IE0 = 0;
+    IE1 = 0;
+    PX0 = 1;            // 高优先级：可以抢占Timer0/串口中断（与Timer1同级，见 config.h 的响应上限）
+    PX1 = 1;
+    emgIeMask = EMG_IE_BITS;
+    IE |= EMG_IE_BITS;  // EX0 = EX1 = 1（EA 由 Timer0_Init() 打开）
+}
+
+/**
+ * @brief  暂停响应紧急请求（进入设置模式前，主循环调用）
+ */
+unsigned char Emergency_Suspend(void)
+{
+    emgIeMask = 0;
+    IE &= (unsigned char)~EMG_IE_BITS;
+    if (emgRequest || emgStage != EMG_IDLE) {
+        emgIeMask = EMG_IE_BITS;
+        IE |= EMG_IE_BITS;
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief  恢复响应紧急请求（退出设置模式、灯输出恢复后，主循环调用）
+ */
+void Emergency_Resume(void)
+{
+    IE0 = 0;            // 丢弃设置期间锁存的边沿
+    IE1 = 0;
+    if (monFault) {
+        return;         // 冲突监视故障后不再响应（节拍也会每次重新屏蔽）
+    }
+    emgIeMask = EMG_IE_BITS;
+    IE |= EMG_IE_BITS;
+}
+
+/**
+ * @brief  INT0中断：南北方向紧急请求
+ * @note   第一条语句就写出预先算好的入口灯色：单条 XRL，之前没有分支和函数调用，
+ *         从下降沿到灯输出改变的周期数与运行状态无关。
+ *         随后两个方向的入口灯色都改为当前灯色，另一方向紧接着的请求不会把黄灯改回绿灯；
+ *         清除闪烁掩码，Timer0不会再异或熄灭/恢复任何灯。清空时序由下一个节拍接管；
+ *         最后作废热复位保留记录（此后复位不知道清空进行到哪一步，改为全红清空）
+ */
+void Emergency_NsISR(void) HAL_ISR(0)
+{
+    unsigned char port = P2;
+
+    P2 ^= (port ^ emgEntryNs) & LAMP_MASK;
+#if PHASE_PLAN == PHASE_PLAN_FULL
+    port = P0;
+    P0 ^= (port ^ AUX_PED_STOP) & AUX_MASK;
+    flashAux = 0;
+#endif
+    lampNow = emgEntryNs;
+    emgEntryEw = emgEntryNs;
+    flashLamps = 0;
+    isFlashing = 0;
+    emgRequest |= EMG_REQ_NS;
+    BOOT_FORGET();
+}
+
+/**
+ * @brief  INT1中断：东西方向紧急请求（同 Emergency_NsISR）
+ */
+void Emergency_EwISR(void) HAL_ISR(2)
+{
+    unsigned char port = P2;
+
+    P2 ^= (port ^ emgEntryEw) & LAMP_MASK;
+#if PHASE_PLAN == PHASE_PLAN_FULL
+    port = P0;
+    P0 ^= (port ^ AUX_PED_STOP) & AUX_MASK;
+    flashAux = 0;
+#endif
+    lampNow = emgEntryEw;
+    emgEntryNs = emgEntryEw;
+    flashLamps = 0;
+    isFlashing = 0;
+    emgRequest |= EMG_REQ_EW;
+    BOOT_FORGET();
+}
+
+/*==============================================
+ *                冲突监视
+ *==============================================*/
+// 兼容表：按实际灯输出查表，0=违例；非0时 bit1=无放行（可与左转/行人同时亮）、bit0=合法。
+// 每个方向只能是 灭（闪烁的熄灭半秒）/红/黄/绿 之一；两个方向不能同时放行（黄/绿），也不能同时全灭。
+// 两张表的值相与为0即违例：机动车放行(0x01) 与 左转/行人放行(0x02) 相与为0
+#define MON_DIR_BAD(d)  ((d) != 0 && (d) != LAMP_NS_RED && (d) != LAMP_NS_YELLOW && (d) != LAMP_NS_GREEN)
+#define MON_DIR_GO(d)   ((d) == LAMP_NS_YELLOW || (d) == LAMP_NS_GREEN)
+#define MON_LAMP(b)     ((MON_DIR_BAD((b) & 7) || MON_DIR_BAD((b) >> 3) || (b) == 0 || \
+                          (MON_DIR_GO((b) & 7) && MON_DIR_GO((b) >> 3))) ? 0x00 : \
+                         (MON_DIR_GO((b) & 7) || MON_DIR_GO((b) >> 3)) ? 0x01 : 0x03)
+#define MON_LAMP8(b)    MON_LAMP(b), MON_LAMP(b + 1), MON_LAMP(b + 2), MON_LAMP(b + 3), \
+                        MON_LAMP(b + 4), MON_LAMP(b + 5), MON_LAMP(b + 6), MON_LAMP(b + 7)
+
+static const unsigned char code lampCompat[LAMP_MASK + 1] = {
+    MON_LAMP8(0),  MON_LAMP8(8),  MON_LAMP8(16), MON_LAMP8(24),
+    MON_LAMP8(32), MON_LAMP8(40), MON_LAMP8(48), MON_LAMP8(56)
+};
+
+#if PHASE_PLAN == PHASE_PLAN_FULL
+// 扩展灯（P0 >> 4：bit0 南北左转、bit1 东西左转、bit2 行人绿、bit3 行人红）：
+// 三种放行最多一种，行人红绿不同时亮；有放行时只与机动车全红（或全红闪烁熄灭）兼容
+#define MON_AUX_GO(a)   (((a) & 1) + (((a) >> 1) & 1) + (((a) >> 2) & 1))
+#define MON_AUX(a)      ((MON_AUX_GO(a) > 1 || ((a) & 0x0C) == 0x0C) ? 0x00 : MON_AUX_GO(a) ? 0x02 : 0x03)
+
+static const unsigned char code auxCompat[(AUX_MASK >> 4) + 1] = {
+    MON_AUX(0),  MON_AUX(1),  MON_AUX(2),  MON_AUX(3),  MON_AUX(4),  MON_AUX(5),  MON_AUX(6),  MON_AUX(7),
+    MON_AUX(8),  MON_AUX(9),  MON_AUX(10), MON_AUX(11), MON_AUX(12), MON_AUX(13), MON_AUX(14), MON_AUX(15)
+};
+#define MON_AUX_CLASS() auxCompat[P0 >> 4]
+#else
+#define MON_AUX_CLASS() 0xFF    // 不驱动P0.4-P0.7
+#endif
+
+/**
+ * @brief  故障状态：每节拍重写故障灯输出（Timer0中断，锁定故障后每个节拍调用）
+ * @note   重新屏蔽INT0/INT1并丢弃紧急请求；主循环或紧急优先在故障锁定的同时写出的灯色
+ *         最迟在下一个节拍被覆盖。monLamps 在秒/半秒边界切换，四面红灯以1Hz闪烁
+ */
+static void Monitor_Hold(void)
+{
+    LAMP_LOCK();
+    emgRequest = 0;
+    emgStage = EMG_IDLE;
+    Lamp_Write(monLamps);
+#if PHASE_PLAN == PHASE_PLAN_FULL
+    Aux_Write(AUX_PED_STOP);
+#endif
+}
+
+/**
+ * @brief  锁定冲突监视故障（Timer0中断，检查到违例的节拍调用一次）
+ * @param  reason: MON_LAMPS / MON_STATE
+ * @note   记录读到的灯输出供调试器/遥测读取；清除闪烁掩码和倒计时，
+ *         紧急优先的入口灯色改为全红，然后写出故障灯输出
+ */
+static void Monitor_Trip(unsigned char reason)
+{
+    BOOT_FORGET();
+    emgIeMask = 0;
+    monFault = reason;
+    monFaultLamps = P2 & LAMP_MASK;
+    monFaultAux = P0 & AUX_MASK;
+    monLamps = LAMP_ALL_RED;
+    lampNow = LAMP_ALL_RED;
+    emgEntryNs = LAMP_ALL_RED;
+    emgEntryEw = LAMP_ALL_RED;
+    flashLamps = 0;
+#if PHASE_PLAN == PHASE_PLAN_FULL
+    flashAux = 0;
+#endif
+    isFlashing = 0;
+    Countdown_Clear();
+    Monitor_Hold();
+    Event_Post(EVT_PHASE);
+}
+
 /*==============================================
  *                定时器初始化
  *==============================================*/
@@ -161,13 +1140,16 @@ void SwitchToNextState(void)
  * @brief  Timer0初始化 - 配置为2ms中断
  * @param  无  
  * @retval 无
- * @note   11.0592MHz晶振，2ms定时
+ * @note   重装值由 config.h 按 FOSC 计算，2ms定时
  */
 void Timer0_Init(void)
 {
     // 设置Timer0为模式1（16位定时器）
     TMOD &= 0xF0;        // 清除Timer0控制位
     TMOD |= 0x01;        // 设置Timer0为模式1
+#if TIMER0_CLK_DIV == 1
+    AUXR |= 0x80;        // STC 1T定时器模式（T0x12=1）
+#endif
     
     // 设置定时器初值（2ms定时）
     TH0 = TIMER0_RELOAD_H;
@@ -178,7 +1160,7 @@ void Timer0_Init(void)
     
     // 配置中断
     ET0 = 1;             // 使能Timer0中断
-    PT0 = 1;             // 设置Timer0为高优先级中断
+    PT0 = 0;             // 低优先级：紧急请求（INT0/INT1）和蜂鸣器（Timer1）可以抢占，重装按溢出后计数累加，不丢节拍
     EA = 1;              // 使能全局中断
     
     // 启动定时器
@@ -186,7 +1168,7 @@ void Timer0_Init(void)
     
     // 初始化计数器
     timer0Count = 0;
-    flashCount = 0;
+    Reset_SystemTime();  // 时间基准从0开始累计
 }
 
 /*==============================================
@@ -197,56 +1179,149 @@ void Timer0_Init(void)
  * @param  无
  * @retval 无
  * @note   每2ms执行一次
- *         - 33次中断 = 66ms ≈ 1秒（用于交通灯计时）
- *         - 每次中断调用显示刷新（约500Hz刷新率）
+ *         - 时间基准分数累加，精确产生1秒（用于交通灯计时和心跳）
+ *         - 每秒投递 EVT_SECOND / EVT_PHASE，主循环据此刷新显示；半秒投递 EVT_HALF_SECOND（显示闪烁）
+ *         - 最后 FLASH_START_TIME 秒内，闪烁的灯在半秒边界熄灭、秒边界恢复
+ *         - 每次中断扫描一位数码管（四位轮流，每位 DISPLAY_REFRESH_HZ=125Hz）
+ *         - 检查实际灯输出（冲突监视），违例时锁定四面红灯闪烁
+ *         - 按任务表分派节拍任务（sched.c），最后在主循环运行过时喂狗
+ *
+ *         最坏执行时间（12T内核，估算）：
+ *         中断响应 3~8 + 现场保护/恢复 ~30 + 重装/计数 ~20
+ *         + Display_Scan ~20 + 时间基准 ~20（每节拍16位减1判零、半秒比较）
+ *         + 秒边界另加 ~40（32位余数累加、秒计数，Timebase_StartSecond）+ 状态切换 ~60
+ *         + 冲突监视 ~25 + 喂狗 ~7 + 远程命令请求判断 ~6
+ *         + 任务分派 ~40 + 蜂鸣器 + 本节拍到期的一个采样/快照任务（各自预算见 SCHED_BUDGET_*）
+ *         ≈ 390 机器周期（秒边界节拍；其余节拍没有秒处理和状态切换，约 290），
+ *         远小于一个节拍的 2000 机器周期（@12MHz 12T）
+ *         ISR_PROFILE_ENABLE=1 时在中断末尾读取TH0/TL0，
+ *         把溢出后流逝的计数值（即响应延迟+本次中断耗时）最大值记录在 isrMaxCycles
  */
-void Timer0_ISR(void) interrupt 1
+void Timer0_ISR(void) HAL_ISR(1)
 {
-	
-		        // 设置模式暂停倒计时
-    extern volatile unsigned char g_isSettingMode; // 引入设置模式标志
-    // 重新装载定时器初值
-    TH0 = TIMER0_RELOAD_H;
-    TL0 = TIMER0_RELOAD_L;
+    // 设置模式暂停倒计时
+    unsigned int reload;
+    unsigned char lamps;
+
+    // 重新装载定时器初值：把重装值累加到溢出后已走过的计数上，
+    // 中断响应延迟不会累积到节拍周期中（停止期间的周期由 TIMER0_STOP_CYCLES 补偿）
+    TR0 = 0;
+    reload = (((unsigned int)TH0 << 8) | TL0) + (unsigned int)(TIMER0_RELOAD + TIMER0_STOP_CYCLES);
+    TH0 = reload >> 8;
+    TL0 = reload;
+    TR0 = 1;
     
     // 2ms定时计数
     timer0Count++;
-    flashCount++;
     
     // ==========================================
-    // 【关键】数码管显示刷新（每2ms刷新一次）
+    // 【关键】数码管动态扫描（每2ms点亮一位）
     // ==========================================
-    // 调用显示函数进行快速扫描（约5ms完成）
-    // 注意：Display_ShowTime()会阻塞5ms，但2ms中断仍会继续
-    Display_ShowTime(nsTime, ewTime);
+    // 只切换一位的位选和段码，不做任何等待，执行时间固定
+    Display_Scan();
+
+    // 紧急优先：请求中断已写出入口灯色，在这里接管后续清空时序（无请求时只比较一次）
+    if (emgRequest && emgStage == EMG_IDLE) {
+        Emergency_Enter();
+        Event_Post(EVT_PHASE);
+    }
+
+    // 远程命令改写了配时（影子方案）：跨周期的等待倒计时按新方案重算；
+    // 紧急优先和闪光运行结束时本来就会重新装载
+    if (countdownStale) {
+        countdownStale = 0;
+        if (emgStage == EMG_IDLE && flashStage == FLASH_OFF && !monFault) {
+            Countdown_Reload();
+        }
+    }
     
     // ==========================================
-    // 心跳指示和交通灯控制
+    // 1秒定时处理：心跳指示和交通灯控制
     // ==========================================
-    // 心跳指示：每 1s 切换一次DEBUG_1S_PIN (实际是 3s)
-    if ((timer0Count % (100 / 3)) == 0) {
+    if (Timebase_Tick()) {
+        // 心跳指示：每 1s 切换一次DEBUG_1S_PIN
         DEBUG_1S_PIN = !DEBUG_1S_PIN;
-    }
-    
-    // 处理闪烁逻辑（每2ms检查一次）
-    // HandleTrafficLightFlash();
-    
-    // 1秒定时处理：33次中断 ≈ 66ms × 15.15 ≈ 1秒
-    if (timer0Count >= 33) {
-        timer0Count = 0;  // 重置计数器
-
 
-        if (!g_isSettingMode) {
+        if (monFault) {
+            // 冲突监视故障：相位表停止，红灯在秒/半秒边界亮灭
+            monLamps ^= LAMP_ALL_RED;
+            Event_Post(EVT_SECOND);
+        } else if (emgStage != EMG_IDLE) {
+            // 紧急优先期间相位表暂停
+            Event_Post(Emergency_Second() ? EVT_PHASE : EVT_SECOND);
+        } else if (flashStage != FLASH_OFF) {
+            // 闪光运行期间相位表暂停
+            Event_Post(Flash_Second() ? EVT_PHASE : EVT_SECOND);
+        } else if (!g_isSettingMode &&
+                   ((forcePhase != PHASE_NONE || flashReq) ? Force_Second() : Actuated_Second())) {
             // 时间递减
             if (timeLeft > 0) {
                 timeLeft--;
             }
-            // 检查是否需要切换状态
+            // 检查是否需要切换状态，通知主循环刷新显示
             if (timeLeft == 0) {
                 SwitchToNextState();
+                Event_Post(EVT_PHASE);
+            } else {
+                Countdown_Dec(0);
+                Countdown_Dec(1);
+                HandleTrafficLightFlash();
+                Event_Post(EVT_SECOND);
             }
+            // 热复位接回点
+            Boot_Keep();
+        } else {
+            // 设置模式下（或感应控制绿灯停留时）倒计时暂停，秒事件仍用于显示闪烁和空闲统计
+            Event_Post(EVT_SECOND);
         }
+    } else if (Timebase_IsHalfSecond()) {
+        // 灯闪烁：设置模式下相位暂停、灯色保持，不闪烁；闪光运行时掩码为两个方向的红灯
+        if (monFault) {
+            monLamps ^= LAMP_ALL_RED;
+        } else if (!g_isSettingMode) {
+            Flash_HalfSecond();
+        }
+        Event_Post(EVT_HALF_SECOND);
     }
+
+    // ==========================================
+    // 冲突监视：读回本节拍结束时的灯输出查兼容表
+    // ==========================================
+    // 正常时每节拍相同的指令（读端口、两次MOVC、与、判0，相位号一次比较，约25个机器周期）；
+    // 本节拍写出的灯在同一节拍内检查，违例输出最多保持到本次中断结束
+    if (monFault) {
+        Monitor_Hold();
+    } else {
+        lamps = P2;
+        if (!(lampCompat[lamps & LAMP_MASK] & MON_AUX_CLASS())) {
+            Monitor_Trip(MON_LAMPS);
+        } else if (currentState >= PHASE_COUNT) {
+            Monitor_Trip(MON_STATE);
+        }
+    }
+
+    // 节拍任务：蜂鸣器每拍，按键/检测器/遥测快照按任务表错开到不同节拍（sched.c）；
+    // 放在相位切换和冲突监视之后，遥测快照取到的是本节拍的结果
+    Sched_Tick();
+
+#if WDT_ENABLE
+    // 看门狗：主循环在上次喂狗之后运行过才喂狗（故障锁定后照常喂狗，保持红灯闪烁而不是复位重新放行）
+    if (wdtMainAlive) {
+        wdtMainAlive = 0;
+        WDT_CONTR = WDT_FEED;
+    }
+#endif
+
+#if ISR_PROFILE_ENABLE
+    // 测量本次中断耗时：当前计数 - 重装值 = 溢出后已走过的机器周期
+    {
+        unsigned int elapsed;
+        elapsed = (((unsigned int)TH0 << 8) | TL0) - (unsigned int)TIMER0_RELOAD;
+        if (elapsed > isrMaxCycles) {
+            isrMaxCycles = elapsed;
+        }
+    }
+#endif
 }
 
 /*==============================================
@@ -254,32 +1329,44 @@ void Timer0_ISR(void) interrupt 1
  *==============================================*/
 void UpdateStateTimeTable(void)
 {
-    // 使用可调变量（全局 extern）更新状态时间表
+    // 使用可调变量（全局 extern）更新相位时长表
     extern volatile unsigned char g_time_green;
     extern volatile unsigned char g_time_yellow;
-    // 红灯时间 = 对向绿 + 黄，这里默认相同配比
-    // 对称十字路口：NS绿=EW绿=g_time_green；黄同理
-    stateTimeTable[STATE_NS_GREEN_EW_RED]  = g_time_green;   // 南北绿(东西红)
-    stateTimeTable[STATE_NS_YELLOW_EW_RED] = g_time_yellow;  // 南北黄(东西红)
-    stateTimeTable[STATE_NS_RED_EW_GREEN]  = g_time_green;   // 东西绿(南北红)
-    stateTimeTable[STATE_NS_RED_EW_YELLOW] = g_time_yellow;  // 东西黄(南北红)
-}
-
-void ShowSettingColorLights(void)
-{
-    extern volatile unsigned char g_selectedColor;
-    // 熄灭全部
-    NS_RED_PIN = 0; NS_YELLOW_PIN = 0; NS_GREEN_PIN = 0;
-    EW_RED_PIN = 0; EW_YELLOW_PIN = 0; EW_GREEN_PIN = 0;
-    // 按颜色点亮两个方向对应灯，指示正在设置
-    switch(g_selectedColor) {
-        case 0: // 红
-            NS_RED_PIN = 1; EW_RED_PIN = 1; break;
-        case 1: // 黄
-            NS_YELLOW_PIN = 1; EW_YELLOW_PIN = 1; break;
-        case 2: // 绿
-            NS_GREEN_PIN = 1; EW_GREEN_PIN = 1; break;
-        default:
-            break;
+    unsigned char i;
+    unsigned char t;
+    unsigned char shadow;
+    unsigned int sum = 0;
+
+    // 先撤销尚未生效的切换（单个位写入）：此后Timer0不会再翻转 planActive；
+    // 若Timer0恰好在这之前翻转，影子就是刚换下的那一份，同样可以整份重写
+    planPending = 0;
+    shadow = !planActive;
+
+    // 对称十字路口：两个方向的绿灯都取 g_time_green，黄灯同理；
+    // 全红/左转/行人相位取表内固定值。各相位时长限制在 [minTime, maxTime]
+    for (i = 0; i < PHASE_COUNT; i++) {
+        switch (phasePlan[i].timeSel) {
+            case PHASE_TIME_GREEN:  t = g_time_green;          break;
+            case PHASE_TIME_YELLOW: t = g_time_yellow;         break;
+            default:                t = phasePlan[i].duration; break;
+        }
+        if (t < phasePlan[i].minTime) t = phasePlan[i].minTime;
+        if (t > phasePlan[i].maxTime) t = phasePlan[i].maxTime;
+        planTime[shadow][i] = t;
+
+        planStart[shadow][i] = sum;
+        sum += t;
+    }
+    planStart[shadow][PHASE_COUNT] = sum;
+
+    // 整份写完才允许切换
+    planPending = 1;
+}
+
+void Plan_Swap(void)
+{
+    if (planPending) {
+        planActive = !planActive;
+        planPending = 0;
     }
 }
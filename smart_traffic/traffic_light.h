@@ -11,24 +11,106 @@
 
 #include "config.h"
 
+/*==============================================
+ *                紧急优先
+ *==============================================*/
+// 紧急请求（emgRequest 位，INT0=南北，INT1=东西）
+#define EMG_REQ_NS  0x01
+#define EMG_REQ_EW  0x02
+
+// 紧急优先阶段（emgStage）
+#define EMG_IDLE    0   // 按相位表运行
+#define EMG_YELLOW  1   // 对向黄灯清空
+#define EMG_ALLRED  2   // 全红清空
+#define EMG_GREEN   3   // 请求方向紧急绿灯
+
+/*==============================================
+ *                冲突监视
+ *==============================================*/
+// 故障原因（monFault），锁定后四面红灯闪烁直到复位
+#define MON_OK      0   // 正常
+#define MON_LAMPS   1   // 灯输出不在兼容表内（冲突放行、同方向多灯、全灭）
+#define MON_STATE   2   // 相位号越界
+
+/*==============================================
+ *                远程命令（强制相位/闪光运行）
+ *==============================================*/
+#define PHASE_NONE  0xFF    // forcePhase：没有待执行的强制相位
+
+// 闪光运行阶段（flashStage）
+#define FLASH_OFF   0       // 按相位表运行
+#define FLASH_ON    1       // 闪光运行：南北/东西红灯交替闪烁
+#define FLASH_EXIT  2       // 退出闪光：全红 ALL_RED_TIME 秒后从相位0开始新周期
+
+/*==============================================
+ *                快速启动（热复位接回相位）
+ *==============================================*/
+// 保留记录 bootKeep[]：相位、剩余时间及各自的反码，反码不符即无效
+#define BOOT_KEEP_PHASE  0
+#define BOOT_KEEP_LEFT   1
+#define BOOT_KEEP_NPHASE 2
+#define BOOT_KEEP_NLEFT  3
+#define BOOT_KEEP_SIZE   4
+
+// 作废保留记录：反码写0只能对应相位0xFF，必然越界（单字节写入，中断中也可用）
+#if FAST_BOOT_ENABLE
+#define BOOT_FORGET()    (bootKeep[BOOT_KEEP_NPHASE] = 0)
+#else
+#define BOOT_FORGET()
+#endif
+
+// 启动方式（bootMode）
+#define BOOT_COLD   0       // 上电复位（或 FAST_BOOT_ENABLE=0）：从相位0开始
+#define BOOT_RESUME 1       // 热复位：接回保留记录中的相位和剩余时间
+#define BOOT_CLEAR  2       // 热复位但记录无效：全红 ALL_RED_TIME 秒后从相位0开始
+
 /*==============================================
  *                函数声明
  *==============================================*/
 
 /**
  * @brief  设置交通灯状态
- * @param  state: 交通灯状态(0-3)
+ * @param  state: 相位号(0 ~ PHASE_COUNT-1)
  * @retval 无
  */
 void SetTrafficLights(unsigned char state);
 
 /**
- * @brief  处理交通灯闪烁逻辑
+ * @brief  计算某方向的倒计时（红灯方向由相位起始前缀和得出）
+ * @param  phase: 当前相位
+ * @param  dir:   0=南北，1=东西
+ * @param  left:  当前相位剩余时间
+ * @retval 倒计时秒数
+ */
+unsigned int Phase_Countdown(unsigned char phase, unsigned char dir, unsigned char left);
+
+/**
+ * @brief  按当前相位和剩余时间重新装载BCD倒计时 countdownBcd[]
+ */
+void Countdown_Reload(void);
+
+/**
+ * @brief  处理交通灯闪烁逻辑（Timer0中断中，不切换相位的秒边界调用）
  * @param  无
  * @retval 无
+ * @note   恢复上半秒熄灭的灯，并按剩余时间装载本秒的闪烁掩码（相位表 flash/auxFlash）
  */
 void HandleTrafficLightFlash(void);
 
+/**
+ * @brief  当前秒应播放的蜂鸣器音型
+ * @param  无
+ * @retval BUZZER_PAT_*（无需提示时为 BUZZER_PAT_NONE）
+ */
+unsigned char Phase_BuzzerPattern(void);
+
+/**
+ * @brief  相位能否作为强制相位的目标（只读相位表，可在中断中调用）
+ * @param  phase: 相位号（须小于 PHASE_COUNT）
+ * @retval 1=可调绿灯相位或保护放行相位（左转箭头/行人绿灯）；0=黄灯、清空相位
+ */
+unsigned char Phase_Forcible(unsigned char phase);
+
 /**
  * @brief  切换到下一个交通灯状态
  * @param  无
@@ -43,6 +125,58 @@ void SwitchToNextState(void);
  */
 void Timer0_Init(void);
 
+/**
+ * @brief  紧急优先初始化：INT0/INT1 下降沿触发、高优先级并使能
+ * @param  无
+ * @retval 无
+ * @note   须在 Timer0_Init() 打开EA之前调用
+ */
+void Emergency_Init(void);
+
+/**
+ * @brief  选择起始相位并写出灯色、倒计时和闪烁掩码，结果记在 bootMode
+ * @param  无
+ * @retval 无
+ * @note   须在 Emergency_Init() 之后、Timer0_Init() 之前调用。
+ *         热复位时只采用反码相符、相位和剩余时间都在范围内的保留记录，且只用一次：
+ *         接回后到 Timer0 第一个秒边界重新记下之前再次复位，改为全红清空，
+ *         复位循环不会让同一个绿灯一直亮下去。
+ *         全红清空借用退出闪光运行的阶段（FLASH_EXIT），期间不响应紧急请求和按键
+ */
+void Boot_Start(void);
+
+#if defined(__SDCC) && FAST_BOOT_ENABLE
+/**
+ * @brief  取回 SDCC 启动钩子暂存的保留记录（main() 第一条语句，Buzzer_Init()/Uart_Init() 之前）
+ * @param  无
+ * @retval 无
+ * @note   SDCC 的 crt0 清零全部 256 字节 idata（STARTUP.A51 只清零 0x00-0x7F），
+ *         启动钩子在清零前把记录暂存到尚未使用的 Timer1/Timer2 重装寄存器，见 traffic_light.c
+ */
+void Boot_Reclaim(void);
+#endif
+
+/**
+ * @brief  暂停响应紧急请求（进入设置模式前调用）
+ * @param  无
+ * @retval 1=已暂停；0=紧急优先正在进行，不能进入设置模式（保持响应）
+ */
+unsigned char Emergency_Suspend(void);
+
+/**
+ * @brief  恢复响应紧急请求（退出设置模式、灯输出恢复后调用），丢弃暂停期间锁存的边沿
+ * @param  无
+ * @retval 无
+ */
+void Emergency_Resume(void);
+
+#ifdef __SDCC
+// SDCC 只为 main 所在编译单元中可见原型的中断函数安装向量
+void Timer0_ISR(void) HAL_ISR(1);
+void Emergency_NsISR(void) HAL_ISR(0);
+void Emergency_EwISR(void) HAL_ISR(2);
+#endif
+
 /**
  * @brief  系统初始化
  * @param  无
@@ -53,16 +187,40 @@ void System_Init(void);
 /*==============================================
  *                外部变量声明
  *==============================================*/
-extern volatile unsigned char currentState; // 当前交通灯状态
+extern volatile unsigned char currentState; // 当前相位（相位表下标）
 extern volatile unsigned char timeLeft;     // 当前状态剩余时间
-extern volatile unsigned char isFlashing;   // 闪烁标志
-extern volatile unsigned int timer0Count;   // Timer0中断计数器
-extern volatile unsigned int flashCount;    // 闪烁计数器
-extern unsigned char stateTimeTable[4];     // 状态时间配置表
+extern volatile bit isFlashing;             // 闪烁标志（本秒有灯在后半秒熄灭）
+extern volatile unsigned int timer0Count;   // Timer0中断计数器（节拍数，自由溢出）
+extern volatile unsigned char countdownBcd[2];  // 南北/东西倒计时（压缩BCD，超过99显示99）
+extern unsigned char idata planTime[2][PHASE_COUNT];      // 配时方案：各相位时长（两份）
+extern unsigned int idata planStart[2][PHASE_COUNT + 1];  // 配时方案：相位起始时刻前缀和，末项为周期
+extern volatile bit planActive;                     // 生效中的配时方案（只由Timer0翻转）
+extern volatile bit planPending;                    // 影子方案已写好，等待周期边界切换
+#define stateTimeTable (planTime[planActive])       // 生效中的各相位时长
+#define phaseStart     (planStart[planActive])      // 生效中的相位起始时刻前缀和
+extern volatile unsigned char emgRequest;   // 未接管的紧急请求（EMG_REQ_*）
+extern volatile unsigned char emgStage;     // 紧急优先阶段（EMG_*）
+extern volatile unsigned char monFault;     // 冲突监视故障（MON_*）
+extern volatile unsigned char monFaultLamps; // 故障时读到的灯输出（P2 & LAMP_MASK）
+extern volatile unsigned char monFaultAux;  // 故障时读到的扩展灯输出（P0 & AUX_MASK）
+extern volatile unsigned char forcePhase;   // 待执行的强制相位（主循环写，Timer0跳转后清为 PHASE_NONE）
+extern volatile bit flashReq;               // 1=请求闪光运行，0=请求退出（主循环写）
+extern volatile unsigned char flashStage;   // 闪光运行阶段（FLASH_*，只由Timer0改变）
+extern volatile bit countdownStale;         // 主循环改写配时后置1，Timer0下一个节拍重算倒计时
+#if WDT_ENABLE
+extern volatile bit wdtMainAlive;           // 主循环每次运行置1，Timer0节拍据此喂狗
+#endif
+#if ISR_PROFILE_ENABLE
+extern volatile unsigned int isrMaxCycles;  // Timer0中断实测最坏耗时（机器周期）
+#endif
+#if FAST_BOOT_ENABLE
+extern volatile unsigned char idata bootKeep[BOOT_KEEP_SIZE]; // 热复位保留记录（idata BOOT_KEEP_ADDR，启动代码不清零）
+#endif
+extern unsigned char bootMode;              // 本次启动方式（BOOT_*）
 
 /*=======================新增：设置模式支持=======================*/
 // 设置模式标志：1=正在设置（暂停倒计时），0=正常
-extern volatile unsigned char g_isSettingMode;
+extern volatile bit g_isSettingMode;
 // 当前选择的颜色：0=红,1=黄,2=绿 （循环按键切换）
 extern volatile unsigned char g_selectedColor;
 // 可调节的三个颜色时间（秒），红灯时间=对向绿+黄，保持一致
@@ -71,13 +229,15 @@ extern volatile unsigned char g_time_yellow;
 extern volatile unsigned char g_time_green;
 
 /**
- * @brief  根据当前颜色时间刷新状态时间表 stateTimeTable
+ * @brief  根据当前颜色时间生成影子配时方案（相位时长及前缀和），下一个周期边界生效
+ * @note   只能在主循环中调用；正在运行的相位按原时长走完，不截断
  */
 void UpdateStateTimeTable(void);
 
 /**
- * @brief  设置模式下点亮对应颜色的灯作为指示（两个方向同色灯亮）
+ * @brief  影子配时方案已写好时切换为生效方案（翻转 planActive）
+ * @note   Timer0中断在相位序号回绕（周期边界）时调用；Timer0启动前由初始化调用，使首个方案立即生效
  */
-void ShowSettingColorLights(void);
+void Plan_Swap(void);
 
 #endif /* __TRAFFIC_LIGHT_H__ */
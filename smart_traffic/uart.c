@@ -0,0 +1,110 @@
+/**************************************************
+ * 文件名:    uart.c
+ * 作者:
+ * 日期:      2025-10-17
+ * 描述:      硬件串口驱动实现
+ *           发送队列：主循环写 uartTxHead、中断写 uartTxTail 的单生产者/单消费者环形缓冲区，
+ *                     与事件队列（event.c）同样不需要关中断；下标自由递增，取用时按长度取模
+ *           启动发送：发送器空闲时主循环软件置 TI，由中断送出第一个字节，
+ *                     之后每个字节发送完毕的 TI 中断送出下一个，缓冲区取空时标记空闲
+ *           接收：RI 中断读出 SBUF 交给 Command_RxByte()，下一个字节收完之前（约1ms）必须读走
+ **************************************************/
+
+#include "uart.h"
+#include "command.h"
+
+#if UART_ENABLE && CPU_CLK_DIV == 1
+#error "1T内核的串口波特率发生器需要移植 Uart_Init()，或定义 UART_ENABLE=0"
+#endif
+#if (UART_TX_SIZE & UART_TX_MASK) || UART_TX_SIZE > 128
+#error "UART_TX_SIZE 必须是2的幂且不超过128"
+#endif
+
+/*-----------------------CRC-8半字节表------------------------*/
+// 下标为高半字节h时，寄存器 h<<4 左移4位（遇最高位1异或0x07）的结果
+const unsigned char code uartCrc8Nibble[16] = {
+    0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15,
+    0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D
+};
+
+/*-----------------------全局变量定义-------------------------*/
+static unsigned char idata uartTxBuf[UART_TX_SIZE];  // 发送缓冲区（间接寻址区）
+static volatile unsigned char uartTxHead = 0;   // 写位置（主循环独占）
+static volatile unsigned char uartTxTail = 0;   // 读位置（中断独占）
+static volatile bit uartTxBusy = 0;             // 1=发送器正在送出缓冲区（主循环置位，中断取空时清除）
+volatile unsigned char uartTxDropped = 0;       // 整帧丢弃次数
+
+/**
+ * @brief  串口初始化
+ */
+void Uart_Init(void)
+{
+    SCON = 0x50;                    // 方式1（8N1），REN=1 允许接收
+    T2CON = 0x30;                   // RCLK=TCLK=1：Timer2 作收发波特率发生器，先停止
+    RCAP2H = UART_RELOAD >> 8;
+    RCAP2L = UART_RELOAD & 0xFF;
+    TH2 = UART_RELOAD >> 8;
+    TL2 = UART_RELOAD & 0xFF;
+    TR2 = 1;
+    uartTxBusy = 0;
+    PS = 0;                         // 低优先级，不影响紧急请求中断
+    ES = 1;
+}
+
+/**
+ * @brief  整帧入队（主循环上下文）
+ */
+unsigned char Uart_Send(const unsigned char *buf, unsigned char len)
+{
+    unsigned char head = uartTxHead;
+
+    // 剩余空间 = 长度 - 已占用；中断只会推进 uartTxTail，读到旧值只会少算空间
+    if ((unsigned char)(UART_TX_SIZE - (unsigned char)(head - uartTxTail)) < len) {
+        uartTxDropped++;
+        return 0;
+    }
+    while (len--) {
+        uartTxBuf[head & UART_TX_MASK] = *buf++;
+        head++;
+    }
+    uartTxHead = head;              // 单字节写入：整帧同时对中断可见
+
+    // 发送器空闲（中断已取空缓冲区）：置TI进入中断送出第一个字节。
+    // 中断在取空时先看到新的 uartTxHead 就不会清除 uartTxBusy，两边不会同时启动
+    if (!uartTxBusy) {
+        uartTxBusy = 1;
+        TI = 1;
+    }
+    return 1;
+}
+
+/**
+ * @brief  CRC-8 累加一个字节
+ */
+unsigned char Uart_Crc8(unsigned char crc, unsigned char b)
+{
+    UART_CRC8(crc, b);
+    return crc;
+}
+
+/**
+ * @brief  串口中断服务函数
+ * @note   每个字节收到（RI）或发送完毕（TI）各执行一次：9600bps@12MHz 约1000个机器周期一次，
+ *         本身几十个机器周期。先处理接收：SBUF 读出的是接收寄存器，与发送写入的不是同一个
+ */
+void Uart_ISR(void) HAL_ISR(4)
+{
+    if (RI) {
+        RI = 0;
+        Command_RxByte(SBUF);
+    }
+    if (TI) {
+        TI = 0;
+        if (uartTxTail != uartTxHead) {
+            SBUF = uartTxBuf[uartTxTail & UART_TX_MASK];
+            uartTxTail++;
+        } else {
+            uartTxBusy = 0;
+        }
+    }
+}
@@ -0,0 +1,69 @@
+/**************************************************
+ * 文件名:    uart.h
+ * 作者:
+ * 日期:      2025-10-17
+ * 描述:      硬件串口驱动头文件
+ *           方式1（8N1），Timer2 产生波特率；发送经环形缓冲区由串口中断逐字节送出，
+ *           主循环整帧入队后立即返回，任何时候都不查询 TI；
+ *           接收的每个字节在中断中直接交给命令解析（command.c），不经缓冲区
+ **************************************************/
+
+#ifndef __UART_H__
+#define __UART_H__
+
+#include "config.h"
+
+#define UART_TX_MASK (UART_TX_SIZE - 1)
+
+/**
+ * @brief  CRC-8 累加一个字节（宏，中断与主循环各自展开，不共用不可重入的函数）
+ * @note   crc 须是 unsigned char 变量；按半字节查16项code表，每字节两次查表
+ */
+#define UART_CRC8(crc, b) do { \
+        (crc) ^= (b); \
+        (crc) = ((crc) << 4) ^ uartCrc8Nibble[(crc) >> 4]; \
+        (crc) = ((crc) << 4) ^ uartCrc8Nibble[(crc) >> 4]; \
+    } while (0)
+
+extern const unsigned char code uartCrc8Nibble[16];
+
+/*-----------------------函数声明-----------------------------*/
+
+/**
+ * @brief  串口初始化（方式1，Timer2 波特率发生器，允许接收，低优先级中断）
+ * @param  无
+ * @retval 无
+ * @note   只使用Timer2，不影响Timer0节拍和Timer1蜂鸣器
+ */
+void Uart_Init(void);
+
+/**
+ * @brief  整帧入队发送（只能在主循环中调用，单生产者）
+ * @param  buf: 待发送的字节
+ * @param  len: 字节数（不超过 UART_TX_SIZE）
+ * @retval 1=已入队，0=缓冲区剩余空间不足（整帧丢弃，uartTxDropped 加1）
+ * @note   立即返回；发送器空闲时置 TI 由中断送出第一个字节
+ */
+unsigned char Uart_Send(const unsigned char *buf, unsigned char len);
+
+/**
+ * @brief  CRC-8 累加一个字节（多项式 x^8+x^2+x+1，即0x07，初值由调用方给出）
+ * @param  crc: 之前的CRC值
+ * @param  b:   新的数据字节
+ * @retval 新的CRC值
+ * @note   按半字节查16项code表，每字节两次查表，比逐位计算快约4倍；
+ *         只能在主循环中调用（C51 函数默认不可重入），中断中用 UART_CRC8()
+ */
+unsigned char Uart_Crc8(unsigned char crc, unsigned char b);
+
+/**
+ * @brief  整帧因缓冲区满被丢弃的次数（8位回绕）
+ */
+extern volatile unsigned char uartTxDropped;
+
+#ifdef __SDCC
+// SDCC 需要在 main 所在编译单元看到中断函数原型才会安装向量
+void Uart_ISR(void) HAL_ISR(4);
+#endif
+
+#endif /* __UART_H__ */